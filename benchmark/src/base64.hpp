@@ -0,0 +1,136 @@
+#ifndef BASE64_HPP_3E7A90C1D5B28F46
+#define BASE64_HPP_3E7A90C1D5B28F46
+
+#include "rapidstring.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+/*
+ * Base64 encoding and decoding of a random binary payload, against the usual
+ * loop handling one group of three bytes at a time.
+ */
+
+inline std::string base64_payload()
+{
+	std::mt19937 gen{ 5 };
+	std::uniform_int_distribution<int> d{ 0, 255 };
+	std::string bytes;
+
+	for (std::size_t i = 0; i < 48 * 1024; i++)
+		bytes += static_cast<char>(d(gen));
+
+	return bytes;
+}
+
+inline std::string base64_encoded(const std::string& bytes)
+{
+	rapidstring s;
+	rs_init(&s);
+	rs_cat_base64(&s, bytes.data(), bytes.size(), RS_BASE64_STANDARD);
+
+	std::string result{ rs_data_c(&s), rs_len(&s) };
+	rs_free(&s);
+
+	return result;
+}
+
+inline void rs_base64_encode(benchmark::State& state)
+{
+	const auto bytes = base64_payload();
+
+	for (auto _ : state) {
+		rapidstring s;
+		rs_init(&s);
+		rs_cat_base64(&s, bytes.data(), bytes.size(), RS_BASE64_STANDARD);
+		benchmark::DoNotOptimize(s);
+		rs_free(&s);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * bytes.size()));
+}
+
+inline void std_base64_encode(benchmark::State& state)
+{
+	static const char chars[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	const auto bytes = base64_payload();
+
+	for (auto _ : state) {
+		std::string s;
+
+		for (std::size_t i = 0; i + 3 <= bytes.size(); i += 3) {
+			const auto v = static_cast<std::uint32_t>(
+				static_cast<unsigned char>(bytes[i]) << 16 |
+				static_cast<unsigned char>(bytes[i + 1]) << 8 |
+				static_cast<unsigned char>(bytes[i + 2]));
+
+			s += chars[v >> 18];
+			s += chars[v >> 12 & 0x3F];
+			s += chars[v >> 6 & 0x3F];
+			s += chars[v & 0x3F];
+		}
+
+		benchmark::DoNotOptimize(s);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * bytes.size()));
+}
+
+inline void rs_base64_decode(benchmark::State& state)
+{
+	const auto text = base64_encoded(base64_payload());
+
+	for (auto _ : state) {
+		rapidstring s;
+		rs_init(&s);
+		benchmark::DoNotOptimize(rs_decode_base64(&s, text.data(),
+							  text.size()));
+		benchmark::DoNotOptimize(s);
+		rs_free(&s);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * text.size()));
+}
+
+inline void std_base64_decode(benchmark::State& state)
+{
+	const auto text = base64_encoded(base64_payload());
+	const std::string chars{ "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+		"abcdefghijklmnopqrstuvwxyz0123456789+/" };
+	int values[256];
+
+	for (auto& v : values)
+		v = -1;
+
+	for (std::size_t i = 0; i < chars.size(); i++)
+		values[static_cast<unsigned char>(chars[i])] = static_cast<int>(i);
+
+	for (auto _ : state) {
+		std::string s;
+
+		for (std::size_t i = 0; i + 4 <= text.size(); i += 4) {
+			std::uint32_t v = 0;
+
+			for (std::size_t j = 0; j < 4; j++)
+				v = v << 6 | static_cast<std::uint32_t>(values[
+					static_cast<unsigned char>(text[i + j])]);
+
+			s += static_cast<char>(v >> 16);
+			s += static_cast<char>(v >> 8 & 0xFF);
+			s += static_cast<char>(v & 0xFF);
+		}
+
+		benchmark::DoNotOptimize(s);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * text.size()));
+}
+
+#endif // !BASE64_HPP_3E7A90C1D5B28F46
@@ -0,0 +1,118 @@
+#ifndef COMPRESS_HPP_5A2E91C7D04B36F8
+#define COMPRESS_HPP_5A2E91C7D04B36F8
+
+#ifdef RS_COMPRESSION
+
+#include "rapidstring.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Compression of cached log records, and their decompression when read. The
+ * ratio counter is the length of the records over their compressed length.
+ */
+
+constexpr const std::size_t compress_record_count{ 512 };
+
+inline std::vector<std::string> compress_records()
+{
+	static const char *const fields[] = { "\"method\":\"GET\",",
+		"\"method\":\"POST\",", "\"path\":\"/api/v1/users\",",
+		"\"path\":\"/api/v1/orders/", "\"status\":200,",
+		"\"status\":404,", "\"took_ms\":", "\"user\":\"" };
+	std::mt19937 gen{ 13 };
+	std::uniform_int_distribution<std::size_t> field{ 0, 7 };
+	std::uniform_int_distribution<int> number{ 0, 99999 };
+	std::uniform_int_distribution<std::size_t> len{ 200, 4000 };
+	std::vector<std::string> records;
+
+	for (std::size_t i = 0; i < compress_record_count; i++) {
+		const std::size_t n = len(gen);
+		std::string record{ "{" };
+
+		while (record.size() < n)
+			record += fields[field(gen)] +
+				std::to_string(number(gen)) + "\",";
+
+		records.push_back(record + "}");
+	}
+
+	return records;
+}
+
+inline void compress_reset(std::vector<rapidstring>& arr,
+			   const std::vector<std::string>& records)
+{
+	for (std::size_t i = 0; i < records.size(); i++)
+		rs_cpy_n(&arr[i], records[i].data(), records[i].size());
+}
+
+inline void rs_compress_records(benchmark::State& state)
+{
+	const auto records = compress_records();
+	std::vector<rapidstring> arr(records.size());
+	std::size_t bytes = 0;
+	std::size_t compressed = 0;
+
+	for (std::size_t i = 0; i < records.size(); i++) {
+		rs_init(&arr[i]);
+		bytes += records[i].size();
+	}
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		compress_reset(arr, records);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(rs_compress_all(arr.data(),
+							 arr.size()));
+	}
+
+	for (const auto& s : arr)
+		compressed += rs_compressed_len(&s);
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * bytes));
+	state.counters["ratio"] = static_cast<double>(bytes) /
+		static_cast<double>(compressed);
+
+	for (auto& s : arr)
+		rs_free(&s);
+}
+
+inline void rs_decompress_records(benchmark::State& state)
+{
+	const auto records = compress_records();
+	std::vector<rapidstring> arr(records.size());
+	std::size_t bytes = 0;
+
+	for (std::size_t i = 0; i < records.size(); i++) {
+		rs_init(&arr[i]);
+		bytes += records[i].size();
+	}
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		compress_reset(arr, records);
+		rs_compress_all(arr.data(), arr.size());
+		state.ResumeTiming();
+
+		// Reading the characters decompresses them.
+		for (auto& s : arr)
+			benchmark::DoNotOptimize(rs_data(&s));
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * bytes));
+
+	for (auto& s : arr)
+		rs_free(&s);
+}
+
+#endif // RS_COMPRESSION
+
+#endif // !COMPRESS_HPP_5A2E91C7D04B36F8
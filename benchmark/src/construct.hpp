@@ -78,4 +78,20 @@ inline void std_48_byte_construct(benchmark::State& state)
 		benchmark::DoNotOptimize(std::string{ STR_48, 48 });
 }
 
+inline void rs_48_byte_borrow(benchmark::State& state)
+{
+	rapidstring s;
+
+	for (auto _ : state) {
+		rs_init_borrow_n(&s, STR_48, 48);
+
+		// Without it GCC removes the loop, as nothing is allocated.
+		benchmark::DoNotOptimize(s);
+
+		rs_free(&s);
+	}
+
+	benchmark::DoNotOptimize(s);
+}
+
 #endif // !CONSTRUCT_HPP_7DFD4B503BE48168
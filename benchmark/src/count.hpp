@@ -0,0 +1,87 @@
+#ifndef COUNT_HPP_A4F17C3E90B5D268
+#define COUNT_HPP_A4F17C3E90B5D268
+
+#include "rapidstring.h"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Counting and indexing the lines of a few megabytes of log text, against
+ * the scalar loops over the characters they replace.
+ */
+
+inline std::string count_text()
+{
+	std::string text;
+
+	while (text.size() < 4 << 20)
+		text += "2018-04-02 12:01:44 INFO request handled in 12ms\n"
+			"2018-04-02 12:01:45 WARN retrying upstream connection "
+			"after a timeout of 30s\n";
+
+	return text;
+}
+
+inline void rs_count_lines(benchmark::State& state)
+{
+	const auto text = count_text();
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(rs_count_n(text.data(), text.size(),
+						    '\n'));
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * text.size()));
+}
+
+inline void std_count_lines(benchmark::State& state)
+{
+	const auto text = count_text();
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(std::count(text.begin(), text.end(),
+						    '\n'));
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * text.size()));
+}
+
+inline void rs_index_lines(benchmark::State& state)
+{
+	const auto text = count_text();
+	std::vector<std::size_t> offsets(text.size() / 32);
+
+	for (auto _ : state) {
+		rs_line_index_n(text.data(), text.size(), offsets.data(),
+				offsets.size());
+		benchmark::DoNotOptimize(offsets.data());
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * text.size()));
+}
+
+inline void loop_index_lines(benchmark::State& state)
+{
+	const auto text = count_text();
+	std::vector<std::size_t> offsets(text.size() / 32);
+
+	for (auto _ : state) {
+		std::size_t count = 0;
+
+		for (std::size_t i = 0; i < text.size(); i++)
+			if (text[i] == '\n')
+				offsets[count++] = i;
+
+		benchmark::DoNotOptimize(offsets.data());
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * text.size()));
+}
+
+#endif // !COUNT_HPP_A4F17C3E90B5D268
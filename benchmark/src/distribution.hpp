@@ -0,0 +1,118 @@
+#ifndef DISTRIBUTION_HPP_8A4F2C6E1B9D3705
+#define DISTRIBUTION_HPP_8A4F2C6E1B9D3705
+
+#include "rapidstring.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <vector>
+
+/*
+ * String size distributions. Sizes are generated once, ahead of the timed
+ * loop, and cycled through so the generator never shows up in the counters.
+ */
+enum distribution {
+	// Uniform sizes in [0, 128).
+	uniform_dist,
+	// Zipfian sizes in [1, 256], short strings being the most frequent.
+	zipf_dist,
+	// 80% of the sizes fit the stack capacity, 20% are in [64, 512).
+	bimodal_dist,
+	// Sizes read from the file named by RS_BENCH_TRACE, one per line.
+	trace_dist,
+	dist_count
+};
+
+constexpr const std::size_t dist_samples{ 4096 };
+constexpr const std::size_t dist_max{ 512 };
+
+inline std::vector<std::size_t> make_sizes(distribution dist)
+{
+	std::vector<std::size_t> sizes;
+	std::mt19937 gen{ 42 };
+
+	switch (dist) {
+	case uniform_dist: {
+		std::uniform_int_distribution<std::size_t> d{ 0, 127 };
+
+		for (std::size_t i = 0; i < dist_samples; i++)
+			sizes.push_back(d(gen));
+
+		break;
+	}
+	case zipf_dist: {
+		std::vector<double> weights;
+
+		for (std::size_t i = 1; i <= 256; i++)
+			weights.push_back(1.0 / static_cast<double>(i));
+
+		std::discrete_distribution<std::size_t> d{
+			weights.begin(), weights.end() };
+
+		for (std::size_t i = 0; i < dist_samples; i++)
+			sizes.push_back(d(gen) + 1);
+
+		break;
+	}
+	case bimodal_dist: {
+		std::bernoulli_distribution heap{ 0.2 };
+		std::uniform_int_distribution<std::size_t> small{
+			0, RS_STACK_CAPACITY };
+		std::uniform_int_distribution<std::size_t> large{ 64, 511 };
+
+		for (std::size_t i = 0; i < dist_samples; i++)
+			sizes.push_back(heap(gen) ? large(gen) : small(gen));
+
+		break;
+	}
+	case trace_dist: {
+		const char *path = std::getenv("RS_BENCH_TRACE");
+
+		if (!path)
+			break;
+
+		std::ifstream trace{ path };
+		std::size_t n;
+
+		while (sizes.size() < dist_samples && trace >> n)
+			sizes.push_back(std::min(n, dist_max - 1));
+
+		break;
+	}
+	default:
+		break;
+	}
+
+	// The timed loops mask the index, which requires a power of two.
+	const std::size_t n{ sizes.size() };
+
+	if (n)
+		while (sizes.size() & (sizes.size() - 1))
+			sizes.push_back(sizes[sizes.size() - n]);
+
+	return sizes;
+}
+
+inline const std::vector<std::size_t>& sizes_of(distribution dist)
+{
+	static const std::vector<std::size_t> all[dist_count] = {
+		make_sizes(uniform_dist),
+		make_sizes(zipf_dist),
+		make_sizes(bimodal_dist),
+		make_sizes(trace_dist)
+	};
+
+	return all[dist];
+}
+
+inline const char *dist_source()
+{
+	static const std::vector<char> source(dist_max * 2, 'x');
+
+	return source.data();
+}
+
+#endif // !DISTRIBUTION_HPP_8A4F2C6E1B9D3705
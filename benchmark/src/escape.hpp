@@ -0,0 +1,72 @@
+#ifndef ESCAPE_HPP_51F0B7E93A6C2D48
+#define ESCAPE_HPP_51F0B7E93A6C2D48
+
+#include "rapidstring.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * JSON escaping of text with a special character every few dozen bytes,
+ * against the usual loop escaping one character at a time.
+ */
+
+inline std::string escape_text()
+{
+	std::string text;
+
+	while (text.size() < 64 * 1024)
+		text += "{\"user\": \"anonymous\", \"path\": \"/api/v1/items\"}\n"
+			"plain text without anything to escape in it\t";
+
+	return text;
+}
+
+inline void rs_json_escape(benchmark::State& state)
+{
+	const auto text = escape_text();
+
+	for (auto _ : state) {
+		rapidstring s;
+		rs_init(&s);
+		rs_cat_json_escaped_n(&s, text.data(), text.size());
+		benchmark::DoNotOptimize(s);
+		rs_free(&s);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * text.size()));
+}
+
+inline void std_json_escape(benchmark::State& state)
+{
+	static const char hex[] = "0123456789abcdef";
+	const auto text = escape_text();
+
+	for (auto _ : state) {
+		std::string s;
+
+		for (const char c : text) {
+			const auto u = static_cast<unsigned char>(c);
+
+			if (c == '"' || c == '\\') {
+				s += '\\';
+				s += c;
+			} else if (u < 0x20) {
+				s += "\\u00";
+				s += hex[u >> 4];
+				s += hex[u & 15];
+			} else {
+				s += c;
+			}
+		}
+
+		benchmark::DoNotOptimize(s);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * text.size()));
+}
+
+#endif // !ESCAPE_HPP_51F0B7E93A6C2D48
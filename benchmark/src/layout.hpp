@@ -0,0 +1,97 @@
+#ifndef LAYOUT_HPP_5E2B8D0C47A9F163
+#define LAYOUT_HPP_5E2B8D0C47A9F163
+
+#include "rapidstring.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * A large array of mostly short strings, built and then scanned. Comparing
+ * the default benchmark with `rapidstring_benchmark_size_t32` shows the cost
+ * of the string layout, with the memory per string reported as a counter.
+ */
+
+constexpr const std::size_t layout_string_count{ 1 << 20 };
+
+inline std::vector<std::string> layout_strings()
+{
+	std::mt19937 gen{ 3 };
+	std::geometric_distribution<std::size_t> len{ 1.0 / 16 };
+	std::vector<std::string> strs;
+
+	for (std::size_t i = 0; i < layout_string_count; i++)
+		strs.emplace_back(len(gen), 'a' + static_cast<char>(i % 26));
+
+	return strs;
+}
+
+inline std::size_t layout_bytes(const std::vector<rapidstring>& arr)
+{
+	std::size_t bytes = arr.size() * sizeof(rapidstring);
+
+	for (const auto& s : arr)
+		if (rs_is_heap(&s))
+			bytes += rs_capacity(&s) + 1;
+
+	return bytes;
+}
+
+inline void rs_layout_build(benchmark::State& state)
+{
+	const auto strs = layout_strings();
+	std::vector<rapidstring> arr(strs.size());
+	std::size_t bytes = 0;
+
+	for (auto _ : state) {
+		for (std::size_t i = 0; i < strs.size(); i++)
+			rs_init_w_n(&arr[i], strs[i].data(), strs[i].size());
+
+		benchmark::DoNotOptimize(arr.data());
+
+		state.PauseTiming();
+		bytes = layout_bytes(arr);
+
+		for (auto& s : arr)
+			rs_free(&s);
+
+		state.ResumeTiming();
+	}
+
+	state.counters["bytes_per_string"] = static_cast<double>(bytes) /
+		static_cast<double>(strs.size());
+	state.SetItemsProcessed(static_cast<std::int64_t>(
+		state.iterations() * strs.size()));
+}
+
+inline void rs_layout_scan(benchmark::State& state)
+{
+	const auto strs = layout_strings();
+	std::vector<rapidstring> arr(strs.size());
+
+	for (std::size_t i = 0; i < strs.size(); i++)
+		rs_init_w_n(&arr[i], strs[i].data(), strs[i].size());
+
+	for (auto _ : state) {
+		std::size_t sum = 0;
+
+		for (const auto& s : arr)
+			sum += rs_len(&s) +
+				static_cast<unsigned char>(rs_data_c(&s)[0]);
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.counters["bytes_per_string"] = static_cast<double>(
+		layout_bytes(arr)) / static_cast<double>(arr.size());
+	state.SetItemsProcessed(static_cast<std::int64_t>(
+		state.iterations() * arr.size()));
+
+	for (auto& s : arr)
+		rs_free(&s);
+}
+
+#endif // !LAYOUT_HPP_5E2B8D0C47A9F163
@@ -0,0 +1,108 @@
+#ifndef LOAD_HPP_9C03E6B2F17A845D
+#define LOAD_HPP_9C03E6B2F17A845D
+
+#include "rapidstring.h"
+
+#if RS_POSIX
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+/*
+ * Startup loading of many small templates. The files are in the page cache,
+ * so this measures the cost per file rather than the device.
+ */
+
+constexpr const std::size_t load_file_count{ 1000 };
+
+struct load_files {
+	load_files()
+	{
+		char tmpl[] = "/tmp/rs_bench_load_XXXXXX";
+
+		if (!mkdtemp(tmpl))
+			std::abort();
+
+		dir = tmpl;
+
+		for (std::size_t i = 0; i < load_file_count; i++) {
+			const std::string path{ dir + '/' + std::to_string(i) };
+			std::ofstream out{ path, std::ios::binary };
+
+			out << std::string(512 + i * 37 % 16384,
+					   static_cast<char>('a' + i % 26));
+			paths.push_back(path);
+		}
+
+		for (const auto& path : paths)
+			cpaths.push_back(path.c_str());
+	}
+
+	~load_files()
+	{
+		for (const auto& path : paths)
+			std::remove(path.c_str());
+
+		rmdir(dir.c_str());
+	}
+
+	std::string dir;
+	std::vector<std::string> paths;
+	std::vector<const char*> cpaths;
+};
+
+inline void rs_load_templates(benchmark::State& state)
+{
+	const load_files files;
+	std::vector<rapidstring> arr(files.paths.size());
+
+	for (auto& s : arr)
+		rs_init(&s);
+
+	for (auto _ : state) {
+		if (rs_load_files(arr.data(), files.cpaths.data(),
+				  files.cpaths.size(), NULL) != 0)
+			state.SkipWithError("load failed");
+
+		benchmark::DoNotOptimize(arr.data());
+	}
+
+	state.SetItemsProcessed(static_cast<std::int64_t>(
+		state.iterations() * arr.size()));
+
+	for (auto& s : arr)
+		rs_free(&s);
+}
+
+inline void std_load_templates(benchmark::State& state)
+{
+	const load_files files;
+	std::vector<std::string> arr(files.paths.size());
+
+	for (auto _ : state) {
+		for (std::size_t i = 0; i < arr.size(); i++) {
+			std::ifstream in{ files.paths[i], std::ios::binary };
+			std::ostringstream out;
+
+			out << in.rdbuf();
+			arr[i] = out.str();
+		}
+
+		benchmark::DoNotOptimize(arr.data());
+	}
+
+	state.SetItemsProcessed(static_cast<std::int64_t>(
+		state.iterations() * arr.size()));
+}
+
+#endif // RS_POSIX
+
+#endif // !LOAD_HPP_9C03E6B2F17A845D
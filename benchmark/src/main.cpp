@@ -1,9 +1,23 @@
 #include "append.hpp"
+#include "base64.hpp"
+#include "compress.hpp"
 #include "construct.hpp"
+#include "count.hpp"
+#include "escape.hpp"
+#include "layout.hpp"
+#include "load.hpp"
+#include "map.hpp"
+#include "match.hpp"
+#include "parse.hpp"
+#include "pool.hpp"
+#include "radix.hpp"
 #include "resize.hpp"
+#include "sink.hpp"
+#include "threads.hpp"
+#include "workload.hpp"
 #include <benchmark/benchmark.h>
+#include <cstdlib>
 
-// TODO: add fbstring to benchmarks
 // TODO: add intel compiler to benchmarks
 
 // Concatenation
@@ -23,8 +37,117 @@ BENCHMARK(std_24_byte_construct);
 BENCHMARK(rs_48_byte_construct);
 BENCHMARK(std_48_byte_construct);
 
+BENCHMARK(rs_48_byte_borrow);
+
 // Resizing
 BENCHMARK(rs_resize);
 BENCHMARK(std_resize);
 
+// String layout
+BENCHMARK(rs_layout_build);
+BENCHMARK(rs_layout_scan);
+
+// Pooling
+BENCHMARK(rs_pool_requests);
+BENCHMARK(rs_free_requests);
+
+// Escaping
+BENCHMARK(rs_json_escape);
+BENCHMARK(std_json_escape);
+
+// Base64
+BENCHMARK(rs_base64_encode);
+BENCHMARK(std_base64_encode);
+
+BENCHMARK(rs_base64_decode);
+BENCHMARK(std_base64_decode);
+
+// Numeric parsing
+BENCHMARK(rs_parse_i64);
+BENCHMARK(std_parse_i64);
+
+BENCHMARK(rs_parse_double);
+BENCHMARK(std_parse_double);
+
+// Hash map
+BENCHMARK(rs_map_index);
+BENCHMARK(std_map_index);
+
+// Radix tree
+BENCHMARK(rs_radix_route);
+BENCHMARK(std_binary_search_route);
+
+// File loading
+#if RS_POSIX
+BENCHMARK(rs_load_templates);
+BENCHMARK(std_load_templates);
+#endif
+
+// Compression
+#ifdef RS_COMPRESSION
+BENCHMARK(rs_compress_records);
+BENCHMARK(rs_decompress_records);
+#endif
+
+// Streaming output
+BENCHMARK(rs_sink_export);
+BENCHMARK(rs_whole_export);
+
+// Counting
+BENCHMARK(rs_count_lines);
+BENCHMARK(std_count_lines);
+
+BENCHMARK(rs_index_lines);
+BENCHMARK(loop_index_lines);
+
+// Multi-pattern replacement
+BENCHMARK(rs_matcher_redact);
+BENCHMARK(std_find_redact);
+
+// Size distributions with hardware counters
+static void dist_args(benchmark::internal::Benchmark *b)
+{
+	// The trace distribution only has sizes when RS_BENCH_TRACE is set.
+	for (int dist = 0; dist < dist_count; dist++)
+		if (dist != trace_dist || std::getenv("RS_BENCH_TRACE"))
+			b->Arg(dist);
+}
+
+#define DIST_BENCHMARK(f, impl)					\
+	BENCHMARK_TEMPLATE(f, impl)				\
+		->Apply(dist_args)				\
+		->ArgName("dist")
+
+#ifdef RS_BENCH_FBSTRING
+  #define DIST_BENCHMARKS(f)					\
+	DIST_BENCHMARK(f, rs_impl);				\
+	DIST_BENCHMARK(f, std_impl);				\
+	DIST_BENCHMARK(f, fb_impl)
+#else
+  #define DIST_BENCHMARKS(f)					\
+	DIST_BENCHMARK(f, rs_impl);				\
+	DIST_BENCHMARK(f, std_impl)
+#endif
+
+DIST_BENCHMARKS(dist_construct);
+DIST_BENCHMARKS(dist_assign);
+DIST_BENCHMARKS(dist_append);
+DIST_BENCHMARKS(dist_resize);
+DIST_BENCHMARKS(dist_reserve_append);
+DIST_BENCHMARKS(dist_access);
+
+// Allocator contention across threads
+#define MT_BENCHMARK(f, backend)				\
+	BENCHMARK_TEMPLATE(f, backend)				\
+		->Apply(dist_args)				\
+		->ArgName("dist")				\
+		->ThreadRange(1, mt_max_threads())		\
+		->UseRealTime()
+
+MT_BENCHMARK(mt_churn, malloc_backend);
+MT_BENCHMARK(mt_churn, pool_backend);
+
+MT_BENCHMARK(mt_handoff, malloc_backend);
+MT_BENCHMARK(mt_handoff, pool_backend);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,87 @@
+#ifndef MAP_HPP_E4A1973C58D20B6F
+#define MAP_HPP_E4A1973C58D20B6F
+
+#include "rapidstring.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Building an index of short identifiers and looking every one of them up
+ * again from a buffer, as when joining records on a key field.
+ */
+
+constexpr const std::size_t map_key_count{ 100000 };
+
+inline std::string map_keys(std::vector<std::size_t>& offsets)
+{
+	std::string buffer;
+
+	for (std::size_t i = 0; i < map_key_count; i++) {
+		offsets.push_back(buffer.size());
+		buffer += "user:" + std::to_string(i * 7919 % 1000003);
+	}
+
+	offsets.push_back(buffer.size());
+
+	return buffer;
+}
+
+inline void rs_map_index(benchmark::State& state)
+{
+	std::vector<std::size_t> offsets;
+	const auto buffer = map_keys(offsets);
+
+	for (auto _ : state) {
+		rs_map m;
+		rs_map_init(&m, sizeof(std::uint64_t), 0);
+
+		for (std::size_t i = 0; i < map_key_count; i++)
+			*static_cast<std::uint64_t*>(rs_map_insert_n(&m,
+				buffer.data() + offsets[i],
+				offsets[i + 1] - offsets[i], nullptr)) = i;
+
+		std::uint64_t sum = 0;
+
+		for (std::size_t i = 0; i < map_key_count; i++)
+			sum += *static_cast<std::uint64_t*>(rs_map_find_n(&m,
+				buffer.data() + offsets[i],
+				offsets[i + 1] - offsets[i]));
+
+		benchmark::DoNotOptimize(sum);
+		rs_map_free(&m);
+	}
+
+	state.SetItemsProcessed(static_cast<std::int64_t>(
+		state.iterations() * map_key_count));
+}
+
+inline void std_map_index(benchmark::State& state)
+{
+	std::vector<std::size_t> offsets;
+	const auto buffer = map_keys(offsets);
+
+	for (auto _ : state) {
+		std::unordered_map<std::string, std::uint64_t> m;
+
+		for (std::size_t i = 0; i < map_key_count; i++)
+			m[buffer.substr(offsets[i], offsets[i + 1] - offsets[i])] =
+				i;
+
+		std::uint64_t sum = 0;
+
+		for (std::size_t i = 0; i < map_key_count; i++)
+			sum += m.find(buffer.substr(offsets[i], offsets[i + 1] -
+						    offsets[i]))->second;
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(static_cast<std::int64_t>(
+		state.iterations() * map_key_count));
+}
+
+#endif // !MAP_HPP_E4A1973C58D20B6F
@@ -0,0 +1,120 @@
+#ifndef MATCH_HPP_8D41C2A07B3E95F6
+#define MATCH_HPP_8D41C2A07B3E95F6
+
+#include "rapidstring.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Redaction of many tokens in log text. The tokens are alphanumeric, so
+ * nearly every character of the text may start one and the automaton cannot
+ * skip ahead. The naive alternative searches for each token in turn.
+ */
+
+constexpr const std::size_t match_token_count{ 200 };
+constexpr const std::size_t match_text_len{ 1 << 20 };
+
+inline std::vector<std::string> match_tokens()
+{
+	std::mt19937 gen{ 7 };
+	std::uniform_int_distribution<int> len{ 8, 24 };
+	std::uniform_int_distribution<int> c{ 0, 35 };
+	std::vector<std::string> tokens;
+
+	for (std::size_t i = 0; i < match_token_count; i++) {
+		std::string token;
+
+		for (int j = len(gen); j > 0; j--) {
+			const int v = c(gen);
+			token += static_cast<char>(v < 10 ? '0' + v :
+						   'a' + v - 10);
+		}
+
+		tokens.push_back(token);
+	}
+
+	return tokens;
+}
+
+inline std::string match_text(const std::vector<std::string>& tokens)
+{
+	static const char *const lines[] = {
+		"2018-04-02 12:01:44 INFO request handled in 12ms user=",
+		"2018-04-02 12:01:45 WARN retrying upstream connection key=",
+		"2018-04-02 12:01:45 DEBUG cache miss for session ",
+	};
+
+	std::mt19937 gen{ 11 };
+	std::uniform_int_distribution<std::size_t> d{ 0, tokens.size() - 1 };
+	std::string text;
+
+	// One token in every few lines.
+	for (std::size_t i = 0; text.size() < match_text_len; i++)
+		text += std::string{ lines[i % 3] } +
+			(i % 4 ? "anonymous" : tokens[d(gen)]) + '\n';
+
+	return text;
+}
+
+inline void rs_matcher_redact(benchmark::State& state)
+{
+	const auto tokens = match_tokens();
+	const auto text = match_text(tokens);
+
+	std::vector<rapidstring> patterns(tokens.size());
+	std::vector<rapidstring> repls(tokens.size());
+
+	for (std::size_t i = 0; i < tokens.size(); i++) {
+		rs_init_w_n(&patterns[i], tokens[i].data(), tokens[i].size());
+		rs_init_w(&repls[i], "[redacted]");
+	}
+
+	rs_matcher m;
+	rs_matcher_init(&m, patterns.data(), patterns.size());
+
+	rapidstring dst;
+	rs_init(&dst);
+
+	for (auto _ : state) {
+		rs_matcher_replace_all_n(&m, &dst, text.data(), text.size(),
+					 repls.data());
+		benchmark::DoNotOptimize(dst);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * text.size()));
+
+	rs_free(&dst);
+	rs_matcher_free(&m);
+
+	for (std::size_t i = 0; i < tokens.size(); i++) {
+		rs_free(&patterns[i]);
+		rs_free(&repls[i]);
+	}
+}
+
+inline void std_find_redact(benchmark::State& state)
+{
+	const auto tokens = match_tokens();
+	const auto text = match_text(tokens);
+
+	for (auto _ : state) {
+		std::string dst{ text };
+
+		for (const auto& token : tokens)
+			for (auto pos = dst.find(token); pos != std::string::npos;
+			     pos = dst.find(token, pos + 10))
+				dst.replace(pos, token.size(), "[redacted]");
+
+		benchmark::DoNotOptimize(dst);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * text.size()));
+}
+
+#endif // !MATCH_HPP_8D41C2A07B3E95F6
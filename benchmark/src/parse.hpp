@@ -0,0 +1,139 @@
+#ifndef PARSE_HPP_C62D18F4A09E73B5
+#define PARSE_HPP_C62D18F4A09E73B5
+
+#include "rapidstring.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+/*
+ * Parsing the numeric fields of CSV rows, against strtoll() and strtod() on
+ * the same buffer. The fields are separated by commas, so neither side needs
+ * a copy to terminate them.
+ */
+
+inline std::string parse_integers()
+{
+	std::mt19937_64 gen{ 3 };
+	std::uniform_int_distribution<long long> d{ -10000000000LL,
+		10000000000LL };
+	std::string csv;
+
+	while (csv.size() < 64 * 1024)
+		csv += std::to_string(d(gen)) + ',';
+
+	return csv;
+}
+
+inline std::string parse_doubles()
+{
+	std::mt19937_64 gen{ 3 };
+	std::uniform_real_distribution<double> d{ -1000.0, 1000.0 };
+	std::string csv;
+	char buf[32];
+
+	// Prices and measurements with a few decimals, and full precision.
+	for (int i = 0; csv.size() < 64 * 1024; i++) {
+		std::snprintf(buf, sizeof(buf), i % 4 ? "%.2f," : "%.17g,",
+			      d(gen));
+		csv += buf;
+	}
+
+	return csv;
+}
+
+inline void rs_parse_i64(benchmark::State& state)
+{
+	const auto csv = parse_integers();
+
+	for (auto _ : state) {
+		const char *p = csv.data();
+		const char *end = p + csv.size();
+		std::int64_t sum = 0;
+
+		while (p < end) {
+			std::int64_t v = 0;
+			p += rs_to_i64_n(p, static_cast<std::size_t>(end - p),
+					 &v) + 1;
+			sum += v;
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * csv.size()));
+}
+
+inline void std_parse_i64(benchmark::State& state)
+{
+	const auto csv = parse_integers();
+
+	for (auto _ : state) {
+		const char *p = csv.data();
+		const char *end = p + csv.size();
+		std::int64_t sum = 0;
+
+		while (p < end) {
+			char *next;
+			sum += std::strtoll(p, &next, 10);
+			p = next + 1;
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * csv.size()));
+}
+
+inline void rs_parse_double(benchmark::State& state)
+{
+	const auto csv = parse_doubles();
+
+	for (auto _ : state) {
+		const char *p = csv.data();
+		const char *end = p + csv.size();
+		double sum = 0;
+
+		while (p < end) {
+			double v = 0;
+			p += rs_to_double_n(p, static_cast<std::size_t>(end - p),
+					    &v) + 1;
+			sum += v;
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * csv.size()));
+}
+
+inline void std_parse_double(benchmark::State& state)
+{
+	const auto csv = parse_doubles();
+
+	for (auto _ : state) {
+		const char *p = csv.data();
+		const char *end = p + csv.size();
+		double sum = 0;
+
+		while (p < end) {
+			char *next;
+			sum += std::strtod(p, &next);
+			p = next + 1;
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * csv.size()));
+}
+
+#endif // !PARSE_HPP_C62D18F4A09E73B5
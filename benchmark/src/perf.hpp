@@ -0,0 +1,125 @@
+#ifndef PERF_HPP_5C1E0A7B3D2F4E96
+#define PERF_HPP_5C1E0A7B3D2F4E96
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+/*
+ * Reads hardware counters of the calling thread through perf_event_open().
+ * The counters are opened as a single group so they are scheduled together.
+ * When the counters are unavailable (not Linux, perf_event_paranoid, no PMU
+ * in a virtual machine), the benchmark is labeled instead.
+ */
+class perf_counters {
+public:
+	perf_counters()
+	{
+#ifdef __linux__
+		static const std::uint64_t configs[count] = {
+			PERF_COUNT_HW_CPU_CYCLES,
+			PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_BRANCH_MISSES,
+			PERF_COUNT_HW_CACHE_MISSES
+		};
+
+		for (std::size_t i = 0; i < count; i++) {
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.size = sizeof(attr);
+			attr.config = configs[i];
+			attr.disabled = i == 0;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP;
+
+			fds_[i] = static_cast<int>(syscall(__NR_perf_event_open,
+				&attr, 0, -1, i == 0 ? -1 : fds_[0], 0));
+
+			if (fds_[i] == -1) {
+				close_all();
+				return;
+			}
+		}
+#endif
+	}
+
+	perf_counters(const perf_counters&) = delete;
+	perf_counters& operator=(const perf_counters&) = delete;
+
+	~perf_counters()
+	{
+		close_all();
+	}
+
+	void start()
+	{
+#ifdef __linux__
+		if (fds_[0] == -1)
+			return;
+
+		ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+	}
+
+	void stop(benchmark::State& state)
+	{
+#ifdef __linux__
+		struct {
+			std::uint64_t nr;
+			std::uint64_t values[count];
+		} group;
+
+		if (fds_[0] != -1) {
+			ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+			if (read(fds_[0], &group, sizeof(group)) ==
+			    static_cast<ssize_t>(sizeof(group))) {
+				static const char *const names[count] = {
+					"cycles",
+					"instructions",
+					"branch_misses",
+					"cache_misses"
+				};
+
+				for (std::size_t i = 0; i < count; i++)
+					state.counters[names[i]] = benchmark::Counter(
+						static_cast<double>(group.values[i]),
+						benchmark::Counter::kAvgIterations);
+
+				return;
+			}
+		}
+#endif
+		state.SetLabel("hardware counters unavailable");
+	}
+
+private:
+	static constexpr std::size_t count{ 4 };
+
+	void close_all()
+	{
+#ifdef __linux__
+		for (std::size_t i = 0; i < count; i++) {
+			if (fds_[i] != -1)
+				close(fds_[i]);
+
+			fds_[i] = -1;
+		}
+#endif
+	}
+
+	int fds_[count]{ -1, -1, -1, -1 };
+};
+
+#endif // !PERF_HPP_5C1E0A7B3D2F4E96
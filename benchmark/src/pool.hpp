@@ -0,0 +1,65 @@
+#ifndef POOL_HPP_7B19E4D2A6C0F358
+#define POOL_HPP_7B19E4D2A6C0F358
+
+#include "rapidstring.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <string>
+
+/*
+ * Requests building a few scratch strings of 32 kilobytes each, either
+ * created and freed by every request or reused through a pool. The strings
+ * grow together, a block at a time, so none of them is at the top of the
+ * heap where the allocator could extend it in place: growing copies, which
+ * is the cost the pool removes.
+ */
+
+constexpr const int pool_scratch_count{ 4 };
+constexpr const int pool_scratch_appends{ 64 };
+constexpr const std::size_t pool_block_size{ 512 };
+
+inline void pool_request(rapidstring *scratch)
+{
+	static const std::string block(pool_block_size, 'x');
+
+	for (int j = 0; j < pool_scratch_appends; j++)
+		for (int i = 0; i < pool_scratch_count; i++)
+			rs_cat_n(&scratch[i], block.data(), block.size());
+
+	benchmark::DoNotOptimize(scratch);
+}
+
+inline void rs_pool_requests(benchmark::State& state)
+{
+	rs_pool *p = rs_pool_local();
+	rapidstring scratch[pool_scratch_count];
+
+	for (auto _ : state) {
+		for (auto& s : scratch)
+			rs_pool_acquire(p, &s);
+
+		pool_request(scratch);
+
+		for (auto& s : scratch)
+			rs_pool_release(p, &s);
+	}
+
+	rs_pool_free(p);
+}
+
+inline void rs_free_requests(benchmark::State& state)
+{
+	rapidstring scratch[pool_scratch_count];
+
+	for (auto _ : state) {
+		for (auto& s : scratch)
+			rs_init(&s);
+
+		pool_request(scratch);
+
+		for (auto& s : scratch)
+			rs_free(&s);
+	}
+}
+
+#endif // !POOL_HPP_7B19E4D2A6C0F358
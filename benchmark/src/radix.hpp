@@ -0,0 +1,147 @@
+#ifndef RADIX_HPP_3F6B0D92C1E7A458
+#define RADIX_HPP_3F6B0D92C1E7A458
+
+#include "rapidstring.h"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Routing of request paths to the longest matching route prefix. The
+ * alternative binary searches a sorted vector of the routes once for every
+ * length of the path.
+ */
+
+constexpr const std::size_t radix_route_count{ 2000 };
+constexpr const std::size_t radix_path_count{ 1 << 12 };
+
+inline std::string radix_segment(std::mt19937& gen)
+{
+	static const char *const segments[] = { "api", "v1", "v2", "users",
+		"orders", "items", "search", "static", "images", "admin" };
+	std::uniform_int_distribution<std::size_t> d{ 0, 19 };
+	const std::size_t i = d(gen);
+
+	// Half of the segments are identifiers, the rest are shared words.
+	return '/' + (i < 10 ? std::string{ segments[i] } :
+		      std::to_string(d(gen) * 37 + i));
+}
+
+inline std::vector<std::string> radix_routes()
+{
+	std::mt19937 gen{ 5 };
+	std::uniform_int_distribution<int> depth{ 1, 4 };
+	std::vector<std::string> routes;
+
+	while (routes.size() < radix_route_count) {
+		std::string route;
+
+		for (int i = depth(gen); i > 0; i--)
+			route += radix_segment(gen);
+
+		routes.push_back(route);
+		std::sort(routes.begin(), routes.end());
+		routes.erase(std::unique(routes.begin(), routes.end()),
+			     routes.end());
+	}
+
+	return routes;
+}
+
+inline std::vector<std::string> radix_paths(
+	const std::vector<std::string>& routes)
+{
+	std::mt19937 gen{ 9 };
+	std::uniform_int_distribution<std::size_t> d{ 0, routes.size() - 1 };
+	std::uniform_int_distribution<int> extra{ 0, 3 };
+	std::vector<std::string> paths;
+
+	for (std::size_t i = 0; i < radix_path_count; i++) {
+		std::string path{ routes[d(gen)] };
+
+		for (int j = extra(gen); j > 0; j--)
+			path += radix_segment(gen);
+
+		paths.push_back(path);
+	}
+
+	return paths;
+}
+
+inline void rs_radix_route(benchmark::State& state)
+{
+	const auto routes = radix_routes();
+	const auto paths = radix_paths(routes);
+
+	std::vector<rapidstring> keys(routes.size());
+	std::vector<void*> values(routes.size());
+
+	for (std::size_t i = 0; i < routes.size(); i++) {
+		rs_init_w_n(&keys[i], routes[i].data(), routes[i].size());
+		values[i] = &keys[i];
+	}
+
+	rs_radix_tree t;
+	rs_radix_init(&t);
+	rs_radix_build(&t, keys.data(), values.data(), keys.size());
+
+	for (auto _ : state) {
+		std::size_t total = 0;
+
+		for (const auto& path : paths) {
+			std::size_t len = 0;
+
+			if (rs_radix_longest_prefix_n(&t, path.data(), path.size(),
+						      &len))
+				total += len;
+		}
+
+		benchmark::DoNotOptimize(total);
+	}
+
+	state.SetItemsProcessed(static_cast<std::int64_t>(
+		state.iterations() * paths.size()));
+
+	rs_radix_free(&t);
+
+	for (auto& s : keys)
+		rs_free(&s);
+}
+
+inline void std_binary_search_route(benchmark::State& state)
+{
+	const auto routes = radix_routes();
+	const auto paths = radix_paths(routes);
+
+	for (auto _ : state) {
+		std::size_t total = 0;
+
+		for (const auto& path : paths) {
+			for (std::size_t len = path.size(); len > 0; len--) {
+				const auto it = std::lower_bound(routes.begin(),
+					routes.end(), path,
+					[len](const std::string& route,
+					      const std::string& p) {
+						return p.compare(0, len, route) > 0;
+					});
+
+				if (it != routes.end() &&
+				    path.compare(0, len, *it) == 0) {
+					total += len;
+					break;
+				}
+			}
+		}
+
+		benchmark::DoNotOptimize(total);
+	}
+
+	state.SetItemsProcessed(static_cast<std::int64_t>(
+		state.iterations() * paths.size()));
+}
+
+#endif // !RADIX_HPP_3F6B0D92C1E7A458
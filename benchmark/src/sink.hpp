@@ -0,0 +1,81 @@
+#ifndef SINK_HPP_3C6E0A9F8B1D7254
+#define SINK_HPP_3C6E0A9F8B1D7254
+
+#include "rapidstring.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * An export of many CSV records, either streamed through a sink which hands
+ * each full buffer to a checksum or built whole in one string first. The
+ * peak capacity is reported as a counter.
+ */
+
+constexpr const std::uint64_t sink_record_count{ 1 << 18 };
+
+inline int sink_checksum(void *data, const char *buffer, std::size_t n)
+{
+	auto sum = static_cast<std::uint64_t*>(data);
+
+	for (std::size_t i = 0; i < n; i++)
+		*sum = *sum * 31 + static_cast<unsigned char>(buffer[i]);
+
+	return 0;
+}
+
+inline void rs_sink_export(benchmark::State& state)
+{
+	std::uint64_t sum = 0;
+	std::size_t peak = 0;
+
+	for (auto _ : state) {
+		rs_sink k;
+		rs_sink_init(&k, 0, sink_checksum, &sum);
+
+		for (std::uint64_t i = 0; i < sink_record_count; i++) {
+			rs_sink_cat_u64(&k, i);
+			rs_sink_cat_n(&k, ",item,", 6);
+			rs_sink_cat_i64(&k, static_cast<std::int64_t>(i * 7) - 1000);
+			rs_sink_cat_n(&k, "\n", 1);
+		}
+
+		rs_sink_flush(&k);
+		peak = rs_capacity(rs_sink_string(&k, 0));
+		rs_sink_free(&k);
+	}
+
+	benchmark::DoNotOptimize(sum);
+	state.counters["peak"] = static_cast<double>(peak);
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * sink_record_count * 16));
+}
+
+inline void rs_whole_export(benchmark::State& state)
+{
+	std::uint64_t sum = 0;
+	std::size_t peak = 0;
+
+	for (auto _ : state) {
+		rapidstring s;
+		rs_init(&s);
+
+		for (std::uint64_t i = 0; i < sink_record_count; i++) {
+			rs_cat_u64(&s, i);
+			rs_cat_n(&s, ",item,", 6);
+			rs_cat_i64(&s, static_cast<std::int64_t>(i * 7) - 1000);
+			rs_cat_n(&s, "\n", 1);
+		}
+
+		sink_checksum(&sum, rs_data(&s), rs_len(&s));
+		peak = rs_capacity(&s);
+		rs_free(&s);
+	}
+
+	benchmark::DoNotOptimize(sum);
+	state.counters["peak"] = static_cast<double>(peak);
+	state.SetBytesProcessed(static_cast<std::int64_t>(
+		state.iterations() * sink_record_count * 16));
+}
+
+#endif // !SINK_HPP_3C6E0A9F8B1D7254
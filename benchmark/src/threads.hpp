@@ -0,0 +1,184 @@
+#ifndef THREADS_HPP_4F6A1D93C2B7E508
+#define THREADS_HPP_4F6A1D93C2B7E508
+
+#include "distribution.hpp"
+#include "rapidstring.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Allocator contention, which the single threaded benchmarks cannot show.
+ * Every benchmark runs from one thread up to every core, and builds its
+ * strings in short appends so they grow through RS_REALLOC as they would in
+ * production. The distribution is the benchmark argument.
+ *
+ * A backend hands out empty strings and takes them back: the malloc backend
+ * initializes and frees them, the pool backend goes through the pool of the
+ * calling thread. Another malloc is measured by linking it through
+ * RS_BENCH_MALLOC.
+ */
+
+// A batch fits in a pool, so the pool backend never frees on release.
+constexpr const std::size_t mt_batch{ RS_POOL_SIZE };
+constexpr const std::size_t mt_piece{ 16 };
+
+inline int mt_max_threads()
+{
+	const unsigned n{ std::thread::hardware_concurrency() };
+
+	return n ? static_cast<int>(n) : 1;
+}
+
+struct malloc_backend {
+	static void acquire(rapidstring *s)
+	{
+		rs_init(s);
+	}
+
+	static void release(rapidstring *s)
+	{
+		rs_free(s);
+	}
+
+	static void finish() {}
+};
+
+struct pool_backend {
+	static void acquire(rapidstring *s)
+	{
+		rs_pool_acquire(rs_pool_local(), s);
+	}
+
+	static void release(rapidstring *s)
+	{
+		rs_pool_release(rs_pool_local(), s);
+	}
+
+	static void finish()
+	{
+		rs_pool_free(rs_pool_local());
+	}
+};
+
+inline void mt_build(rapidstring *s, std::size_t n)
+{
+	const char *source{ dist_source() };
+
+	for (std::size_t len = 0; len < n; len += mt_piece)
+		rs_cat_n(s, source, std::min(mt_piece, n - len));
+}
+
+/*
+ * Every thread builds batches of strings and frees them itself, which is the
+ * best case for allocators with per thread caches.
+ */
+template <typename Backend>
+void mt_churn(benchmark::State& state)
+{
+	const auto& sizes = sizes_of(static_cast<distribution>(state.range(0)));
+	const std::size_t mask{ sizes.size() - 1 };
+	rapidstring strings[mt_batch];
+
+	// Threads start apart in the sizes so they do not run in lock step.
+	std::size_t i{ static_cast<std::size_t>(state.thread_index()) * 997 };
+
+	if (sizes.empty()) {
+		state.SkipWithError("no sizes, set RS_BENCH_TRACE");
+		return;
+	}
+
+	for (auto _ : state) {
+		for (auto& s : strings) {
+			Backend::acquire(&s);
+			mt_build(&s, sizes[i++ & mask]);
+		}
+
+		benchmark::DoNotOptimize(strings);
+
+		for (auto& s : strings)
+			Backend::release(&s);
+	}
+
+	Backend::finish();
+
+	state.SetItemsProcessed(static_cast<std::int64_t>(
+		state.iterations() * mt_batch));
+}
+
+struct mt_queue {
+	std::mutex lock;
+	std::vector<rapidstring> strings;
+};
+
+inline std::vector<mt_queue>& mt_queues()
+{
+	static std::vector<mt_queue> queues(
+		static_cast<std::size_t>(mt_max_threads()));
+
+	return queues;
+}
+
+/*
+ * The threads form a ring, each handing the batches it builds to the next,
+ * which frees them. Every buffer is freed by a thread other than the one that
+ * allocated it, as in a pipeline passing payloads between stages. With one
+ * thread the ring hands batches to itself.
+ */
+template <typename Backend>
+void mt_handoff(benchmark::State& state)
+{
+	const auto& sizes = sizes_of(static_cast<distribution>(state.range(0)));
+	const std::size_t mask{ sizes.size() - 1 };
+	const auto threads = static_cast<std::size_t>(state.threads());
+	const auto index = static_cast<std::size_t>(state.thread_index());
+	mt_queue& out = mt_queues()[(index + 1) % threads];
+	mt_queue& in = mt_queues()[index];
+	rapidstring strings[mt_batch];
+	std::vector<rapidstring> received;
+	std::size_t i{ index * 997 };
+
+	if (sizes.empty()) {
+		state.SkipWithError("no sizes, set RS_BENCH_TRACE");
+		return;
+	}
+
+	for (auto _ : state) {
+		for (auto& s : strings) {
+			Backend::acquire(&s);
+			mt_build(&s, sizes[i++ & mask]);
+		}
+
+		{
+			std::lock_guard<std::mutex> guard{ out.lock };
+			out.strings.insert(out.strings.end(), strings,
+					   strings + mt_batch);
+		}
+
+		{
+			std::lock_guard<std::mutex> guard{ in.lock };
+			received.swap(in.strings);
+		}
+
+		for (auto& s : received)
+			Backend::release(&s);
+
+		received.clear();
+	}
+
+	// Every thread has left the loop, so the rest of the queue is ours.
+	for (auto& s : in.strings)
+		Backend::release(&s);
+
+	in.strings.clear();
+	Backend::finish();
+
+	state.SetItemsProcessed(static_cast<std::int64_t>(
+		state.iterations() * mt_batch));
+}
+
+#endif // !THREADS_HPP_4F6A1D93C2B7E508
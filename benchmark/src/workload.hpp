@@ -0,0 +1,292 @@
+#ifndef WORKLOAD_HPP_3E7B9D1F5A2C8046
+#define WORKLOAD_HPP_3E7B9D1F5A2C8046
+
+#include "distribution.hpp"
+#include "perf.hpp"
+#include "rapidstring.h"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef RS_BENCH_FBSTRING
+#include <folly/FBString.h>
+#endif
+
+/*
+ * Every public operation driven by the size distributions, for each string
+ * implementation. The distribution is the benchmark argument.
+ */
+
+struct rs_impl {
+	using type = rapidstring;
+
+	static type make(const char *input, std::size_t n)
+	{
+		rapidstring s;
+		rs_init_w_n(&s, input, n);
+		return s;
+	}
+
+	static void cpy(type& s, const char *input, std::size_t n)
+	{
+		rs_cpy_n(&s, input, n);
+	}
+
+	static void cat(type& s, const char *input, std::size_t n)
+	{
+		rs_cat_n(&s, input, n);
+	}
+
+	static void resize(type& s, std::size_t n)
+	{
+		rs_resize(&s, n);
+	}
+
+	static void reserve(type& s, std::size_t n)
+	{
+		rs_reserve(&s, n);
+	}
+
+	static std::size_t len(const type& s)
+	{
+		return rs_len(&s);
+	}
+
+	static const char *data(const type& s)
+	{
+		return rs_data_c(&s);
+	}
+
+	static void destroy(type& s)
+	{
+		rs_free(&s);
+	}
+};
+
+template <typename String>
+struct std_like_impl {
+	using type = String;
+
+	static type make(const char *input, std::size_t n)
+	{
+		return type(input, n);
+	}
+
+	static void cpy(type& s, const char *input, std::size_t n)
+	{
+		s.assign(input, n);
+	}
+
+	static void cat(type& s, const char *input, std::size_t n)
+	{
+		s.append(input, n);
+	}
+
+	static void resize(type& s, std::size_t n)
+	{
+		s.resize(n);
+	}
+
+	static void reserve(type& s, std::size_t n)
+	{
+		s.reserve(n);
+	}
+
+	static std::size_t len(const type& s)
+	{
+		return s.size();
+	}
+
+	static const char *data(const type& s)
+	{
+		return s.data();
+	}
+
+	static void destroy(type&) {}
+};
+
+using std_impl = std_like_impl<std::string>;
+
+#ifdef RS_BENCH_FBSTRING
+using fb_impl = std_like_impl<folly::fbstring>;
+#endif
+
+template <typename Impl>
+void dist_construct(benchmark::State& state)
+{
+	const auto& sizes = sizes_of(static_cast<distribution>(state.range(0)));
+	const std::size_t mask{ sizes.size() - 1 };
+	const char *source{ dist_source() };
+	std::size_t i{ 0 };
+	perf_counters perf;
+
+	if (sizes.empty()) {
+		state.SkipWithError("no sizes, set RS_BENCH_TRACE");
+		return;
+	}
+
+	perf.start();
+
+	for (auto _ : state) {
+		auto s = Impl::make(source, sizes[i++ & mask]);
+		benchmark::DoNotOptimize(s);
+		Impl::destroy(s);
+	}
+
+	perf.stop(state);
+}
+
+template <typename Impl>
+void dist_assign(benchmark::State& state)
+{
+	const auto& sizes = sizes_of(static_cast<distribution>(state.range(0)));
+	const std::size_t mask{ sizes.size() - 1 };
+	const char *source{ dist_source() };
+	std::size_t i{ 0 };
+	perf_counters perf;
+
+	if (sizes.empty()) {
+		state.SkipWithError("no sizes, set RS_BENCH_TRACE");
+		return;
+	}
+
+	auto s = Impl::make(source, 0);
+	perf.start();
+
+	for (auto _ : state) {
+		Impl::cpy(s, source, sizes[i++ & mask]);
+		benchmark::DoNotOptimize(s);
+	}
+
+	perf.stop(state);
+	Impl::destroy(s);
+}
+
+template <typename Impl>
+void dist_append(benchmark::State& state)
+{
+	const auto& sizes = sizes_of(static_cast<distribution>(state.range(0)));
+	const std::size_t mask{ sizes.size() - 1 };
+	const char *source{ dist_source() };
+	std::size_t i{ 0 };
+	perf_counters perf;
+
+	if (sizes.empty()) {
+		state.SkipWithError("no sizes, set RS_BENCH_TRACE");
+		return;
+	}
+
+	perf.start();
+
+	// Each string is built from the next four sizes, divided in fragments.
+	for (auto _ : state) {
+		auto s = Impl::make(source, 0);
+
+		for (std::size_t j = 0; j < 4; j++)
+			Impl::cat(s, source, sizes[i++ & mask] / 4);
+
+		benchmark::DoNotOptimize(s);
+		Impl::destroy(s);
+	}
+
+	perf.stop(state);
+}
+
+template <typename Impl>
+void dist_resize(benchmark::State& state)
+{
+	const auto& sizes = sizes_of(static_cast<distribution>(state.range(0)));
+	const std::size_t mask{ sizes.size() - 1 };
+	const char *source{ dist_source() };
+	std::size_t i{ 0 };
+	perf_counters perf;
+
+	if (sizes.empty()) {
+		state.SkipWithError("no sizes, set RS_BENCH_TRACE");
+		return;
+	}
+
+	perf.start();
+
+	for (auto _ : state) {
+		auto s = Impl::make(source, 0);
+		Impl::resize(s, sizes[i++ & mask]);
+		benchmark::DoNotOptimize(s);
+		Impl::destroy(s);
+	}
+
+	perf.stop(state);
+}
+
+template <typename Impl>
+void dist_reserve_append(benchmark::State& state)
+{
+	const auto& sizes = sizes_of(static_cast<distribution>(state.range(0)));
+	const std::size_t mask{ sizes.size() - 1 };
+	const char *source{ dist_source() };
+	std::size_t i{ 0 };
+	perf_counters perf;
+
+	if (sizes.empty()) {
+		state.SkipWithError("no sizes, set RS_BENCH_TRACE");
+		return;
+	}
+
+	perf.start();
+
+	for (auto _ : state) {
+		const std::size_t n{ sizes[i++ & mask] };
+		auto s = Impl::make(source, 0);
+		Impl::reserve(s, n);
+		Impl::cat(s, source, n / 2);
+		Impl::cat(s, source, n - n / 2);
+		benchmark::DoNotOptimize(s);
+		Impl::destroy(s);
+	}
+
+	perf.stop(state);
+}
+
+/*
+ * Reads the data and length of prebuilt strings, which is where mixed stack
+ * and heap sizes cost branch misses.
+ */
+template <typename Impl>
+void dist_access(benchmark::State& state)
+{
+	const auto& sizes = sizes_of(static_cast<distribution>(state.range(0)));
+	const char *source{ dist_source() };
+	std::vector<typename Impl::type> strs;
+	perf_counters perf;
+
+	if (sizes.empty()) {
+		state.SkipWithError("no sizes, set RS_BENCH_TRACE");
+		return;
+	}
+
+	for (const auto n : sizes)
+		strs.push_back(Impl::make(source, n));
+
+	perf.start();
+
+	for (auto _ : state) {
+		std::size_t sum{ 0 };
+
+		for (const auto& s : strs)
+			sum += Impl::len(s) + static_cast<unsigned char>(
+				Impl::data(s)[0]);
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	perf.stop(state);
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() *
+		strs.size()));
+
+	for (auto& s : strs)
+		Impl::destroy(s);
+}
+
+#endif // !WORKLOAD_HPP_3E7B9D1F5A2C8046
@@ -11,27 +11,78 @@
  *       TABLE OF CONTENTS
  *
  * 1. STRUCTURES & MACROS
- * - Declarations:	line 77
+ * - Declarations:	line 134
  *
  * 2. CONSTRUCTION & DESTRUCTION
- * - Declarations:	line 288
- * - Defintions:	line 769
+ * - Declarations:	line 608
+ * - Defintions:	line 5448
  *
  * 3. ASSIGNMENT
- * - Declarations:	line 354
- * - Defintions:	line 815
+ * - Declarations:	line 731
+ * - Defintions:	line 5528
  *
  * 4. CAPACITY
- * - Declarations:	line 449
- * - Defintions:	line 881
+ * - Declarations:	line 891
+ * - Defintions:	line 5634
  *
  * 5. MODIFIERS
- * - Declarations:	line 528
- * - Defintions:	line 950
+ * - Declarations:	line 1056
+ * - Defintions:	line 5762
  *
  * 6. HEAP OPERATIONS
- * - Declarations:	line 695
- * - Defintions:	line 1094
+ * - Declarations:	line 1405
+ * - Defintions:	line 6100
+ *
+ * 7. SERIALIZATION
+ * - Declarations:	line 1547
+ * - Defintions:	line 6226
+ *
+ * 8. STATISTICS
+ * - Declarations:	line 1747
+ * - Defintions:	line 6426
+ *
+ * 9. SEARCH
+ * - Declarations:	line 2061
+ * - Defintions:	line 6627
+ *
+ * 10. MATCHING
+ * - Declarations:	line 2491
+ * - Defintions:	line 7215
+ *
+ * 11. ENCODING
+ * - Declarations:	line 2735
+ * - Defintions:	line 7640
+ *
+ * 12. CONVERSION
+ * - Declarations:	line 3313
+ * - Defintions:	line 8800
+ *
+ * 13. POOLING
+ * - Declarations:	line 3565
+ * - Defintions:	line 9363
+ *
+ * 14. HASH MAP
+ * - Declarations:	line 3724
+ * - Defintions:	line 9449
+ *
+ * 15. RADIX TREE
+ * - Declarations:	line 4093
+ * - Defintions:	line 9854
+ *
+ * 16. COMPRESSION
+ * - Declarations:	line 4593
+ * - Defintions:	line 10531
+ *
+ * 17. FILE LOADING
+ * - Declarations:	line 4819
+ * - Defintions:	line 10830
+ *
+ * 18. STREAMING
+ * - Declarations:	line 5067
+ * - Defintions:	line 11285
+ *
+ * 19. COMPILED KERNELS
+ * - Declarations:	line 5306
  */
 
 /**
@@ -64,6 +115,12 @@
  */
 
 #include <assert.h> /* assert() */
+#include <float.h> /* FLT_EVAL_METHOD */
+#include <locale.h> /* localeconv() */
+#include <stdarg.h> /* va_list */
+#include <stdint.h> /* uintptr_t, uint64_t */
+#include <stdio.h> /* vsnprintf() */
+#include <stdlib.h> /* strtod() */
 #include <string.h> /* memcpy() */
 
 /*
@@ -78,6 +135,17 @@
 #define RS_VERSION_MINOR 1
 #define RS_VERSION_PATCH 0
 
+/*
+ * A generated configuration, such as the one produced by `scripts/config.py`
+ * from an `RS_STATS` recording, may be provided as `RS_CONFIG_FILE`. The
+ * macro must expand to a quoted path, so the quotes are themselves quoted in
+ * a shell, as in `-DRS_CONFIG_FILE='"path/to/config.h"'`. The CMake option
+ * of the same name adds them itself.
+ */
+#ifdef RS_CONFIG_FILE
+  #include RS_CONFIG_FILE
+#endif
+
 #ifndef RS_GROWTH_FACTOR
   #define RS_GROWTH_FACTOR (2)
 #endif
@@ -86,6 +154,38 @@
   #define RS_AVERAGE_SIZE (50)
 #endif
 
+/*
+ * rs_resize() compacts a heap string with rs_compact() once its length falls
+ * below `1 / RS_COMPACT_RATIO` of its capacity. `0` disables the policy.
+ */
+#ifndef RS_COMPACT_RATIO
+  #define RS_COMPACT_RATIO (0)
+#endif
+
+/*
+ * Defining `RS_PADDING` to a power of two, such as 32 or 64, rounds heap
+ * allocations up to a multiple of it, so that at least `RS_PADDING` bytes are
+ * readable from the end of the characters of a heap string. Vector loads of up
+ * to `RS_PADDING` bytes may then start at any character, without a scalar
+ * loop over the last block. The bytes past the null terminator are
+ * unspecified. Buffers given to rs_steal_n() and rs_init_borrow_n() must
+ * provide the padding themselves.
+ *
+ * A stack string is readable over the whole rapidstring, which starts with
+ * its buffer, so a single load of up to `sizeof(rapidstring)` bytes from the
+ * start of its characters covers them.
+ */
+#ifndef RS_PADDING
+  #define RS_PADDING (0)
+#endif
+
+#if RS_PADDING
+  #define RS_ALLOC_SIZE(n) (((n) + 2 * RS_PADDING - 1) &			\
+			    ~((size_t)RS_PADDING - 1))
+#else
+  #define RS_ALLOC_SIZE(n) ((n) + 1)
+#endif
+
 #if !defined(RS_MALLOC) && !defined(RS_REALLOC) && !defined(RS_FREE)
   #include <stdlib.h>
   #define RS_MALLOC malloc
@@ -95,13 +195,59 @@
 
 #define RS_HEAP_FLAG (0xFF)
 
+/*
+ * The flag of a heap string compressed by rs_compress(), which is only
+ * available when `RS_COMPRESSION` is defined.
+ */
+#define RS_COMPRESSED_FLAG (0xFE)
+
+/*
+ * The flag of a string created by rs_init_borrow_n(), whose heap buffer
+ * points to characters it does not own.
+ */
+#define RS_BORROWED_FLAG (0xFD)
+
+#ifdef RS_COMPRESSION
+  #define RS_IS_HEAP_FLAG(flag) ((flag) >= RS_BORROWED_FLAG)
+#else
+  #define RS_IS_HEAP_FLAG(flag) ((flag) == RS_HEAP_FLAG ||		\
+				 (flag) == RS_BORROWED_FLAG)
+#endif
+
+/* Frees the encoding of a compressed string whose characters are replaced. */
+#ifdef RS_COMPRESSION
+  #define RS_DROP_COMPRESSED(s) do {					\
+	if (RS_UNLIKELY((s)->heap.flag == RS_COMPRESSED_FLAG)) {	\
+		RS_STATS_ADD(frees, 1);					\
+		RS_FREE((s)->heap.buffer);				\
+		rs_init(s);						\
+	}								\
+  } while (0)
+#else
+  #define RS_DROP_COMPRESSED(s) ((void)0)
+#endif
+
 #define RS_ASSERT_PTR(ptr) do { assert(ptr != NULL); } while (0)
 #define RS_ASSERT_RS(s) do {					\
 	RS_ASSERT_PTR(s);					\
-	assert(s->heap.flag == RS_HEAP_FLAG ||			\
+	assert(RS_IS_HEAP_FLAG(s->heap.flag) ||			\
 	       s->heap.flag <= RS_STACK_CAPACITY);		\
 } while (0)
-#define RS_ASSERT_HEAP(s) do { assert(rs_is_heap(s)); } while (0)
+/* Checks the flag directly, so compressed strings fail rather than change. */
+#define RS_ASSERT_HEAP(s) do { assert((s)->heap.flag == RS_HEAP_FLAG); } while (0)
+/*
+ * Characters are only read through a `const` string once decompressed. The
+ * length of a compressed string is longer than its encoding, so reading one
+ * aborts even without assertions.
+ */
+#ifdef RS_COMPRESSION
+  #define RS_CHECK_PLAIN(s) do {					\
+	if (RS_UNLIKELY((s)->heap.flag == RS_COMPRESSED_FLAG))		\
+		abort();						\
+  } while (0)
+#else
+  #define RS_CHECK_PLAIN(s) ((void)0)
+#endif
 #define RS_ASSERT_STACK(s) do { assert(rs_is_stack(s)); } while (0)
 
 #ifdef __GNUC__
@@ -119,15 +265,92 @@
   #define RS_EXPECT(expr, val) (expr)
 #endif
 
-#define RS_LIKELY(expr) RS_EXPECT(expr, 1)
-#define RS_UNLIKELY(expr) RS_EXPECT(expr, 0)
+/*
+ * Tells the compiler an invariant the assertions check, which it cannot see
+ * across the union of a string.
+ */
+#if RS_GCC_VERSION >= 40500 || defined(__clang__)
+  #define RS_UNREACHABLE() __builtin_unreachable()
+#elif defined(_MSC_VER)
+  #define RS_UNREACHABLE() __assume(0)
+#else
+  #define RS_UNREACHABLE() ((void)0)
+#endif
 
 #ifdef __STDC_VERSION__
   #define RS_C99 (__STDC_VERSION__ >= 199901L)
   #define RS_C11 (__STDC_VERSION__ >= 201112L)
 #else
   #define RS_C99 (0)
-  #define RC_C11 (0)
+  #define RS_C11 (0)
+#endif
+
+/*
+ * The formatted functions need vsnprintf(), which is only declared from C99
+ * and C++11.
+ */
+#if RS_C99 || (defined(__cplusplus) && __cplusplus >= 201103L) ||	\
+    (defined(_MSC_VER) && _MSC_VER >= 1900)
+  #define RS_PRINTF (1)
+#else
+  #define RS_PRINTF (0)
+#endif
+
+#if RS_C99 || (defined(__cplusplus) && __cplusplus >= 201103L)
+  #define RS_VA_COPY(dst, src) va_copy(dst, src)
+#elif defined(__GNUC__)
+  #define RS_VA_COPY(dst, src) __va_copy(dst, src)
+#else
+  #define RS_VA_COPY(dst, src) ((dst) = (src))
+#endif
+
+#define RS_LIKELY(expr) RS_EXPECT(expr, 1)
+#define RS_UNLIKELY(expr) RS_EXPECT(expr, 0)
+
+/*
+ * Whether double arithmetic rounds to double, which the exact path of
+ * rs_to_double_n() relies on. C89 leaves `FLT_EVAL_METHOD` undefined, where
+ * GCC still predefines its own.
+ */
+#if defined(FLT_EVAL_METHOD)
+  #define RS_DOUBLE_EVAL (FLT_EVAL_METHOD == 0)
+#elif defined(__FLT_EVAL_METHOD__)
+  #define RS_DOUBLE_EVAL (__FLT_EVAL_METHOD__ == 0)
+#else
+  #define RS_DOUBLE_EVAL (0)
+#endif
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+  #define RS_POSIX (1)
+#else
+  #define RS_POSIX (0)
+#endif
+
+#if RS_POSIX
+  #include <errno.h> /* errno */
+  #include <fcntl.h> /* open() */
+  #include <sys/mman.h> /* mmap(), munmap() */
+  #include <sys/stat.h> /* fstat() */
+  #include <unistd.h> /* write(), close() */
+  #include <pthread.h> /* pthread_key_create() */
+
+  /* Descriptors are closed on exec where the platform supports it. */
+  #ifndef O_CLOEXEC
+    #define O_CLOEXEC (0)
+  #endif
+#endif
+
+/*
+ * Loading files through io_uring is opt-in with `RS_IO_URING`, as it needs
+ * Linux headers and syscall(), which is declared with `_DEFAULT_SOURCE` or
+ * `_GNU_SOURCE`.
+ */
+#if RS_POSIX && defined(RS_IO_URING) && defined(__linux__)
+  #define RS_URING (1)
+  #include <linux/io_uring.h> /* struct io_uring_sqe */
+  #include <sys/syscall.h> /* __NR_io_uring_setup */
+#else
+  #define RS_URING (0)
 #endif
 
 /* GCC version 3.1 required for the always inline attribute. */
@@ -143,6 +366,47 @@
   #define RS_API static
 #endif
 
+/*
+ * SIMD kernels are selected at compile time from the instruction sets enabled
+ * for the translation unit. Defining `RS_NO_SIMD` disables them all.
+ */
+#if !defined(RS_NO_SIMD) && defined(__AVX2__)
+  #define RS_AVX2 (1)
+#else
+  #define RS_AVX2 (0)
+#endif
+
+#if !defined(RS_NO_SIMD) && (defined(__SSSE3__) || defined(__AVX__))
+  #define RS_SSSE3 (1)
+#else
+  #define RS_SSSE3 (0)
+#endif
+
+#if !defined(RS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) ||	\
+			     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+  #define RS_SSE2 (1)
+#else
+  #define RS_SSE2 (0)
+#endif
+
+#if RS_SSE2
+  #include <immintrin.h> /* SSE2, SSSE3, AVX2 */
+#endif
+
+#ifdef _MSC_VER
+  #include <intrin.h> /* _BitScanForward() */
+#endif
+
+#if defined(__cplusplus) && __cplusplus >= 201103L
+  #define RS_THREAD_LOCAL thread_local
+#elif RS_C11
+  #define RS_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+  #define RS_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+  #define RS_THREAD_LOCAL __declspec(thread)
+#endif
+
 typedef struct { void *a; size_t b; } rs_align_dummy;
 
 #if RS_C11
@@ -161,6 +425,32 @@ typedef struct { void *a; size_t b; } rs_align_dummy;
 			       sizeof(size_t))
 #endif
 
+/*
+ * With `RS_SIZE_T32`, heap strings store their size and capacity in 32 bits.
+ * On 64-bit platforms every string is then 8 bytes smaller, with 8 fewer
+ * characters on the stack, and heap strings are limited to 4 GiB. Otherwise
+ * the limit is the largest object, allocation padding included. A larger
+ * size aborts, in release builds too, as truncating it would corrupt memory
+ * and no allocation could hold it. The check also bounds the allocation
+ * sizes the compiler sees.
+ */
+#ifdef RS_SIZE_T32
+  typedef uint32_t rs_size;
+#else
+  typedef size_t rs_size;
+#endif
+
+#if defined(RS_SIZE_T32) && PTRDIFF_MAX > 0xFFFFFFFFL
+  #define RS_SIZE_MAX (0xFFFFFFFFUL)
+#else
+  #define RS_SIZE_MAX ((size_t)PTRDIFF_MAX - 2 * RS_PADDING - 1)
+#endif
+
+#define RS_CHECK_SIZE(n) do {					\
+	if (RS_UNLIKELY((n) > RS_SIZE_MAX))			\
+		abort();					\
+} while (0)
+
 /**
  * @brief Struct that stores the heap data.
  *
@@ -184,13 +474,13 @@ typedef struct {
 	 *
 	 * The null terminator is not included.
 	 */
-	size_t size;
+	rs_size size;
 	/**
 	 * @brief Capacity of a heap string.
 	 *
 	 * The null terminator is not included.
 	 */
-	size_t capacity;
+	rs_size capacity;
 	/**
 	 * @brief Alignnment of a heap string.
 	 *
@@ -260,6 +550,21 @@ typedef union {
 	rs_heap heap;
 } rapidstring;
 
+/*
+ * Defining `RS_BRANCHLESS` makes rs_len(), rs_capacity() and rs_data() select
+ * between the stack and heap members with a mask rather than a branch. This
+ * trades a few instructions for the absence of branch misses when stack and
+ * heap strings are mixed unpredictably.
+ *
+ * Both members are always readable since they share the union, therefore
+ * reading the unused one is harmless. A layout holding a pointer to its own
+ * stack buffer, as done by some C++ implementations, is not an option as a
+ * rapidstring must remain valid when copied by value.
+ */
+#ifdef RS_BRANCHLESS
+  #define RS_HEAP_MASK(s) ((uintptr_t)0 - (uintptr_t)rs_is_heap(s))
+#endif
+
 /* Based off the average string size, allow for more efficient branching. */
 enum { RS_HEAP_LIKELY_V = RS_AVERAGE_SIZE > RS_STACK_CAPACITY };
 
@@ -280,12 +585,17 @@ enum { RS_HEAP_LIKELY_V = RS_AVERAGE_SIZE > RS_STACK_CAPACITY };
  *
  * @since 1.0.0
  */
-#define RS_DATA_SIZE(f, s, input) do {					\
-	if (RS_HEAP_LIKELY(rs_is_heap(input)))				\
-		f(s, input->heap.buffer, rs_heap_len(input));		\
+#ifdef RS_BRANCHLESS
+  #define RS_DATA_SIZE(f, s, input) f(s, rs_data_c(input), rs_len(input))
+#else
+  #define RS_DATA_SIZE(f, s, input) do {				\
+	RS_CHECK_PLAIN(input);						\
+	if (RS_HEAP_LIKELY(rs_is_heap(input)))			\
+		f(s, input->heap.buffer, input->heap.size);		\
 	else								\
 		f(s, input->stack.buffer, rs_stack_len(input));		\
-} while (0)
+  } while (0)
+#endif
 
 /*
  * ===============================================================
@@ -359,6 +669,38 @@ RS_API void rs_init_w_cap(rapidstring *s, size_t n);
  */
 RS_API void rs_init_w_rs(rapidstring *s, const rapidstring *input);
 
+/**
+ * @brief Initializes a string borrowing a null terminated character array.
+ *
+ * Identicle to `rs_init_borrow_n(s, input, strlen(input))`.
+ *
+ * @param[out] s A string to initialize.
+ * @param[in] input The characters to borrow.
+ *
+ * @complexity Linear in the length of @input.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_init_borrow(rapidstring *s, const char *input);
+
+/**
+ * @brief Initializes a string borrowing a character array.
+ *
+ * The characters are read in place rather than copied, so they must stay
+ * valid and unchanged for as long as they are borrowed, and must be followed
+ * by a null terminator. The first modification copies them into a buffer
+ * owned by @s. Freeing a borrowed string leaves the characters alone.
+ *
+ * @param[out] s A string to initialize.
+ * @param[in] input The characters to borrow.
+ * @param[in] n The number of characters, excluding the null terminator.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_init_borrow_n(rapidstring *s, const char *input, size_t n);
+
 /**
  * @brief Frees a string.
  *
@@ -501,6 +843,43 @@ RS_API void rs_cpy_n(rapidstring *s, const char *input, size_t n);
  */
 RS_API void rs_cpy_rs(rapidstring *s, const rapidstring *input);
 
+#if RS_PRINTF
+/**
+ * @brief Copies formatted characters to a string.
+ *
+ * Overwrites any existing data. Identicle to rs_cat_printf() on an empty
+ * string.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] format The `printf()` format.
+ * @returns The number of characters written, or a negative value on an
+ * encoding error.
+ *
+ * @complexity Linear in the length of the output.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_cpy_printf(rapidstring *s, const char *format, ...);
+
+/**
+ * @brief Copies formatted characters to a string.
+ *
+ * Overwrites any existing data. Identicle to rs_cat_vprintf() on an empty
+ * string.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] format The `printf()` format.
+ * @param[in] args The arguments of the format.
+ * @returns The number of characters written, or a negative value on an
+ * encoding error.
+ *
+ * @complexity Linear in the length of the output.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_cpy_vprintf(rapidstring *s, const char *format, va_list args);
+#endif
+
 /*
  * ===============================================================
  *
@@ -560,6 +939,8 @@ RS_API size_t rs_len(const rapidstring *s);
 /**
  * @brief Returns the capacity.
  *
+ * A compressed string reports the capacity it has once decompressed.
+ *
  * @param[in] s An initialized string.
  * @returns The string capacity.
  *
@@ -592,9 +973,27 @@ RS_API void rs_reserve(rapidstring *s, size_t n);
  */
 RS_API void rs_shrink_to_fit(rapidstring *s);
 
+/**
+ * @brief Releases the slack of a string.
+ *
+ * A heap string which fits on the stack is moved back onto the stack.
+ * Otherwise the heap capacity shrinks to the size class of the length, as
+ * computed by rs_size_class().
+ *
+ * @param[in,out] s An initialized string.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_compact(rapidstring *s);
+
 /**
  * @brief Checks whether a string is on the heap.
  *
+ * Borrowed and compressed strings are heap strings, as their characters are
+ * not stored in the string itself.
+ *
  * @param[in] s An initialized string.
  * @returns `1` if the string is on the heap, `0` otherwise.
  *
@@ -604,9 +1003,39 @@ RS_API void rs_shrink_to_fit(rapidstring *s);
  */
 RS_API int rs_is_heap(const rapidstring *s);
 
+/**
+ * @brief Checks whether a string owns an uncompressed heap buffer.
+ *
+ * Unlike rs_is_heap(), borrowed and compressed strings are not counted.
+ * Intended for internal use, where such strings are unborrowed or
+ * decompressed first, so a string which does not own a heap buffer is on
+ * the stack.
+ *
+ * @param[in] s An initialized string.
+ * @returns `1` if the string owns a plain heap buffer, `0` otherwise.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_owns_heap(const rapidstring *s);
+
+/**
+ * @brief Checks whether a string borrows its characters.
+ *
+ * @param[in] s An initialized string.
+ * @returns `1` if the string was initialized with rs_init_borrow_n() and not
+ * modified since, `0` otherwise.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_is_borrowed(const rapidstring *s);
+
 /**
  * @brief Checks whether a string is on the stack.
  *
+ * Identical to `!rs_is_heap(s)`.
+ *
  * @param[in] s An initialized string.
  * @returns `1` if the string is on the stack, `0` otherwise.
  *
@@ -627,6 +1056,9 @@ RS_API int rs_is_stack(const rapidstring *s);
 /**
  * @brief Access the buffer.
  *
+ * A borrowed string first copies its characters into a buffer it owns, and
+ * a compressed string is decompressed.
+ *
  * @param[in] s An initialized string.
  * @returns The buffer.
  *
@@ -639,6 +1071,8 @@ RS_API char *rs_data(rapidstring *s);
 /**
  * @brief Access the buffer.
  *
+ * A compressed string must be decompressed first.
+ *
  * @param[in] s An initialized string.
  * @returns The buffer.
  *
@@ -757,6 +1191,73 @@ RS_API void rs_cat_n(rapidstring *s, const char *input, size_t n);
  */
 RS_API void rs_cat_rs(rapidstring *s, const rapidstring *input);
 
+#if RS_PRINTF
+/**
+ * @brief Appends formatted characters to a string.
+ *
+ * Identicle to `rs_cat_vprintf(s, format, args)`.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] format The `printf()` format.
+ * @returns The number of characters appended, or a negative value on an
+ * encoding error.
+ *
+ * @complexity Linear in the length of the output.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_cat_printf(rapidstring *s, const char *format, ...);
+
+/**
+ * @brief Appends formatted characters to a string.
+ *
+ * The output is formatted directly into the remaining capacity of the string.
+ * If it does not fit, the string grows once to the length returned by the
+ * formatter and the output is formatted a second time. No intermediate buffer
+ * is ever used. Only available from C99 and C++11, which declare
+ * `vsnprintf()`.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] format The `printf()` format.
+ * @param[in] args The arguments of the format.
+ * @returns The number of characters appended, or a negative value on an
+ * encoding error. The string is left unmodified on an error.
+ *
+ * @complexity Linear in the length of the output.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_cat_vprintf(rapidstring *s, const char *format, va_list args);
+#endif
+
+/**
+ * @brief Appends uninitialized characters to a string.
+ *
+ * The string grows like it does for #rs_cat_n. This allows writing output
+ * whose length is known beforehand directly into the string.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] n The number of characters to append.
+ * @returns A pointer to the first appended character.
+ *
+ * @complexity Linear in the length of @s if it grows, constant otherwise.
+ *
+ * @since 1.0.0
+ */
+RS_API char *rs_extend(rapidstring *s, size_t n);
+
+/**
+ * @brief Shortens a string, keeping its capacity.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] n The new length, no greater than the length of @s.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_truncate(rapidstring *s, size_t n);
+
 /**
  * @brief Steals a buffer allocated on the heap.
  *
@@ -778,7 +1279,8 @@ RS_API void rs_steal(rapidstring *s, char *buffer);
  * @brief Steals a buffer allocated on the heap.
  *
  * The buffer must either be allocated with `RS_MALLOC`/`RS_REALLOC`, or must
- * be manually freed.
+ * be manually freed. With #RS_PADDING, it must hold `RS_ALLOC_SIZE(cap)`
+ * bytes.
  *
  * @param[in,out] s An initialized string.
  * @param[in] buffer The buffer to steal.
@@ -790,6 +1292,52 @@ RS_API void rs_steal(rapidstring *s, char *buffer);
  */
 RS_API void rs_steal_n(rapidstring *s, char *buffer, size_t cap);
 
+/**
+ * @brief Swaps two strings.
+ *
+ * @param[in,out] a An initialized string.
+ * @param[in,out] b An initialized string.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_swap(rapidstring *a, rapidstring *b);
+
+/**
+ * @brief Moves a string into another.
+ *
+ * Frees @dst, gives it the contents of @src and leaves @src empty. No
+ * characters are copied.
+ *
+ * @param[in,out] dst An initialized string.
+ * @param[in,out] src An initialized string, other than @dst.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_move(rapidstring *dst, rapidstring *src);
+
+/**
+ * @brief Releases the heap buffer of a string to the caller.
+ *
+ * The inverse of rs_steal_n(). A stack string is first moved to the heap. The
+ * buffer is null terminated, must be freed with `RS_FREE` and holds
+ * `RS_ALLOC_SIZE(n)` bytes for a capacity of `n`. A borrowed string releases
+ * a copy. @s is left empty.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[out] len Receives the length of the buffer, or `NULL`.
+ * @returns The buffer.
+ *
+ * @complexity Constant for a heap string, linear in the length of @s
+ * otherwise.
+ *
+ * @since 1.0.0
+ */
+RS_API char *rs_release(rapidstring *s, size_t *len);
+
 /**
  * @brief Resizes a stack string.
  *
@@ -821,6 +1369,9 @@ RS_API void rs_heap_resize(rapidstring *s, size_t n);
 /**
  * @brief Resizes a string.
  *
+ * A heap string stays on the heap, unless the #RS_COMPACT_RATIO policy
+ * compacts it.
+ *
  * @param[in,out] s An initialized string.
  * @param[in] n The new size.
  *
@@ -864,14 +1415,31 @@ RS_API void rs_resize_w(rapidstring *s, size_t n, char c);
 RS_API void rs_heap_init(rapidstring *s, size_t n);
 
 /**
- * @brief Initializes the heap with growth.
+ * @brief Computes the capacity a string of a given size grows to.
  *
+ * The size is multiplied by #RS_GROWTH_FACTOR, but never past the largest
+ * capacity less #RS_STACK_CAPACITY, which leaves room for the characters a
+ * stack string brings to the heap. A size beyond that is returned unchanged.
  * Intended for internal use.
  *
- * Identicle to `rs_heap_init(s, n * RS_GROWTH_FACTOR)`.
+ * @param[in] n The size to grow.
+ * @returns The grown capacity, at least @n.
  *
- * @param[out] s A string to initialize.
- * @param[in] n The heap capacity.
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_grown(size_t n);
+
+/**
+ * @brief Initializes the heap with growth.
+ *
+ * Intended for internal use.
+ *
+ * Identicle to `rs_heap_init(s, rs_grown(n))`.
+ *
+ * @param[out] s A string to initialize.
+ * @param[in] n The heap capacity.
  *
  * @since 1.0.0
  */
@@ -894,7 +1462,7 @@ RS_API void rs_stack_to_heap(rapidstring *s, size_t n);
  *
  * Intended for internal use.
  *
- * Identicle to `rs_stack_to_heap(s, n * RS_GROWTH_FACTOR)`.
+ * Identicle to `rs_stack_to_heap(s, rs_grown(n))`.
  *
  * @param[in,out] s An initialized stack string.
  * @param[in] n The heap capacity.
@@ -929,385 +1497,9958 @@ RS_API void rs_realloc(rapidstring *s, size_t n);
  */
 RS_API void rs_grow_heap(rapidstring *s, size_t n);
 
+/**
+ * @brief Moves a heap string to the stack.
+ *
+ * The length must be no greater than #RS_STACK_CAPACITY. Intended for
+ * internal use.
+ *
+ * @param[in,out] s An initialized heap string.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_heap_to_stack(rapidstring *s);
+
+/**
+ * @brief Computes the size class of a heap capacity.
+ *
+ * Size classes are one less than a power of two, so that the allocation
+ * including the null terminator is a power of two. Intended for internal use.
+ *
+ * @param[in] n The heap capacity.
+ * @returns The smallest size class no smaller than @n.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_size_class(size_t n);
+
+/**
+ * @brief Gives a borrowed or compressed string characters it owns.
+ *
+ * Borrowed characters are copied into an owned buffer, compressed ones are
+ * decompressed. Does nothing to other strings. Every function writing to the
+ * characters, or returning them through a non-`const` string, calls this
+ * first. Intended for internal use.
+ *
+ * @param[in,out] s An initialized string.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_unborrow(rapidstring *s);
+
 /*
  * ===============================================================
  *
- *                   CONSTRUCTION & DESTRUCTION
+ *                          SERIALIZATION
  *
  * ===============================================================
  */
 
-RS_API void rs_init(rapidstring *s)
-{
-	RS_ASSERT_PTR(s);
-
-	s->stack.buffer[0] = '\0';
-	s->stack.left = RS_STACK_CAPACITY;
-}
+#if RS_POSIX
 
-RS_API void rs_init_w(rapidstring *s, const char *input)
-{
-	rs_init_w_n(s, input, strlen(input));
-}
+/**
+ * @brief Size of the staging buffer used by rs_serialize().
+ *
+ * Strings are batched into this buffer so that small strings do not cost a
+ * system call each. Strings larger than the buffer are written directly.
+ *
+ * @since 1.0.0
+ */
+#ifndef RS_TABLE_BUFFER_SIZE
+  #define RS_TABLE_BUFFER_SIZE (64 * 1024)
+#endif
 
-RS_API void rs_init_w_n(rapidstring *s, const char *input, size_t n)
-{
-	rs_init(s);
-	rs_cpy_n(s, input, n);
-}
+/**
+ * @brief Magic number at the start of a serialized table.
+ *
+ * @since 1.0.0
+ */
+#define RS_TABLE_MAGIC ("RSTB")
 
-RS_API void rs_init_w_cap(rapidstring *s, size_t n)
-{
-	rs_heap_init(s, n);
-	rs_heap_resize(s, 0);
-}
+/**
+ * @brief Byte order marker of a serialized table.
+ *
+ * Tables are written in the native byte order. A table written on a machine
+ * with a different byte order is rejected by rs_table_open().
+ *
+ * @since 1.0.0
+ */
+#define RS_TABLE_ENDIAN (0x01020304UL)
 
-RS_API void rs_init_w_rs(rapidstring *s, const rapidstring *input)
-{
-	RS_DATA_SIZE(rs_init_w_n, s, input);
-}
+/**
+ * @brief Header of a serialized table.
+ *
+ * The on-disk layout of a table is this header, followed by `count + 1`
+ * offsets, followed by the string data. String `i` occupies the bytes
+ * `[offsets[i], offsets[i + 1])` of the data, the last of which is always a
+ * null terminator. Storing the terminator allows the strings to be used
+ * directly as C strings once mapped.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief Magic number, always #RS_TABLE_MAGIC.
+	 */
+	char magic[4];
+	/**
+	 * @brief Byte order marker, always #RS_TABLE_ENDIAN.
+	 */
+	uint32_t endian;
+	/**
+	 * @brief Number of strings in the table.
+	 */
+	uint64_t count;
+} rs_table_header;
 
-RS_API void rs_free(rapidstring *s)
-{
-	RS_ASSERT_RS(s);
+/**
+ * @brief A memory mapped table of strings.
+ *
+ * Elements are borrowed views into the mapping. They remain valid until
+ * rs_table_close() is called and must never be modified or freed.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief Start of the mapping.
+	 */
+	void *map;
+	/**
+	 * @brief Size of the mapping.
+	 */
+	size_t map_size;
+	/**
+	 * @brief Number of strings in the table.
+	 */
+	size_t count;
+	/**
+	 * @brief Offsets of the strings, relative to @data.
+	 */
+	const uint64_t *offsets;
+	/**
+	 * @brief String data.
+	 */
+	const char *data;
+} rs_table;
 
-	if (RS_HEAP_LIKELY(rs_is_heap(s)))
-		RS_FREE(s->heap.buffer);
-}
+/**
+ * @brief Serializes an array of strings to a file descriptor.
+ *
+ * The strings are written in the format described by #rs_table_header,
+ * starting at the current offset of @fd. The descriptor is not closed.
+ * Compressed strings must be decompressed first.
+ *
+ * @param[in] fd A file descriptor opened for writing.
+ * @param[in] arr The strings to serialize.
+ * @param[in] n The number of strings in @arr.
+ * @returns `0` on success, `-1` on failure with `errno` set.
+ *
+ * @complexity Linear in the total length of the strings.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_serialize(int fd, const rapidstring *arr, size_t n);
 
-/*
- * ===============================================================
+/**
+ * @brief Opens a serialized table.
  *
- *                           ASSIGNMENT
+ * The file is mapped read-only. No string is copied or allocated: elements
+ * are accessed in place with rs_table_at().
  *
- * ===============================================================
+ * @param[out] t The table to open.
+ * @param[in] path The path of a file written by rs_serialize().
+ * @returns `0` on success, `-1` on failure with `errno` set. `EINVAL` is used
+ * for files which are not valid tables.
+ *
+ * @complexity Linear in the number of strings, as the offsets are validated.
+ *
+ * @since 1.0.0
  */
+RS_API int rs_table_open(rs_table *t, const char *path);
 
-RS_API void rs_stack_cpy(rapidstring *s, const char *input)
-{
-	RS_ASSERT_PTR(input);
+/**
+ * @brief Closes a table.
+ *
+ * All views returned by rs_table_at() become invalid.
+ *
+ * @param[in] t An opened table.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_table_close(rs_table *t);
 
-	rs_stack_cpy_n(s, input, strlen(input));
-}
+/**
+ * @brief Returns the number of strings in a table.
+ *
+ * @param[in] t An opened table.
+ * @returns The number of strings.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_table_count(const rs_table *t);
 
-RS_API void rs_stack_cpy_n(rapidstring *s, const char *input, size_t n)
-{
-	RS_ASSERT_STACK(s);
-	RS_ASSERT_PTR(input);
-	assert(RS_STACK_CAPACITY >= n);
+/**
+ * @brief Accesses a string of a table.
+ *
+ * The index must be smaller than rs_table_count(). If it is not, the
+ * behavior is undefined.
+ *
+ * @param[in] t An opened table.
+ * @param[in] i The index of the string.
+ * @param[out] len The length of the string. May be `NULL`.
+ * @returns A null terminated view of the string, or `NULL` if the string is
+ * not terminated, which only happens in a corrupted file.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API const char *rs_table_at(const rs_table *t, size_t i, size_t *len);
 
-	memcpy(s->stack.buffer, input, n);
-	rs_stack_resize(s, n);
-}
+/**
+ * @brief Writes an entire buffer to a file descriptor.
+ *
+ * Retries on partial writes and interruptions. Intended for internal use.
+ *
+ * @param[in] fd A file descriptor opened for writing.
+ * @param[in] input The buffer to write.
+ * @param[in] n The length of the buffer.
+ * @returns `0` on success, `-1` on failure with `errno` set.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_write_all(int fd, const void *input, size_t n);
 
-RS_API void rs_heap_cpy(rapidstring *s, const char *input)
-{
-	RS_ASSERT_PTR(input);
+/**
+ * @brief Validates the layout of a mapped table.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] t A mapped table.
+ * @returns `1` if the table is valid, `0` otherwise.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_table_valid(rs_table *t);
 
-	rs_heap_cpy_n(s, input, strlen(input));
-}
+#endif /* RS_POSIX */
 
-RS_API void rs_heap_cpy_n(rapidstring *s, const char *input, size_t n)
-{
-	RS_ASSERT_HEAP(s);
-	RS_ASSERT_PTR(input);
-	assert(s->heap.capacity >= n);
+/*
+ * ===============================================================
+ *
+ *                           STATISTICS
+ *
+ * ===============================================================
+ */
 
-	memcpy(s->heap.buffer, input, n);
-	rs_heap_resize(s, n);
-}
+#ifdef RS_STATS
 
-RS_API void rs_cpy(rapidstring *s, const char *input)
-{
-	RS_ASSERT_PTR(input);
+#ifndef RS_THREAD_LOCAL
+  #error "RS_STATS requires thread local storage, which this compiler lacks."
+#endif
 
-	rs_cpy_n(s, input, strlen(input));
-}
+#if !RS_POSIX
+  #error "RS_STATS requires POSIX threads to sum the counters of threads."
+#endif
 
-RS_API void rs_cpy_n(rapidstring *s, const char *input, size_t n) {
-	if (RS_HEAP_LIKELY(rs_is_heap(s))) {
-		rs_grow_heap(s, n);
-		rs_heap_cpy_n(s, input, n);
-	} else if (RS_HEAP_LIKELY(n > RS_STACK_CAPACITY)) {
-		rs_heap_init_g(s, n);
-		rs_heap_cpy_n(s, input, n);
-	} else {
-		rs_stack_cpy_n(s, input, n);
-	}
-}
+/*
+ * Each thread writes only its own counters, but other threads read them for
+ * snapshots, so every access to them outside the owning thread is atomic.
+ * Relaxed ordering suffices, as the counters order nothing else.
+ */
+#if RS_GCC_VERSION >= 40700 || defined(__clang__)
+  #define RS_LOAD_RELAXED(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+  #define RS_STORE_RELAXED(ptr, val)					\
+	__atomic_store_n(ptr, val, __ATOMIC_RELAXED)
+#else
+  #error "RS_STATS requires the __atomic builtins of GCC 4.7 or Clang."
+#endif
 
-RS_API void rs_cpy_rs(rapidstring *s, const rapidstring *input)
-{
-	RS_DATA_SIZE(rs_cpy_n, s, input);
-}
+/**
+ * @brief Number of buckets in the size histogram.
+ *
+ * Bucket zero counts empty strings, bucket `i` counts strings with a length
+ * in `[2^(i - 1), 2^i)`.
+ *
+ * @since 1.0.0
+ */
+#define RS_STATS_BUCKETS (sizeof(size_t) * 8 + 1)
 
-/*
- * ===============================================================
+/**
+ * @brief Allocation and transition counters.
  *
- *                            CAPACITY
+ * Only available when `RS_STATS` is defined. The counters are kept per
+ * thread, therefore recording them requires no locking. A snapshot sums
+ * those of every thread, including the threads which exited. Every counter
+ * is a `size_t`.
  *
- * ===============================================================
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief Number of heap buffers allocated.
+	 */
+	size_t allocs;
+	/**
+	 * @brief Number of heap buffers reallocated.
+	 */
+	size_t reallocs;
+	/**
+	 * @brief Number of heap buffers freed.
+	 */
+	size_t frees;
+	/**
+	 * @brief Number of reallocations caused by growth.
+	 */
+	size_t grows;
+	/**
+	 * @brief Number of strings moved from the stack to the heap.
+	 */
+	size_t stack_to_heap;
+	/**
+	 * @brief Number of bytes copied by transitions and reallocations.
+	 *
+	 * Reallocations are counted as copying the entire string, as there is
+	 * no way of knowing whether the allocator moved the buffer.
+	 */
+	size_t bytes_copied;
+	/**
+	 * @brief Number of calls to rs_cat_n().
+	 */
+	size_t cats;
+	/**
+	 * @brief Number of calls to rs_cat_n() on a heap string.
+	 */
+	size_t cat_heap;
+	/**
+	 * @brief Number of calls to rs_cat_n() moving a stack string to the
+	 * heap.
+	 */
+	size_t cat_spills;
+	/**
+	 * @brief Number of calls to rs_cpy_n().
+	 */
+	size_t cpys;
+	/**
+	 * @brief Number of calls to rs_cpy_n() on a heap string.
+	 */
+	size_t cpy_heap;
+	/**
+	 * @brief Number of calls to rs_cpy_n() moving a stack string to the
+	 * heap.
+	 */
+	size_t cpy_spills;
+	/**
+	 * @brief Histogram of the final lengths of strings.
+	 *
+	 * Recorded when a string is freed. See #RS_STATS_BUCKETS.
+	 */
+	size_t sizes[RS_STATS_BUCKETS];
+} rs_stats;
+
+/**
+ * @brief The counters of a thread.
+ *
+ * Linked into the list of every thread which recorded on its first
+ * recording, and unlinked when the thread exits. Intended for internal use.
+ *
+ * @since 1.0.0
+ */
+typedef struct rs_stats_block {
+	/**
+	 * @brief The counters, only written by the thread.
+	 */
+	rs_stats stats;
+	/**
+	 * @brief The counters at the last reset, guarded by `rs_stats_lock`.
+	 */
+	rs_stats base;
+	/**
+	 * @brief The next block of the list.
+	 */
+	struct rs_stats_block *next;
+	/**
+	 * @brief Whether the block is in the list.
+	 */
+	int linked;
+} rs_stats_block;
+
+/**
+ * @brief The counters of every thread.
+ *
+ * Guarded by `rs_stats_lock`. Intended for internal use.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief Unlinks the block of an exiting thread.
+	 */
+	pthread_key_t key;
+	/**
+	 * @brief Whether @key was created.
+	 */
+	int keyed;
+	/**
+	 * @brief The blocks of the live threads.
+	 */
+	rs_stats_block *head;
+	/**
+	 * @brief The counters of the threads which exited.
+	 */
+	rs_stats retired;
+} rs_stats_registry;
+
+/*
+ * The counters of all translation units are shared, so that no recording is
+ * left out of a snapshot. `RS_STATS_DEFINE` must be placed in exactly one
+ * translation unit, and linking fails without it.
+ */
+extern RS_THREAD_LOCAL rs_stats_block rs_stats_tls;
+extern rs_stats_registry rs_stats_all;
+extern pthread_mutex_t rs_stats_lock;
+
+#define RS_STATS_DEFINE							\
+	RS_THREAD_LOCAL rs_stats_block rs_stats_tls;			\
+	rs_stats_registry rs_stats_all;					\
+	pthread_mutex_t rs_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#define RS_STATS_ADD(field, n) rs_stats_add(&rs_stats_local()->field, (n))
+#define RS_STATS_SIZE(n)						\
+	rs_stats_add(&rs_stats_local()->sizes[rs_stats_bucket(n)], 1)
+
+/**
+ * @brief Sums the counters of every thread since the last reset.
+ *
+ * Counts which other threads record while the snapshot is taken may or may
+ * not be included.
+ *
+ * @param[out] stats The counters.
+ *
+ * @complexity Linear in the number of live threads which recorded.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_stats_snapshot(rs_stats *stats);
+
+/**
+ * @brief Resets the counters of every thread.
+ *
+ * The counters of other threads are not written. Instead, their current
+ * values are recorded, and later snapshots only count what was added since.
+ *
+ * @complexity Linear in the number of live threads which recorded.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_stats_reset(void);
+
+/**
+ * @brief Adds counters to other counters.
+ *
+ * @param[in,out] stats The counters to add to.
+ * @param[in] input The counters to add.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_stats_merge(rs_stats *stats, const rs_stats *input);
+
+/**
+ * @brief Writes counters as a recording.
+ *
+ * The recording is a list of `name value` lines, with one
+ * `size bucket count` line per histogram bucket. It is the input of
+ * `scripts/config.py`, which turns it into a configuration header providing
+ * #RS_AVERAGE_SIZE and #RS_GROWTH_FACTOR. The header is used through
+ * `RS_CONFIG_FILE` in a second build.
+ *
+ * @param[in] f The file to write to.
+ * @param[in] stats The counters to write.
+ * @returns `0` on success, a negative value on failure.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_stats_dump(FILE *f, const rs_stats *stats);
+
+/**
+ * @brief Returns the histogram bucket of a length.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] n The length.
+ * @returns The bucket.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_stats_bucket(size_t n);
+
+/**
+ * @brief Adds to a counter of the calling thread.
+ *
+ * Intended for internal use.
+ *
+ * @param[in,out] counter The counter.
+ * @param[in] n The amount to add.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_stats_add(size_t *counter, size_t n);
+
+/**
+ * @brief Adds the counters a thread recorded since the last reset.
+ *
+ * Must be called with `rs_stats_lock` held. Intended for internal use.
+ *
+ * @param[in,out] stats The counters to add to.
+ * @param[in] block The counters of the thread.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_stats_since(rs_stats *stats, const rs_stats_block *block);
+
+/**
+ * @brief Returns the counters of the calling thread.
+ *
+ * Links them into the list of every thread on first use. Intended for
+ * internal use.
+ *
+ * @returns The counters.
+ *
+ * @since 1.0.0
+ */
+RS_API rs_stats *rs_stats_local(void);
+
+/**
+ * @brief Links the counters of the calling thread into the list.
+ *
+ * Intended for internal use.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_stats_link(void);
+
+/**
+ * @brief Moves the counters of an exiting thread out of the list.
+ *
+ * Intended for internal use.
+ *
+ * @param[in,out] block The counters of the thread.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_stats_unlink(void *block);
+
+#else
+  #define RS_STATS_ADD(field, n) ((void)0)
+  #define RS_STATS_SIZE(n) ((void)0)
+#endif /* RS_STATS */
+
+/*
+ * ===============================================================
+ *
+ *                             SEARCH
+ *
+ * ===============================================================
+ */
+
+/**
+ * @brief Value returned by searches which found nothing.
+ *
+ * @since 1.0.0
+ */
+#define RS_NPOS ((size_t)-1)
+
+/**
+ * @brief The number of ranges of members tested without byte shuffles.
+ *
+ * @since 1.0.0
+ */
+#define RS_CHARSET_RANGES (8)
+
+/**
+ * @brief A precompiled set of characters.
+ *
+ * Besides a bitmap of its members, a set holds two 16 entry tables indexed by
+ * the low and high nibble of a character. Each distinct high nibble of the
+ * members is given a bucket bit, and a character is a member when the entries
+ * of both its nibbles share a bit. This allows testing 16 or 32 characters at
+ * once with two byte shuffles. With more than eight distinct high nibbles the
+ * buckets are shared, and candidates are confirmed with the bitmap.
+ *
+ * Processors without byte shuffles instead test each range of consecutive
+ * members with a subtraction, as long as there are no more than
+ * #RS_CHARSET_RANGES of them.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief Table indexed by the low nibble of a character.
+	 */
+	unsigned char lo[16];
+	/**
+	 * @brief Table indexed by the high nibble of a character.
+	 */
+	unsigned char hi[16];
+	/**
+	 * @brief Membership bitmap of every character.
+	 */
+	unsigned char bitmap[32];
+	/**
+	 * @brief The first member and the length minus one of each range.
+	 */
+	unsigned char ranges[RS_CHARSET_RANGES][2];
+	/**
+	 * @brief The number of ranges, if they all fit.
+	 */
+	int range_count;
+	/**
+	 * @brief Whether the nibble tables have no false positives.
+	 */
+	int nibble_exact;
+	/**
+	 * @brief Whether the ranges hold every member.
+	 */
+	int ranges_exact;
+} rs_charset;
+
+/*
+ * Whether the vector tests of this translation unit have no false positives.
+ * A set may be searched by code compiled for other instruction sets than the
+ * code which initialized it, so it records both tests and each kernel checks
+ * the one it uses.
+ */
+#define RS_CHARSET_EXACT(set)						\
+	(RS_SSSE3 ? (set)->nibble_exact : (set)->ranges_exact)
+
+/**
+ * @brief Initializes a character set.
+ *
+ * Identicle to `rs_charset_init_n(set, chars, strlen(chars))`.
+ *
+ * @param[out] set The set to initialize.
+ * @param[in] chars The members of the set.
+ *
+ * @complexity Linear in the length of @chars.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_charset_init(rs_charset *set, const char *chars);
+
+/**
+ * @brief Initializes a character set.
+ *
+ * @param[out] set The set to initialize.
+ * @param[in] chars The members of the set, which may include `'\0'`.
+ * @param[in] n The number of members.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_charset_init_n(rs_charset *set, const char *chars, size_t n);
+
+/**
+ * @brief Checks whether a character is a member of a set.
+ *
+ * @param[in] set An initialized set.
+ * @param[in] c The character.
+ * @returns `1` if @c is a member, `0` otherwise.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_charset_has(const rs_charset *set, char c);
+
+/**
+ * @brief Finds the first character of a string in a set.
+ *
+ * @param[in] s An initialized string.
+ * @param[in] set An initialized set.
+ * @returns The position of the character, or #RS_NPOS.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_find_first_of(const rapidstring *s, const rs_charset *set);
+
+/**
+ * @brief Finds the first character of an array in a set.
+ *
+ * @param[in] input The characters to search.
+ * @param[in] n The number of characters.
+ * @param[in] set An initialized set.
+ * @returns The position of the character, or #RS_NPOS.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_find_first_of_n(const char *input, size_t n,
+				 const rs_charset *set);
+
+/**
+ * @brief Finds the last character of a string in a set.
+ *
+ * @param[in] s An initialized string.
+ * @param[in] set An initialized set.
+ * @returns The position of the character, or #RS_NPOS.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_find_last_of(const rapidstring *s, const rs_charset *set);
+
+/**
+ * @brief Finds the last character of an array in a set.
+ *
+ * @param[in] input The characters to search.
+ * @param[in] n The number of characters.
+ * @param[in] set An initialized set.
+ * @returns The position of the character, or #RS_NPOS.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_find_last_of_n(const char *input, size_t n,
+				const rs_charset *set);
+
+/**
+ * @brief Returns the length of the prefix of a string made of members of a
+ * set.
+ *
+ * @param[in] s An initialized string.
+ * @param[in] set An initialized set.
+ * @returns The length of the prefix.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_span(const rapidstring *s, const rs_charset *set);
+
+/**
+ * @brief Returns the length of the prefix of an array made of members of a
+ * set.
+ *
+ * @param[in] input The characters to search.
+ * @param[in] n The number of characters.
+ * @param[in] set An initialized set.
+ * @returns The length of the prefix.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_span_n(const char *input, size_t n, const rs_charset *set);
+
+/**
+ * @brief Returns the length of the prefix of a string made of characters
+ * which are not members of a set.
+ *
+ * @param[in] s An initialized string.
+ * @param[in] set An initialized set.
+ * @returns The length of the prefix.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_cspn(const rapidstring *s, const rs_charset *set);
+
+/**
+ * @brief Returns the length of the prefix of an array made of characters
+ * which are not members of a set.
+ *
+ * @param[in] input The characters to search.
+ * @param[in] n The number of characters.
+ * @param[in] set An initialized set.
+ * @returns The length of the prefix.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_cspn_n(const char *input, size_t n, const rs_charset *set);
+
+/**
+ * @brief Returns the number of trailing zero bits.
+ *
+ * The input must not be zero. Intended for internal use.
+ *
+ * @param[in] n The input.
+ * @returns The number of trailing zero bits.
+ *
+ * @since 1.0.0
+ */
+RS_API unsigned rs_ctz(uint32_t n);
+
+/**
+ * @brief Returns the number of leading zero bits.
+ *
+ * The input must not be zero. Intended for internal use.
+ *
+ * @param[in] n The input.
+ * @returns The number of leading zero bits.
+ *
+ * @since 1.0.0
+ */
+RS_API unsigned rs_clz(uint32_t n);
+
+/**
+ * @brief Returns the number of set bits.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] n The input.
+ * @returns The number of set bits.
+ *
+ * @since 1.0.0
+ */
+RS_API unsigned rs_popcount(uint32_t n);
+
+#if RS_SSE2
+/**
+ * @brief Returns the candidate members of 16 characters.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] set An initialized set.
+ * @param[in] input 16 characters.
+ * @returns A mask with bit `i` set if `input[i]` may be a member.
+ *
+ * @since 1.0.0
+ */
+RS_API uint32_t rs_charset_mask16(const rs_charset *set, const char *input);
+#endif
+
+#if RS_AVX2
+/**
+ * @brief Returns the candidate members of 32 characters.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] set An initialized set.
+ * @param[in] input 32 characters.
+ * @returns A mask with bit `i` set if `input[i]` may be a member.
+ *
+ * @since 1.0.0
+ */
+RS_API uint32_t rs_charset_mask32(const rs_charset *set, const char *input);
+#endif
+
+/**
+ * @brief Returns the members of the next block of characters.
+ *
+ * The block is as wide as the widest available vector, or what is left of
+ * the input if that is shorter. Intended for internal use.
+ *
+ * @param[in] set An initialized set.
+ * @param[in] input The characters to search.
+ * @param[in] n The number of characters left, which must not be zero.
+ * @param[out] width The number of characters in the block, up to `32`.
+ * @returns A mask with bit `i` set if `input[i]` is a member.
+ *
+ * @since 1.0.0
+ */
+RS_API uint32_t rs_charset_block(const rs_charset *set, const char *input,
+				 size_t n, size_t *width);
+
+/**
+ * @brief Counts the occurrences of a character.
+ *
+ * Identicle to `rs_count_n(rs_data_c(s), rs_len(s), c)`.
+ *
+ * @param[in] s An initialized string.
+ * @param[in] c The character to count.
+ * @returns The number of occurrences of @c.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_count(const rapidstring *s, char c);
+
+/**
+ * @brief Counts the occurrences of a character.
+ *
+ * @param[in] input The characters to search.
+ * @param[in] n The number of characters.
+ * @param[in] c The character to count.
+ * @returns The number of occurrences of @c.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_count_n(const char *input, size_t n, char c);
+
+/**
+ * @brief Counts the characters belonging to a set.
+ *
+ * Identicle to `rs_count_any_n(rs_data_c(s), rs_len(s), set)`.
+ *
+ * @param[in] s An initialized string.
+ * @param[in] set An initialized set.
+ * @returns The number of characters of @s in @set.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_count_any(const rapidstring *s, const rs_charset *set);
+
+/**
+ * @brief Counts the characters belonging to a set.
+ *
+ * @param[in] input The characters to search.
+ * @param[in] n The number of characters.
+ * @param[in] set An initialized set.
+ * @returns The number of characters of @input in @set.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_count_any_n(const char *input, size_t n,
+			     const rs_charset *set);
+
+/**
+ * @brief Indexes the newlines of a string.
+ *
+ * Identicle to `rs_line_index_n(rs_data_c(s), rs_len(s), offsets, max)`.
+ *
+ * @param[in] s An initialized string.
+ * @param[out] offsets The positions of the newlines.
+ * @param[in] max The number of positions @offsets can hold.
+ * @returns The number of newlines.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_line_index(const rapidstring *s, size_t *offsets,
+			    size_t max);
+
+/**
+ * @brief Indexes the newlines of a character array.
+ *
+ * The positions of the first @max newlines are written in increasing order,
+ * so line `i + 1` starts right after `offsets[i]`. All newlines are counted
+ * regardless, and an index which does not fit may be retried with the
+ * returned count as @max.
+ *
+ * @param[in] input The characters to search.
+ * @param[in] n The number of characters.
+ * @param[out] offsets The positions of the newlines.
+ * @param[in] max The number of positions @offsets can hold.
+ * @returns The number of newlines.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_line_index_n(const char *input, size_t n, size_t *offsets,
+			      size_t max);
+
+/**
+ * @brief Writes the positions of the set bits of a mask.
+ *
+ * Only the positions which fit below @max are written. Intended for internal
+ * use.
+ *
+ * @param[in] mask The mask of a block of characters.
+ * @param[in] base The position of the block.
+ * @param[out] offsets The positions.
+ * @param[in] count The number of positions found so far.
+ * @param[in] max The number of positions @offsets can hold.
+ * @returns The number of positions found including those of @mask.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_mask_offsets(uint32_t mask, size_t base, size_t *offsets,
+			      size_t count, size_t max);
+
+/*
+ * ===============================================================
+ *
+ *                            MATCHING
+ *
+ * ===============================================================
+ */
+
+#ifndef RS_MATCHER_BUFFER_SIZE
+  /**
+   * @brief The number of matches a replacement keeps before allocating.
+   *
+   * @since 1.0.0
+   */
+  #define RS_MATCHER_BUFFER_SIZE (32)
+#endif
+
+/**
+ * @brief A compiled set of patterns.
+ *
+ * The patterns form an Aho-Corasick automaton whose failure links are
+ * resolved ahead of time, so every input character costs a single table
+ * lookup. Characters which appear in no pattern share one column of the
+ * table, keeping the rows short.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief The column of every character.
+	 */
+	unsigned char classes[256];
+	/**
+	 * @brief The number of columns.
+	 */
+	size_t class_count;
+	/**
+	 * @brief The number of states, the first being the root.
+	 */
+	size_t state_count;
+	/**
+	 * @brief The transitions, one row of columns per state.
+	 *
+	 * A transition is the position of the row of the next state, which is
+	 * its number times #class_count. The other per state arrays follow in
+	 * the same allocation.
+	 */
+	uint32_t *next;
+	/**
+	 * @brief The position of the row of the first state ending a pattern.
+	 *
+	 * The states ending a pattern are numbered last.
+	 */
+	size_t match_start;
+	/**
+	 * @brief The state of the longest pattern ending at a state, or `0`.
+	 */
+	uint32_t *emit;
+	/**
+	 * @brief The state of the next shorter pattern ending at a pattern's
+	 * state, or `0`.
+	 */
+	uint32_t *dict;
+	/**
+	 * @brief The length of the prefix matched by a state.
+	 */
+	uint32_t *depth;
+	/**
+	 * @brief The index of the pattern ending at a pattern's state.
+	 */
+	uint32_t *pattern;
+	/**
+	 * @brief The first characters of the patterns.
+	 */
+	rs_charset first;
+	/**
+	 * @brief Whether the input between matches is skipped with @first.
+	 */
+	int prefilter;
+} rs_matcher;
+
+/**
+ * @brief Called for every match found by #rs_matcher_find_all.
+ *
+ * The arguments are the user data, the index of the pattern, and the
+ * positions of the first character of the match and the character after the
+ * match. A nonzero return stops the search.
+ *
+ * @since 1.0.0
+ */
+typedef int (*rs_match_fn)(void *data, size_t pattern, size_t begin,
+			   size_t end);
+
+/**
+ * @brief Compiles a set of patterns.
+ *
+ * Empty patterns never match. Duplicate patterns are reported as the first
+ * of them. Aborts if the transitions of the patterns do not fit 32 bit
+ * state ids.
+ *
+ * @param[out] m The matcher to initialize.
+ * @param[in] patterns An array of initialized strings.
+ * @param[in] n The number of patterns.
+ *
+ * @complexity Linear in the total length of the patterns times the number
+ * of distinct characters in them.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_matcher_init(rs_matcher *m, const rapidstring *patterns,
+			    size_t n);
+
+/**
+ * @brief Frees a matcher.
+ *
+ * @param[in] m The matcher to free.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_matcher_free(rs_matcher *m);
+
+/**
+ * @brief Finds the leftmost longest match of a string.
+ *
+ * Identicle to `rs_matcher_find_n(m, rs_data_c(s), rs_len(s), ...)`.
+ *
+ * @param[in] m An initialized matcher.
+ * @param[in] s An initialized string.
+ * @param[in] pos The position to start searching at.
+ * @param[out] begin The position of the first character of the match.
+ * @param[out] end The position of the character after the match.
+ * @param[out] pattern The index of the matched pattern.
+ * @returns `1` if a match was found, `0` otherwise.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_matcher_find(const rs_matcher *m, const rapidstring *s,
+			   size_t pos, size_t *begin, size_t *end,
+			   size_t *pattern);
+
+/**
+ * @brief Finds the leftmost longest match of an array.
+ *
+ * Of the matches starting at or after @pos, the one starting first is
+ * found, and of those the longest. Searching again from the end of a match
+ * finds every non-overlapping match.
+ *
+ * @param[in] m An initialized matcher.
+ * @param[in] input The characters to search.
+ * @param[in] n The number of characters.
+ * @param[in] pos The position to start searching at.
+ * @param[out] begin The position of the first character of the match.
+ * @param[out] end The position of the character after the match.
+ * @param[out] pattern The index of the matched pattern.
+ * @returns `1` if a match was found, `0` otherwise.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_matcher_find_n(const rs_matcher *m, const char *input,
+			     size_t n, size_t pos, size_t *begin, size_t *end,
+			     size_t *pattern);
+
+/**
+ * @brief Reports every match of a string.
+ *
+ * Identicle to `rs_matcher_find_all_n(m, rs_data_c(s), rs_len(s), ...)`.
+ *
+ * @param[in] m An initialized matcher.
+ * @param[in] s An initialized string.
+ * @param[in] fn The function called for every match.
+ * @param[in] data The user data passed to @fn.
+ * @returns The number of matches reported.
+ *
+ * @complexity Linear in the length of @s plus the number of matches.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_matcher_find_all(const rs_matcher *m, const rapidstring *s,
+				  rs_match_fn fn, void *data);
+
+/**
+ * @brief Reports every match of an array.
+ *
+ * Matches may overlap. They are reported in order of their end, and the
+ * longest first for matches with the same end.
+ *
+ * @param[in] m An initialized matcher.
+ * @param[in] input The characters to search.
+ * @param[in] n The number of characters.
+ * @param[in] fn The function called for every match.
+ * @param[in] data The user data passed to @fn.
+ * @returns The number of matches reported.
+ *
+ * @complexity Linear in @n plus the number of matches.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_matcher_find_all_n(const rs_matcher *m, const char *input,
+				    size_t n, rs_match_fn fn, void *data);
+
+/**
+ * @brief Copies a string with its matches replaced.
+ *
+ * Identicle to
+ * `rs_matcher_replace_all_n(m, dst, rs_data_c(s), rs_len(s), repls)`.
+ *
+ * @param[in] m An initialized matcher.
+ * @param[out] dst An initialized string, which must not be @s.
+ * @param[in] s An initialized string.
+ * @param[in] repls An initialized string for every pattern.
+ *
+ * @complexity Linear in the length of @s plus the length of the result.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_matcher_replace_all(const rs_matcher *m, rapidstring *dst,
+				   const rapidstring *s,
+				   const rapidstring *repls);
+
+/**
+ * @brief Copies an array with its matches replaced.
+ *
+ * Every leftmost longest non-overlapping match, as found by
+ * #rs_matcher_find_n, is replaced by the string of its pattern. The result
+ * is sized before it is written, so @dst is allocated at most once.
+ *
+ * @param[in] m An initialized matcher.
+ * @param[out] dst An initialized string, which must not overlap @input.
+ * @param[in] input The characters to search.
+ * @param[in] n The number of characters.
+ * @param[in] repls An initialized string for every pattern.
+ *
+ * @complexity Linear in @n plus the length of the result.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_matcher_replace_all_n(const rs_matcher *m, rapidstring *dst,
+				     const char *input, size_t n,
+				     const rapidstring *repls);
+
+/*
+ * ===============================================================
+ *
+ *                            ENCODING
+ *
+ * ===============================================================
+ */
+
+/**
+ * @brief Appends an array escaped for a JSON string.
+ *
+ * Identicle to `rs_cat_json_escaped_n(s, input, strlen(input))`.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to escape.
+ *
+ * @complexity Linear in the length of @input.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_json_escaped(rapidstring *s, const char *input);
+
+/**
+ * @brief Appends an array escaped for a JSON string.
+ *
+ * Quotes, backslashes and control characters are escaped. Every other
+ * character, including UTF-8 sequences, is copied unmodified. The string
+ * grows at most once.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to escape.
+ * @param[in] n The number of characters to escape.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_json_escaped_n(rapidstring *s, const char *input, size_t n);
+
+/**
+ * @brief Appends a JSON string with its escapes decoded.
+ *
+ * Identicle to `rs_cat_json_unescaped_n(s, input, strlen(input))`.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to decode.
+ * @returns `0` on success, `-1` on an invalid escape.
+ *
+ * @complexity Linear in the length of @input.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_cat_json_unescaped(rapidstring *s, const char *input);
+
+/**
+ * @brief Appends a JSON string with its escapes decoded.
+ *
+ * The input excludes the surrounding quotes. Unicode escapes are decoded to
+ * UTF-8, and surrogate pairs are combined.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to decode.
+ * @param[in] n The number of characters to decode.
+ * @returns `0` on success, `-1` on an invalid escape. The length of the
+ * string is left unmodified on an error.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_cat_json_unescaped_n(rapidstring *s, const char *input,
+				   size_t n);
+
+/**
+ * @brief Appends an array percent-encoded for a URL.
+ *
+ * Identicle to `rs_cat_url_encoded_n(s, input, strlen(input))`.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to encode.
+ *
+ * @complexity Linear in the length of @input.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_url_encoded(rapidstring *s, const char *input);
+
+/**
+ * @brief Appends an array percent-encoded for a URL.
+ *
+ * Every character but the unreserved characters of RFC 3986, which are
+ * letters, digits, `-`, `.`, `_` and `~`, is encoded. The string grows at
+ * most once.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to encode.
+ * @param[in] n The number of characters to encode.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_url_encoded_n(rapidstring *s, const char *input, size_t n);
+
+/**
+ * @brief Appends a percent-encoded array decoded.
+ *
+ * Identicle to `rs_cat_url_decoded_n(s, input, strlen(input))`.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to decode.
+ * @returns `0` on success, `-1` on an invalid encoding.
+ *
+ * @complexity Linear in the length of @input.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_cat_url_decoded(rapidstring *s, const char *input);
+
+/**
+ * @brief Appends a percent-encoded array decoded.
+ *
+ * A `+` is left as is, as it only means a space in form encoded queries.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to decode.
+ * @param[in] n The number of characters to decode.
+ * @returns `0` on success, `-1` on an invalid encoding. The length of the
+ * string is left unmodified on an error.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_cat_url_decoded_n(rapidstring *s, const char *input, size_t n);
+
+/**
+ * @brief Appends an array escaped for HTML.
+ *
+ * Identicle to `rs_cat_html_escaped_n(s, input, strlen(input))`.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to escape.
+ *
+ * @complexity Linear in the length of @input.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_html_escaped(rapidstring *s, const char *input);
+
+/**
+ * @brief Appends an array escaped for HTML.
+ *
+ * The characters `&`, `<`, `>`, `"` and `'` are replaced by references,
+ * which is safe for both text and quoted attribute values. The string grows
+ * at most once.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to escape.
+ * @param[in] n The number of characters to escape.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_html_escaped_n(rapidstring *s, const char *input, size_t n);
+
+/**
+ * @brief Appends an HTML escaped array with its references decoded.
+ *
+ * Identicle to `rs_cat_html_unescaped_n(s, input, strlen(input))`.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to decode.
+ *
+ * @complexity Linear in the length of @input.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_html_unescaped(rapidstring *s, const char *input);
+
+/**
+ * @brief Appends an HTML escaped array with its references decoded.
+ *
+ * The references `&amp;`, `&lt;`, `&gt;`, `&quot;` and `&apos;` and numeric
+ * references are decoded, the latter to UTF-8. Any other `&` is copied
+ * unmodified.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The input to decode.
+ * @param[in] n The number of characters to decode.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_html_unescaped_n(rapidstring *s, const char *input,
+				    size_t n);
+
+/**
+ * @brief The standard base64 alphabet, padded with `=`.
+ *
+ * @since 1.0.0
+ */
+#define RS_BASE64_STANDARD (0)
+
+/**
+ * @brief The URL and filename safe base64 alphabet, without padding.
+ *
+ * @since 1.0.0
+ */
+#define RS_BASE64_URL (1)
+
+/**
+ * @brief Appends the base64 encoding of an array.
+ *
+ * The string grows at most once.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The bytes to encode.
+ * @param[in] n The number of bytes.
+ * @param[in] alphabet Either #RS_BASE64_STANDARD or #RS_BASE64_URL.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_base64(rapidstring *s, const void *input, size_t n,
+			  int alphabet);
+
+/**
+ * @brief Appends the bytes of a base64 encoding.
+ *
+ * Both alphabets are accepted, with or without padding.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The characters to decode.
+ * @param[in] n The number of characters.
+ * @returns `0` on success, `-1` on an invalid encoding. The length of the
+ * string is left unmodified on an error.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_decode_base64(rapidstring *s, const char *input, size_t n);
+
+/**
+ * @brief Appends the lowercase hexadecimal encoding of an array.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The bytes to encode.
+ * @param[in] n The number of bytes.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_hex(rapidstring *s, const void *input, size_t n);
+
+/**
+ * @brief Appends the bytes of a hexadecimal encoding.
+ *
+ * Digits of either case are accepted.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] input The characters to decode.
+ * @param[in] n The number of characters, which must be even.
+ * @returns `0` on success, `-1` on an invalid encoding. The length of the
+ * string is left unmodified on an error.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_decode_hex(rapidstring *s, const char *input, size_t n);
+
+/**
+ * @brief Returns the value of a hexadecimal digit.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] c The digit, in either case.
+ * @returns The value of the digit, or `-1` if @c is not a digit.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_hex_value(char c);
+
+/**
+ * @brief Parses a fixed number of hexadecimal digits.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] input The digits.
+ * @param[in] end The end of the input, which may hold more than @n digits.
+ * @param[in] n The number of digits, no more than `8`.
+ * @param[out] value The parsed value.
+ * @returns `0` on success, `-1` if the input is too short or has an invalid
+ * digit.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_hex_n(const char *input, const char *end, size_t n,
+		    uint32_t *value);
+
+/**
+ * @brief Writes a code point as UTF-8.
+ *
+ * Intended for internal use.
+ *
+ * @param[out] output At least four characters.
+ * @param[in] cp A code point no greater than `0x10FFFF`.
+ * @returns The number of characters written.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_utf8_encode(char *output, uint32_t cp);
+
+/**
+ * @brief Returns the reference escaping a character in HTML.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] c One of `&`, `<`, `>`, `"` and `'`.
+ * @returns The reference.
+ *
+ * @since 1.0.0
+ */
+RS_API const char *rs_html_reference(char c);
+
+/**
+ * @brief Returns the characters escaped in JSON strings.
+ *
+ * Intended for internal use.
+ *
+ * @returns The set of characters.
+ *
+ * @since 1.0.0
+ */
+RS_API const rs_charset *rs_json_escape_set(void);
+
+/**
+ * @brief Returns the characters which are not percent-encoded in URLs.
+ *
+ * Intended for internal use.
+ *
+ * @returns The set of characters.
+ *
+ * @since 1.0.0
+ */
+RS_API const rs_charset *rs_url_unreserved_set(void);
+
+/**
+ * @brief Returns the characters escaped in HTML.
+ *
+ * Intended for internal use.
+ *
+ * @returns The set of characters.
+ *
+ * @since 1.0.0
+ */
+RS_API const rs_charset *rs_html_escape_set(void);
+
+/**
+ * @brief Returns the length of characters once escaped for a JSON string.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] input The characters to escape.
+ * @param[in] n The number of characters.
+ * @returns The length of the escaped characters.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_json_escaped_len(const char *input, size_t n);
+
+/**
+ * @brief Returns the length of characters once percent-encoded.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] input The characters to encode.
+ * @param[in] n The number of characters.
+ * @returns The length of the encoded characters.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_url_encoded_len(const char *input, size_t n);
+
+/**
+ * @brief Returns the length of characters once escaped for HTML.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] input The characters to escape.
+ * @param[in] n The number of characters.
+ * @returns The length of the escaped characters.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_html_escaped_len(const char *input, size_t n);
+
+/**
+ * @brief Encodes bytes in base64 one group at a time.
+ *
+ * Intended for internal use, and as a reference for the vector kernels.
+ *
+ * @param[out] output The encoding.
+ * @param[in] input The bytes to encode.
+ * @param[in] n The number of bytes.
+ * @param[in] alphabet Either #RS_BASE64_STANDARD or #RS_BASE64_URL.
+ * @returns The number of characters written.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_base64_encode_scalar(char *output,
+				      const unsigned char *input, size_t n,
+				      int alphabet);
+
+/**
+ * @brief Decodes base64 one group at a time.
+ *
+ * Intended for internal use, and as a reference for the vector kernels.
+ *
+ * @param[out] output The decoded bytes.
+ * @param[in] input The characters to decode, without padding.
+ * @param[in] n The number of characters.
+ * @returns `0` on success, `-1` on an invalid encoding.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_base64_decode_scalar(char *output, const char *input,
+				   size_t n);
+
+/**
+ * @brief Returns the value of a base64 character of either alphabet.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] c The character.
+ * @returns The value of the character, or `-1` if @c is not in an alphabet.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_base64_value(char c);
+
+/**
+ * @brief Encodes bytes in hexadecimal one at a time.
+ *
+ * Intended for internal use, and as a reference for the vector kernels.
+ *
+ * @param[out] output The encoding, twice as long as the input.
+ * @param[in] input The bytes to encode.
+ * @param[in] n The number of bytes.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_hex_encode_scalar(char *output, const unsigned char *input,
+				 size_t n);
+
+/**
+ * @brief Decodes hexadecimal one byte at a time.
+ *
+ * Intended for internal use, and as a reference for the vector kernels.
+ *
+ * @param[out] output The decoded bytes, half as long as the input.
+ * @param[in] input The characters to decode.
+ * @param[in] n The number of characters, which must be even.
+ * @returns `0` on success, `-1` on an invalid digit.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_hex_decode_scalar(char *output, const char *input, size_t n);
+
+#if RS_SSSE3
+/**
+ * @brief Encodes the leading whole blocks of bytes in base64.
+ *
+ * Intended for internal use.
+ *
+ * @param[out] output The encoding.
+ * @param[in] input The bytes to encode.
+ * @param[in] n The number of bytes.
+ * @param[in] alphabet Either #RS_BASE64_STANDARD or #RS_BASE64_URL.
+ * @returns The number of bytes encoded, a multiple of three.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_base64_encode_simd(char *output,
+				    const unsigned char *input, size_t n,
+				    int alphabet);
+
+/**
+ * @brief Decodes the leading whole blocks of base64.
+ *
+ * Decoding stops before the first block with an invalid character, which is
+ * left for the scalar decoder to report. Up to eight bytes past the decoded
+ * output may be overwritten, as long as they belong to the output of the
+ * characters left.
+ *
+ * Intended for internal use.
+ *
+ * @param[out] output The decoded bytes.
+ * @param[in] input The characters to decode, without padding.
+ * @param[in] n The number of characters.
+ * @returns The number of characters decoded, a multiple of four.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_base64_decode_simd(char *output, const char *input,
+				    size_t n);
+#endif
+
+#if RS_SSE2
+/**
+ * @brief Encodes the leading whole blocks of bytes in hexadecimal.
+ *
+ * Intended for internal use.
+ *
+ * @param[out] output The encoding.
+ * @param[in] input The bytes to encode.
+ * @param[in] n The number of bytes.
+ * @returns The number of bytes encoded.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_hex_encode_simd(char *output, const unsigned char *input,
+				 size_t n);
+
+/**
+ * @brief Decodes the leading whole blocks of hexadecimal.
+ *
+ * Decoding stops before the first block with an invalid digit, which is left
+ * for the scalar decoder to report.
+ *
+ * Intended for internal use.
+ *
+ * @param[out] output The decoded bytes.
+ * @param[in] input The characters to decode.
+ * @param[in] n The number of characters.
+ * @returns The number of characters decoded, an even number.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_hex_decode_simd(char *output, const char *input, size_t n);
+
+/**
+ * @brief Returns the bytes of a vector within a range.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] v The bytes.
+ * @param[in] first The first byte of the range.
+ * @param[in] last The last byte of the range.
+ * @returns A vector with the bytes within the range set to `0xFF`.
+ *
+ * @since 1.0.0
+ */
+RS_API __m128i rs_in_range16(__m128i v, char first, char last);
+#endif
+
+#if RS_AVX2
+/**
+ * @brief Returns the bytes of a vector within a range.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] v The bytes.
+ * @param[in] first The first byte of the range.
+ * @param[in] last The last byte of the range.
+ * @returns A vector with the bytes within the range set to `0xFF`.
+ *
+ * @since 1.0.0
+ */
+RS_API __m256i rs_in_range32(__m256i v, char first, char last);
+#endif
+
+/*
+ * ===============================================================
+ *
+ *                           CONVERSION
+ *
+ * ===============================================================
+ */
+
+/**
+ * @brief Parses a signed integer from a string.
+ *
+ * Identicle to `rs_to_i64_n(rs_data_c(s), rs_len(s), value)`.
+ *
+ * @param[in] s An initialized string.
+ * @param[out] value The parsed integer.
+ * @returns The number of characters parsed, or `0` on failure.
+ *
+ * @complexity Linear in the length of the number.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_to_i64(const rapidstring *s, int64_t *value);
+
+/**
+ * @brief Parses a signed integer from the start of an array.
+ *
+ * The integer is an optional sign followed by decimal digits. Unlike
+ * `strtol()`, whitespace is not skipped and the locale is ignored. Parsing
+ * stops at the first character which is not a digit, or at @n.
+ *
+ * @param[in] input The characters to parse.
+ * @param[in] n The number of characters.
+ * @param[out] value The parsed integer, left unmodified on failure.
+ * @returns The number of characters parsed, or `0` if there are no digits or
+ * the integer is out of range.
+ *
+ * @complexity Linear in the length of the number.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_to_i64_n(const char *input, size_t n, int64_t *value);
+
+/**
+ * @brief Parses an unsigned integer from a string.
+ *
+ * Identicle to `rs_to_u64_n(rs_data_c(s), rs_len(s), value)`.
+ *
+ * @param[in] s An initialized string.
+ * @param[out] value The parsed integer.
+ * @returns The number of characters parsed, or `0` on failure.
+ *
+ * @complexity Linear in the length of the number.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_to_u64(const rapidstring *s, uint64_t *value);
+
+/**
+ * @brief Parses an unsigned integer from the start of an array.
+ *
+ * The integer is an optional `+` followed by decimal digits, as for
+ * #rs_to_i64_n.
+ *
+ * @param[in] input The characters to parse.
+ * @param[in] n The number of characters.
+ * @param[out] value The parsed integer, left unmodified on failure.
+ * @returns The number of characters parsed, or `0` if there are no digits or
+ * the integer is out of range.
+ *
+ * @complexity Linear in the length of the number.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_to_u64_n(const char *input, size_t n, uint64_t *value);
+
+/**
+ * @brief Parses a floating point number from a string.
+ *
+ * Identicle to `rs_to_double_n(rs_data_c(s), rs_len(s), value)`.
+ *
+ * @param[in] s An initialized string.
+ * @param[out] value The parsed number.
+ * @returns The number of characters parsed, or `0` on failure.
+ *
+ * @complexity Linear in the length of the number.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_to_double(const rapidstring *s, double *value);
+
+/**
+ * @brief Parses a floating point number from the start of an array.
+ *
+ * The number is an optional sign, decimal digits with an optional `.`, and an
+ * optional exponent, or one of `inf`, `infinity` and `nan` in any case. The
+ * result is correctly rounded. Unlike `strtod()`, whitespace is not skipped,
+ * the decimal point is always `.` and hexadecimal numbers are not parsed.
+ *
+ * @param[in] input The characters to parse.
+ * @param[in] n The number of characters.
+ * @param[out] value The parsed number, left unmodified on failure.
+ * @returns The number of characters parsed, or `0` if there is no number.
+ *
+ * @complexity Linear in the length of the number.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_to_double_n(const char *input, size_t n, double *value);
+
+/**
+ * @brief Appends a signed integer in decimal.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] value The integer.
+ *
+ * @complexity Linear in the number of digits.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_i64(rapidstring *s, int64_t value);
+
+/**
+ * @brief Appends an unsigned integer in decimal.
+ *
+ * @param[in,out] s An initialized string.
+ * @param[in] value The integer.
+ *
+ * @complexity Linear in the number of digits.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_cat_u64(rapidstring *s, uint64_t value);
+
+/**
+ * @brief Loads eight characters as a little endian integer.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] input Eight characters.
+ * @returns The characters, the first in the lowest byte.
+ *
+ * @since 1.0.0
+ */
+RS_API uint64_t rs_load_le64(const char *input);
+
+/**
+ * @brief Parses the leading digits of an array.
+ *
+ * Eight digits at a time are checked and combined within a single integer.
+ * The value wraps around if it does not fit.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] input The characters to parse.
+ * @param[in] end The end of the characters.
+ * @param[in,out] value The value the digits are appended to.
+ * @returns The number of digits parsed.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_parse_digits(const char *input, const char *end,
+			      uint64_t *value);
+
+/**
+ * @brief Returns the high half of the product of two integers.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] a The first factor.
+ * @param[in] b The second factor.
+ * @param[out] low The low half of the product.
+ * @returns The high half of the product.
+ *
+ * @since 1.0.0
+ */
+RS_API uint64_t rs_mul128(uint64_t a, uint64_t b, uint64_t *low);
+
+/**
+ * @brief Computes the double nearest to `w * 10^q`.
+ *
+ * Follows Eisel and Lemire, with a table of truncated powers of five for a
+ * limited range of @q.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] w A nonzero decimal significand.
+ * @param[in] q A decimal exponent.
+ * @param[out] value The correctly rounded result.
+ * @returns `0` on success, `-1` if @q is out of range or the result could
+ * not be determined.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_eisel_lemire(uint64_t w, int q, double *value);
+
+/**
+ * @brief Parses a floating point number with `strtod()`.
+ *
+ * The slow but exact path, for numbers the fast paths cannot round. The
+ * decimal point is replaced by the one of the current locale.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] input A number accepted by #rs_to_double_n.
+ * @param[in] n The length of the number.
+ * @returns The parsed number.
+ *
+ * @since 1.0.0
+ */
+RS_API double rs_strtod_n(const char *input, size_t n);
+
+/**
+ * @brief Checks for a word at the start of an array, ignoring case.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] input The characters to check.
+ * @param[in] end The end of the characters.
+ * @param[in] word A lowercase word.
+ * @returns The length of @word if it is present, `0` otherwise.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_word_ci(const char *input, const char *end,
+			 const char *word);
+
+/**
+ * @brief Formats an unsigned integer in decimal, backwards from an end.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] end The end of a buffer of at least `20` characters.
+ * @param[in] value The integer.
+ * @returns The first digit.
+ *
+ * @since 1.0.0
+ */
+RS_API char *rs_format_u64(char *end, uint64_t value);
+
+/**
+ * @brief Formats a signed integer in decimal, backwards from an end.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] end The end of a buffer of at least `20` characters.
+ * @param[in] value The integer.
+ * @returns The sign or first digit.
+ *
+ * @since 1.0.0
+ */
+RS_API char *rs_format_i64(char *end, int64_t value);
+
+/*
+ * ===============================================================
+ *
+ *                             POOLING
+ *
+ * ===============================================================
+ */
+
+/*
+ * The number of strings a pool retains, and the default capacity above which
+ * released strings are trimmed.
+ */
+#ifndef RS_POOL_SIZE
+  #define RS_POOL_SIZE (16)
+#endif
+
+#ifndef RS_POOL_MAX_CAPACITY
+  #define RS_POOL_MAX_CAPACITY (64 * 1024)
+#endif
+
+/**
+ * @brief A pool of empty heap strings.
+ *
+ * Strings released to a pool keep their buffer, so that acquiring a string
+ * from the pool skips the allocations of growing it again. A pool is not
+ * synchronized; #rs_pool_local returns a pool for each thread, which is
+ * freed when the thread exits.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief The retained strings, the most recently released last.
+	 */
+	rapidstring strings[RS_POOL_SIZE];
+	/**
+	 * @brief The number of retained strings.
+	 */
+	size_t count;
+	/**
+	 * @brief The capacity above which released strings are trimmed.
+	 */
+	size_t max_capacity;
+} rs_pool;
+
+/**
+ * @brief Initializes a pool.
+ *
+ * @param[out] p The pool to initialize.
+ * @param[in] max_capacity The capacity released strings are trimmed to, or
+ * `0` for #RS_POOL_MAX_CAPACITY.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_pool_init(rs_pool *p, size_t max_capacity);
+
+/**
+ * @brief Frees the strings retained by a pool.
+ *
+ * The pool remains usable, and is empty afterwards.
+ *
+ * @param[in,out] p An initialized pool.
+ *
+ * @complexity Linear in the number of retained strings.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_pool_free(rs_pool *p);
+
+/**
+ * @brief Initializes an empty string from a pool.
+ *
+ * The most recently released string is handed out, with the capacity it was
+ * released with. A string is initialized as by #rs_init when the pool is
+ * empty.
+ *
+ * @param[in,out] p An initialized pool.
+ * @param[out] s The string to initialize.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_pool_acquire(rs_pool *p, rapidstring *s);
+
+/**
+ * @brief Returns a string to a pool.
+ *
+ * A heap string is emptied and retained, after its buffer is trimmed to the
+ * maximum capacity of the pool. Stack strings, and heap strings released to a
+ * full pool, are freed. Either way, @s must be reinitialized before it is
+ * used again.
+ *
+ * @param[in,out] p An initialized pool.
+ * @param[in] s An initialized string.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_pool_release(rs_pool *p, rapidstring *s);
+
+#if defined(RS_THREAD_LOCAL) && RS_POSIX
+/*
+ * The pool of each thread has internal linkage unless `RS_POOL_EXTERN` is
+ * defined, in which case `RS_POOL_DEFINE` must be placed in exactly one
+ * translation unit. The key freeing the pools of exiting threads follows.
+ */
+#ifdef RS_POOL_EXTERN
+  extern RS_THREAD_LOCAL rs_pool rs_pool_tls;
+  extern pthread_key_t rs_pool_key;
+  extern pthread_once_t rs_pool_once;
+  #define RS_POOL_DEFINE						\
+	RS_THREAD_LOCAL rs_pool rs_pool_tls;				\
+	pthread_key_t rs_pool_key;					\
+	pthread_once_t rs_pool_once = PTHREAD_ONCE_INIT;
+#else
+  static RS_THREAD_LOCAL rs_pool rs_pool_tls;
+  static pthread_key_t rs_pool_key;
+  static pthread_once_t rs_pool_once = PTHREAD_ONCE_INIT;
+#endif
+
+/**
+ * @brief Returns the pool of the calling thread.
+ *
+ * The pool is initialized on first use with #RS_POOL_MAX_CAPACITY. Its strings
+ * are freed when the thread exits.
+ *
+ * @returns The pool of the calling thread.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API rs_pool *rs_pool_local(void);
+
+/**
+ * @brief Creates the key freeing the pools of exiting threads.
+ *
+ * Intended for internal use.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_pool_key_init(void);
+
+/**
+ * @brief Frees the pool of an exiting thread.
+ *
+ * Intended for internal use.
+ *
+ * @param[in,out] p The pool of the thread.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_pool_exit(void *p);
+#endif
+
+/*
+ * ===============================================================
+ *
+ *                            HASH MAP
+ *
+ * ===============================================================
+ */
+
+/**
+ * @brief Stores the full hash of every key next to it.
+ *
+ * Growing the map then skips hashing the keys again, and comparisons of keys
+ * whose hashes differ are skipped, at the cost of eight bytes per slot.
+ *
+ * @since 1.0.0
+ */
+#define RS_MAP_CACHE_HASH (1)
+
+/**
+ * @brief The control byte of a slot which was never used.
+ *
+ * @since 1.0.0
+ */
+#define RS_MAP_EMPTY (0x80)
+
+/**
+ * @brief The control byte of a slot whose entry was erased.
+ *
+ * @since 1.0.0
+ */
+#define RS_MAP_DELETED (0xFE)
+
+/**
+ * @brief The number of slots whose control bytes are checked at once.
+ *
+ * @since 1.0.0
+ */
+#define RS_MAP_GROUP (16)
+
+/**
+ * @brief A hash map from strings to values of a fixed size.
+ *
+ * The map uses open addressing. Every slot has a control byte holding seven
+ * bits of the hash of its key, and the control bytes of a group of slots are
+ * compared at once. The keys are stored inline in the slots, so short keys
+ * are never allocated. The values follow their keys, aligned as a pointer.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief The control byte of every slot, followed by the slots.
+	 */
+	unsigned char *ctrl;
+	/**
+	 * @brief The slots, each a key and a value.
+	 */
+	char *slots;
+	/**
+	 * @brief The number of slots, a power of two and a multiple of
+	 * #RS_MAP_GROUP, or zero.
+	 */
+	size_t capacity;
+	/**
+	 * @brief The number of entries.
+	 */
+	size_t size;
+	/**
+	 * @brief The number of empty slots which may still be filled before the
+	 * map grows.
+	 */
+	size_t growth_left;
+	/**
+	 * @brief The size of a slot.
+	 */
+	size_t slot_size;
+	/**
+	 * @brief The offset of the value within a slot.
+	 */
+	size_t value_offset;
+	/**
+	 * @brief The flags the map was initialized with.
+	 */
+	int flags;
+} rs_map;
+
+/**
+ * @brief Hashes a string.
+ *
+ * Identicle to `rs_hash_n(rs_data_c(s), rs_len(s))`.
+ *
+ * @param[in] s An initialized string.
+ * @returns The hash of the string.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API uint64_t rs_hash(const rapidstring *s);
+
+/**
+ * @brief Hashes an array.
+ *
+ * The hash follows wyhash, and is the same on every platform.
+ *
+ * @param[in] input The characters to hash.
+ * @param[in] n The number of characters.
+ * @returns The hash of the array.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API uint64_t rs_hash_n(const char *input, size_t n);
+
+/**
+ * @brief Initializes an empty map.
+ *
+ * No memory is allocated until the first insertion.
+ *
+ * @param[out] m The map to initialize.
+ * @param[in] value_size The size of the values.
+ * @param[in] flags Either `0` or #RS_MAP_CACHE_HASH.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_map_init(rs_map *m, size_t value_size, int flags);
+
+/**
+ * @brief Frees a map and its keys.
+ *
+ * @param[in] m The map to free.
+ *
+ * @complexity Linear in the capacity of @m.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_map_free(rs_map *m);
+
+/**
+ * @brief Grows a map to hold a number of entries without growing again.
+ *
+ * @param[in,out] m An initialized map.
+ * @param[in] n The number of entries.
+ *
+ * @complexity Linear in the capacity of @m if it grows, otherwise constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_map_reserve(rs_map *m, size_t n);
+
+/**
+ * @brief Finds the value of a key.
+ *
+ * Identicle to `rs_map_find_n(m, rs_data_c(key), rs_len(key))`.
+ *
+ * @param[in] m An initialized map.
+ * @param[in] key An initialized string.
+ * @returns The value of @key, or `NULL` if it is not in the map.
+ *
+ * @complexity Constant on average.
+ *
+ * @since 1.0.0
+ */
+RS_API void *rs_map_find(const rs_map *m, const rapidstring *key);
+
+/**
+ * @brief Finds the value of a key given as an array.
+ *
+ * @param[in] m An initialized map.
+ * @param[in] key The characters of the key.
+ * @param[in] n The number of characters.
+ * @returns The value of the key, or `NULL` if it is not in the map. The value
+ * remains valid until an entry is inserted or erased.
+ *
+ * @complexity Constant on average.
+ *
+ * @since 1.0.0
+ */
+RS_API void *rs_map_find_n(const rs_map *m, const char *key, size_t n);
+
+/**
+ * @brief Finds or inserts a key.
+ *
+ * Identicle to
+ * `rs_map_insert_n(m, rs_data_c(key), rs_len(key), inserted)`.
+ *
+ * @param[in,out] m An initialized map.
+ * @param[in] key An initialized string.
+ * @param[out] inserted Set to whether @key was inserted, may be `NULL`.
+ * @returns The value of @key.
+ *
+ * @complexity Constant on average.
+ *
+ * @since 1.0.0
+ */
+RS_API void *rs_map_insert(rs_map *m, const rapidstring *key, int *inserted);
+
+/**
+ * @brief Finds or inserts a key given as an array.
+ *
+ * The key is copied into the map if it is not yet present, in which case
+ * the returned value is uninitialized.
+ *
+ * @param[in,out] m An initialized map.
+ * @param[in] key The characters of the key.
+ * @param[in] n The number of characters.
+ * @param[out] inserted Set to whether the key was inserted, may be `NULL`.
+ * @returns The value of the key. The value remains valid until an entry is
+ * inserted or erased.
+ *
+ * @complexity Constant on average.
+ *
+ * @since 1.0.0
+ */
+RS_API void *rs_map_insert_n(rs_map *m, const char *key, size_t n,
+			     int *inserted);
+
+/**
+ * @brief Erases a key.
+ *
+ * Identicle to `rs_map_erase_n(m, rs_data_c(key), rs_len(key))`.
+ *
+ * @param[in,out] m An initialized map.
+ * @param[in] key An initialized string.
+ * @returns `1` if @key was erased, `0` if it is not in the map.
+ *
+ * @complexity Constant on average.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_map_erase(rs_map *m, const rapidstring *key);
+
+/**
+ * @brief Erases a key given as an array.
+ *
+ * @param[in,out] m An initialized map.
+ * @param[in] key The characters of the key.
+ * @param[in] n The number of characters.
+ * @returns `1` if the key was erased, `0` if it is not in the map.
+ *
+ * @complexity Constant on average.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_map_erase_n(rs_map *m, const char *key, size_t n);
+
+/**
+ * @brief Iterates over the entries of a map.
+ *
+ * @param[in] m An initialized map.
+ * @param[in,out] pos The position of the iteration, starting at `0`.
+ * @param[out] key The key of the next entry.
+ * @param[out] value The value of the next entry.
+ * @returns `1` if an entry was found, `0` at the end of the map.
+ *
+ * @complexity Linear in the capacity of @m over a whole iteration.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_map_next(const rs_map *m, size_t *pos, const rapidstring **key,
+		       void **value);
+
+/**
+ * @brief Loads four characters as a little endian integer.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] input Four characters.
+ * @returns The characters, the first in the lowest byte.
+ *
+ * @since 1.0.0
+ */
+RS_API uint64_t rs_load_le32(const char *input);
+
+/**
+ * @brief Multiplies two integers and folds the product.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] a The first factor.
+ * @param[in] b The second factor.
+ * @returns The high half of the product xored with the low half.
+ *
+ * @since 1.0.0
+ */
+RS_API uint64_t rs_mix(uint64_t a, uint64_t b);
+
+/**
+ * @brief Returns the slots of a group with a given control byte.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] ctrl The control bytes of the group.
+ * @param[in] c The control byte.
+ * @returns A mask with bit `i` set if `ctrl[i]` is @c.
+ *
+ * @since 1.0.0
+ */
+RS_API uint32_t rs_map_match(const unsigned char *ctrl, unsigned char c);
+
+/**
+ * @brief Returns the slots of a group without an entry.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] ctrl The control bytes of the group.
+ * @returns A mask with bit `i` set if `ctrl[i]` is empty or deleted.
+ *
+ * @since 1.0.0
+ */
+RS_API uint32_t rs_map_match_free(const unsigned char *ctrl);
+
+/**
+ * @brief Finds the slot of a key.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] m An initialized map.
+ * @param[in] key The characters of the key.
+ * @param[in] n The number of characters.
+ * @param[in] hash The hash of the key.
+ * @returns The index of the slot, or #RS_NPOS if the key is not in the map.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_map_find_slot(const rs_map *m, const char *key, size_t n,
+			       uint64_t hash);
+
+/**
+ * @brief Finds the first slot without an entry on the probe sequence of a
+ * hash.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] m An initialized map with a nonzero capacity.
+ * @param[in] hash The hash of a key.
+ * @returns The index of the slot.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_map_free_slot(const rs_map *m, uint64_t hash);
+
+/**
+ * @brief Moves the entries of a map to new slots.
+ *
+ * Intended for internal use.
+ *
+ * @param[in,out] m An initialized map.
+ * @param[in] capacity The new capacity, enough for the entries.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_map_rehash(rs_map *m, size_t capacity);
+
+/**
+ * @brief Returns the capacity needed for a number of entries.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] n The number of entries.
+ * @returns The capacity.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_map_capacity_for(size_t n);
+
+/*
+ * ===============================================================
+ *
+ *                           RADIX TREE
+ *
+ * ===============================================================
+ */
+
+/* The node types of a radix tree, by the number of children they hold. */
+#define RS_RADIX_NODE4 (0)
+#define RS_RADIX_NODE16 (1)
+#define RS_RADIX_NODE48 (2)
+#define RS_RADIX_NODE256 (3)
+
+/**
+ * @brief A key and its value, the leaves of a radix tree.
+ *
+ * The characters of the key follow the structure.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief The value.
+	 */
+	void *value;
+	/**
+	 * @brief The length of the key.
+	 */
+	size_t len;
+} rs_radix_leaf;
+
+/**
+ * @brief The header of the inner nodes of a radix tree.
+ *
+ * The characters shared by every key below the node follow the node, after
+ * its children.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief The leaf of the key ending at the node, or `NULL`.
+	 */
+	rs_radix_leaf *leaf;
+	/**
+	 * @brief The number of characters shared by the keys below the node.
+	 */
+	uint32_t prefix_len;
+	/**
+	 * @brief The number of children.
+	 */
+	uint16_t count;
+	/**
+	 * @brief One of #RS_RADIX_NODE4, #RS_RADIX_NODE16, #RS_RADIX_NODE48 and
+	 * #RS_RADIX_NODE256.
+	 */
+	unsigned char type;
+} rs_radix_node;
+
+/**
+ * @brief A node with up to 4 children, sorted by character.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	rs_radix_node node;
+	unsigned char keys[4];
+	void *children[4];
+} rs_radix_node4;
+
+/**
+ * @brief A node with up to 16 children, sorted by character.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	rs_radix_node node;
+	unsigned char keys[16];
+	void *children[16];
+} rs_radix_node16;
+
+/**
+ * @brief A node with up to 48 children, indexed by character.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	rs_radix_node node;
+	/**
+	 * @brief One past the position of the child of every character, or
+	 * `0`.
+	 */
+	unsigned char index[256];
+	void *children[48];
+} rs_radix_node48;
+
+/**
+ * @brief A node with a child for every character.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	rs_radix_node node;
+	void *children[256];
+} rs_radix_node256;
+
+/**
+ * @brief An adaptive radix tree mapping strings to pointers.
+ *
+ * Chains of nodes with a single child are compressed into the prefix of a
+ * node, and nodes grow through four sizes as children are added. Lookups do
+ * not allocate.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief The root, a tagged pointer, or `NULL` for an empty tree.
+	 */
+	void *root;
+	/**
+	 * @brief The number of keys.
+	 */
+	size_t size;
+} rs_radix_tree;
+
+/*
+ * Children are tagged pointers. Leaves are allocated with at least the
+ * alignment of a pointer, which leaves the lowest bit to mark them.
+ */
+#define RS_RADIX_IS_LEAF(p) (((uintptr_t)(p) & 1) != 0)
+#define RS_RADIX_LEAF(p) ((rs_radix_leaf*)((uintptr_t)(p) - 1))
+#define RS_RADIX_TAG(leaf) ((void*)((uintptr_t)(leaf) + 1))
+
+/**
+ * @brief Called for the keys found by #rs_radix_iterate_prefix.
+ *
+ * The arguments are the user data, the key and its length, and its value. A
+ * nonzero return stops the iteration.
+ *
+ * @since 1.0.0
+ */
+typedef int (*rs_radix_fn)(void *data, const char *key, size_t n,
+			   void *value);
+
+/**
+ * @brief Initializes an empty tree.
+ *
+ * @param[out] t The tree to initialize.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_radix_init(rs_radix_tree *t);
+
+/**
+ * @brief Frees a tree.
+ *
+ * The values are not freed.
+ *
+ * @param[in] t The tree to free.
+ *
+ * @complexity Linear in the number of keys.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_radix_free(rs_radix_tree *t);
+
+/**
+ * @brief Builds a tree from sorted keys.
+ *
+ * The tree is built bottom up, without searching for the position of every
+ * key.
+ *
+ * @param[in,out] t An initialized empty tree.
+ * @param[in] keys Initialized strings, unique and in ascending order of their
+ * characters compared as unsigned.
+ * @param[in] values The value of every key, or `NULL` for `NULL` values.
+ * @param[in] n The number of keys.
+ *
+ * @complexity Linear in the total length of the keys.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_radix_build(rs_radix_tree *t, const rapidstring *keys,
+			   void *const *values, size_t n);
+
+/**
+ * @brief Finds or inserts a key.
+ *
+ * Identicle to
+ * `rs_radix_insert_n(t, rs_data_c(key), rs_len(key), inserted)`.
+ *
+ * @param[in,out] t An initialized tree.
+ * @param[in] key An initialized string.
+ * @param[out] inserted Set to whether @key was inserted, may be `NULL`.
+ * @returns The value of @key.
+ *
+ * @complexity Linear in the length of @key.
+ *
+ * @since 1.0.0
+ */
+RS_API void **rs_radix_insert(rs_radix_tree *t, const rapidstring *key,
+			      int *inserted);
+
+/**
+ * @brief Finds or inserts a key given as an array.
+ *
+ * The value of an inserted key is `NULL`.
+ *
+ * @param[in,out] t An initialized tree.
+ * @param[in] key The characters of the key.
+ * @param[in] n The number of characters.
+ * @param[out] inserted Set to whether the key was inserted, may be `NULL`.
+ * @returns The value of the key, which remains valid until the tree is freed.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API void **rs_radix_insert_n(rs_radix_tree *t, const char *key, size_t n,
+				int *inserted);
+
+/**
+ * @brief Finds the value of a key.
+ *
+ * Identicle to `rs_radix_find_n(t, rs_data_c(key), rs_len(key))`.
+ *
+ * @param[in] t An initialized tree.
+ * @param[in] key An initialized string.
+ * @returns The value of @key, or `NULL` if it is not in the tree.
+ *
+ * @complexity Linear in the length of @key.
+ *
+ * @since 1.0.0
+ */
+RS_API void **rs_radix_find(const rs_radix_tree *t, const rapidstring *key);
+
+/**
+ * @brief Finds the value of a key given as an array.
+ *
+ * @param[in] t An initialized tree.
+ * @param[in] key The characters of the key.
+ * @param[in] n The number of characters.
+ * @returns The value of the key, or `NULL` if it is not in the tree.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API void **rs_radix_find_n(const rs_radix_tree *t, const char *key,
+			      size_t n);
+
+/**
+ * @brief Finds the longest key which is a prefix of a string.
+ *
+ * Identicle to
+ * `rs_radix_longest_prefix_n(t, rs_data_c(s), rs_len(s), len)`.
+ *
+ * @param[in] t An initialized tree.
+ * @param[in] s An initialized string.
+ * @param[out] len The length of the key found, may be `NULL`.
+ * @returns The value of the key, or `NULL` if no key is a prefix of @s.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API void **rs_radix_longest_prefix(const rs_radix_tree *t,
+				      const rapidstring *s, size_t *len);
+
+/**
+ * @brief Finds the longest key which is a prefix of an array.
+ *
+ * @param[in] t An initialized tree.
+ * @param[in] input The characters to match.
+ * @param[in] n The number of characters.
+ * @param[out] len The length of the key found, may be `NULL`.
+ * @returns The value of the key, or `NULL` if no key is a prefix of @input.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API void **rs_radix_longest_prefix_n(const rs_radix_tree *t,
+					const char *input, size_t n,
+					size_t *len);
+
+/**
+ * @brief Reports every key starting with a prefix.
+ *
+ * Identicle to
+ * `rs_radix_iterate_prefix_n(t, rs_data_c(prefix), rs_len(prefix), ...)`.
+ *
+ * @param[in] t An initialized tree.
+ * @param[in] prefix An initialized string.
+ * @param[in] fn The function called for every key.
+ * @param[in] data The user data passed to @fn.
+ * @returns The number of keys reported.
+ *
+ * @complexity Linear in the length of @prefix plus the size of the subtree
+ * of the keys reported.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_radix_iterate_prefix(const rs_radix_tree *t,
+				      const rapidstring *prefix,
+				      rs_radix_fn fn, void *data);
+
+/**
+ * @brief Reports every key starting with a prefix given as an array.
+ *
+ * The keys are reported in ascending order.
+ *
+ * @param[in] t An initialized tree.
+ * @param[in] prefix The characters of the prefix.
+ * @param[in] n The number of characters.
+ * @param[in] fn The function called for every key.
+ * @param[in] data The user data passed to @fn.
+ * @returns The number of keys reported.
+ *
+ * @complexity Linear in @n plus the size of the subtree of the keys
+ * reported.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_radix_iterate_prefix_n(const rs_radix_tree *t,
+					const char *prefix, size_t n,
+					rs_radix_fn fn, void *data);
+
+/**
+ * @brief Allocates a leaf.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] key The characters of the key.
+ * @param[in] n The number of characters.
+ * @param[in] value The value.
+ * @returns The leaf.
+ *
+ * @since 1.0.0
+ */
+RS_API rs_radix_leaf *rs_radix_leaf_new(const char *key, size_t n,
+					void *value);
+
+/**
+ * @brief Returns the characters of the key of a leaf.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] leaf A leaf.
+ * @returns The characters of the key.
+ *
+ * @since 1.0.0
+ */
+RS_API const char *rs_radix_leaf_key(const rs_radix_leaf *leaf);
+
+/**
+ * @brief Allocates an inner node.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] type The type of the node.
+ * @param[in] prefix The prefix of the node.
+ * @param[in] n The length of the prefix.
+ * @returns The node, without children.
+ *
+ * @since 1.0.0
+ */
+RS_API rs_radix_node *rs_radix_node_new(unsigned char type,
+					const char *prefix, size_t n);
+
+/**
+ * @brief Returns the prefix of a node.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] node A node.
+ * @returns The characters of the prefix.
+ *
+ * @since 1.0.0
+ */
+RS_API char *rs_radix_prefix(const rs_radix_node *node);
+
+/**
+ * @brief Returns the size of a node type.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] type The type.
+ * @returns The size of the type, without the prefix.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_radix_node_size(unsigned char type);
+
+/**
+ * @brief Finds the child of a character.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] node A node.
+ * @param[in] c The character.
+ * @returns The child of @c, or `NULL`.
+ *
+ * @since 1.0.0
+ */
+RS_API void **rs_radix_child(const rs_radix_node *node, unsigned char c);
+
+/**
+ * @brief Adds a child to a node, growing the node if it is full.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] node A node without a child for @c.
+ * @param[in] c The character of the child.
+ * @param[in] child The child, a tagged pointer.
+ * @returns The node, which is reallocated if it grew.
+ *
+ * @since 1.0.0
+ */
+RS_API rs_radix_node *rs_radix_add_child(rs_radix_node *node,
+					 unsigned char c, void *child);
+
+/**
+ * @brief Moves a full node to the next larger type.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] node A node, which is freed.
+ * @returns The larger node.
+ *
+ * @since 1.0.0
+ */
+RS_API rs_radix_node *rs_radix_grow(rs_radix_node *node);
+
+/**
+ * @brief Returns the length of the common prefix of two arrays.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] a The first array.
+ * @param[in] a_len The length of the first array.
+ * @param[in] b The second array.
+ * @param[in] b_len The length of the second array.
+ * @returns The number of leading characters the arrays share.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_common_prefix(const char *a, size_t a_len, const char *b,
+			       size_t b_len);
+
+/**
+ * @brief Builds the subtree of a range of sorted keys.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] keys The keys.
+ * @param[in] values The values, or `NULL`.
+ * @param[in] lo The first key of the range.
+ * @param[in] hi One past the last key of the range.
+ * @param[in] depth The number of characters the keys share with the path to
+ * the subtree.
+ * @returns The subtree, a tagged pointer.
+ *
+ * @since 1.0.0
+ */
+RS_API void *rs_radix_build_range(const rapidstring *keys,
+				  void *const *values, size_t lo, size_t hi,
+				  size_t depth);
+
+/**
+ * @brief Reports every key of a subtree in ascending order.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] child A subtree, a tagged pointer.
+ * @param[in] fn The function called for every key.
+ * @param[in] data The user data passed to @fn.
+ * @param[in,out] count The number of keys reported.
+ * @returns Nonzero if @fn stopped the iteration.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_radix_walk(const void *child, rs_radix_fn fn, void *data,
+			 size_t *count);
+
+/**
+ * @brief Frees a subtree.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] child A subtree, a tagged pointer.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_radix_free_child(void *child);
+
+/*
+ * ===============================================================
+ *
+ *                           COMPRESSION
+ *
+ * ===============================================================
+ */
+
+#ifdef RS_COMPRESSION
+
+/*
+ * Heap strings shorter than this are not compressed, as the savings would
+ * not cover the cost of the allocator's rounding.
+ */
+#ifndef RS_COMPRESS_MIN
+  #define RS_COMPRESS_MIN (64)
+#endif
+
+/* Parameters of the codec. */
+#define RS_LZ_HASH_BITS (12)
+#define RS_LZ_MIN_MATCH (4)
+#define RS_LZ_MAX_OFFSET (0xFFFF)
+
+/**
+ * @brief Compresses a heap string in place.
+ *
+ * Only available when `RS_COMPRESSION` is defined. The characters are
+ * replaced by an LZ4 style encoding and the buffer is shrunk to fit it. The
+ * string is decompressed by the first function which takes it as a
+ * non-`const` string and uses its characters, such as rs_data() or
+ * rs_cat(). Functions replacing the characters and freeing the string
+ * discard the encoding without decompressing it.
+ *
+ * Functions taking a `const` string never decompress it. rs_len(),
+ * rs_capacity() and the queries of the state of a string may be called on a
+ * compressed string, while reading its characters, as rs_data_c() does,
+ * requires calling rs_decompress() first. Reading them before aborts.
+ *
+ * Stack strings, strings shorter than #RS_COMPRESS_MIN, and strings which
+ * would shrink by less than an eighth are left as they are.
+ *
+ * @param[in,out] s An initialized string.
+ * @returns `1` if the string was compressed, `0` otherwise.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_compress(rapidstring *s);
+
+/**
+ * @brief Compresses an array of strings in place.
+ *
+ * Identical to calling rs_compress() on every string, except that a single
+ * buffer is used to compress all of them.
+ *
+ * @param[in,out] s An array of initialized strings.
+ * @param[in] n The number of strings.
+ * @returns The number of bytes of heap capacity released.
+ *
+ * @complexity Linear in the total length of the strings.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_compress_all(rapidstring *s, size_t n);
+
+/**
+ * @brief Decompresses a string.
+ *
+ * Strings which are not compressed are left as they are. Calling this is
+ * needed before passing a compressed string to a function which reads its
+ * characters through a `const` string.
+ *
+ * @param[in,out] s An initialized string.
+ *
+ * @complexity Linear in the length of @s.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_decompress(rapidstring *s);
+
+/**
+ * @brief Checks whether a string is compressed.
+ *
+ * @param[in] s An initialized string.
+ * @returns `1` if the string is compressed, `0` otherwise.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_is_compressed(const rapidstring *s);
+
+/**
+ * @brief Gets the number of bytes the characters of a string occupy.
+ *
+ * This is the length of the encoding for a compressed string, which is not
+ * decompressed, and the length otherwise.
+ *
+ * @param[in] s An initialized string.
+ * @returns The compressed length.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_compressed_len(const rapidstring *s);
+
+/**
+ * @brief Checks whether a string is worth attempting to compress.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] s An initialized string.
+ * @returns `1` if the string may be compressed, `0` otherwise.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_is_compressible(const rapidstring *s);
+
+/**
+ * @brief Compresses a heap string using a scratch buffer.
+ *
+ * Intended for internal use.
+ *
+ * @param[in,out] s A compressible string.
+ * @param[in] scratch A buffer of at least `rs_lz_bound(rs_heap_len(s))`
+ * bytes.
+ * @returns The number of bytes of heap capacity released.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_compress_with(rapidstring *s, char *scratch);
+
+/**
+ * @brief Gets the largest encoded length of an array.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] n The number of characters.
+ * @returns The largest encoded length.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_lz_bound(size_t n);
+
+/**
+ * @brief Encodes an array.
+ *
+ * Intended for internal use.
+ *
+ * The encoding is a series of sequences, each a token holding the number of
+ * literals and the match length in its high and low four bits, the
+ * extensions of either which does not fit, the literals, and the two byte
+ * little endian offset of the match. The last sequence has no match.
+ *
+ * @param[out] dst A buffer of at least `rs_lz_bound(n)` bytes.
+ * @param[in] src The characters to encode.
+ * @param[in] n The number of characters, at most `0xFFFFFFFF`.
+ * @returns The encoded length.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_lz_compress(char *dst, const char *src, size_t n);
+
+/**
+ * @brief Decodes an array encoded by #rs_lz_compress.
+ *
+ * Intended for internal use.
+ *
+ * @param[out] dst A buffer of at least the decoded length.
+ * @param[in] dst_n The size of @dst, which may be written up to its end.
+ * @param[in] src The encoded characters.
+ * @param[in] n The encoded length.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_lz_decompress(char *dst, size_t dst_n, const char *src,
+			     size_t n);
+
+/**
+ * @brief Writes a sequence of the encoding.
+ *
+ * Intended for internal use.
+ *
+ * @param[out] out The end of the encoding.
+ * @param[in] literals The characters before the match.
+ * @param[in] n The number of literals.
+ * @param[in] offset The distance back to the match.
+ * @param[in] len The match length, or `0` for the last sequence.
+ * @returns The new end of the encoding.
+ *
+ * @since 1.0.0
+ */
+RS_API unsigned char *rs_lz_sequence(unsigned char *out,
+				     const unsigned char *literals, size_t n,
+				     size_t offset, size_t len);
+
+/**
+ * @brief Writes the extension of a length which does not fit its token.
+ *
+ * Intended for internal use.
+ *
+ * @param[out] out The end of the encoding.
+ * @param[in] len The length minus `15`.
+ * @returns The new end of the encoding.
+ *
+ * @since 1.0.0
+ */
+RS_API unsigned char *rs_lz_write_length(unsigned char *out, size_t len);
+
+/**
+ * @brief Reads the extension of a length.
+ *
+ * Intended for internal use.
+ *
+ * @param[in,out] in The encoding, advanced past the extension.
+ * @param[in] len The length held by the token.
+ * @returns The full length.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_lz_read_length(const unsigned char **in, size_t len);
+
+#endif /* RS_COMPRESSION */
+
+/*
+ * ===============================================================
+ *
+ *                          FILE LOADING
+ *
+ * ===============================================================
+ */
+
+#if RS_POSIX
+
+/**
+ * @brief Number of files read at the same time by rs_load_files().
+ *
+ * @since 1.0.0
+ */
+#ifndef RS_LOAD_QUEUE_DEPTH
+  #define RS_LOAD_QUEUE_DEPTH (64)
+#endif
+
+/* Reads larger than this are split, as the ring takes 32-bit lengths. */
+#define RS_LOAD_MAX_READ (1UL << 30)
+
+/**
+ * @brief A file being read by rs_load_files().
+ *
+ * Intended for internal use.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief The index of the file, or #RS_NPOS for a free slot.
+	 */
+	size_t index;
+	/**
+	 * @brief The file descriptor.
+	 */
+	int fd;
+	/**
+	 * @brief The size of the file, or #RS_NPOS if it is not known.
+	 */
+	size_t size;
+	/**
+	 * @brief The number of characters read.
+	 */
+	size_t offset;
+} rs_load_slot;
+
+/**
+ * @brief Loads files into strings.
+ *
+ * The contents of every file replace those of its string. Regular files are
+ * sized with `fstat()`, their strings reserved to fit exactly, and read
+ * into place without copying, up to the size they had when opened. Other
+ * files are read until their end.
+ *
+ * Up to #RS_LOAD_QUEUE_DEPTH files are open at once. With `RS_IO_URING`
+ * defined on Linux, their reads are submitted together through io_uring so
+ * the device sees them all, falling back to the path below when the ring
+ * cannot be created. Otherwise every open file is advised to be read ahead
+ * before any is read.
+ *
+ * @param[in,out] dst An array of @n initialized strings. A string whose
+ * file failed to load is left empty.
+ * @param[in] paths The paths of the files.
+ * @param[in] n The number of files.
+ * @param[out] errors An array of @n error numbers, `0` for the files which
+ * loaded. May be `NULL`.
+ * @returns `0` if every file loaded, `-1` otherwise with `errno` set to the
+ * error of the first file which failed.
+ *
+ * @complexity Linear in the total size of the files.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_load_files(rapidstring *dst, const char *const *paths,
+			 size_t n, int *errors);
+
+/**
+ * @brief Opens a file to be loaded.
+ *
+ * Intended for internal use.
+ *
+ * @param[out] slot The slot of the file, whose index is left to be set.
+ * @param[in] s The string to load into, which is emptied and reserved.
+ * @param[in] path The path of the file.
+ * @returns `0` on success, `-1` on failure with `errno` set and the slot
+ * left free.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_load_open(rs_load_slot *slot, rapidstring *s,
+			const char *path);
+
+/**
+ * @brief Reads the rest of a file into a string.
+ *
+ * Intended for internal use. Regular files are read from the offset of the
+ * slot, whatever the position of the file.
+ *
+ * @param[in,out] slot The slot of the file, which is closed.
+ * @param[in,out] s A string holding the characters read so far.
+ * @returns `0` on success, `-1` on failure with `errno` set.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_load_read(rs_load_slot *slot, rapidstring *s);
+
+/**
+ * @brief Records the result of loading a file.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] err `0` or the error of the file.
+ * @param[in] i The index of the file.
+ * @param[out] errors The errors of the files. May be `NULL`.
+ * @param[in,out] first The first error.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_load_result(int err, size_t i, int *errors, int *first);
+
+#if RS_URING
+
+/**
+ * @brief The mapped rings of an io_uring instance.
+ *
+ * Intended for internal use.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	int fd;
+	unsigned *sq_tail;
+	unsigned *sq_mask;
+	unsigned *sq_array;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned *cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sq_map;
+	size_t sq_map_size;
+	void *cq_map;
+	size_t cq_map_size;
+	size_t sqes_size;
+	unsigned pending;
+} rs_uring;
+
+/**
+ * @brief Creates an io_uring instance.
+ *
+ * Intended for internal use.
+ *
+ * @param[out] r The instance.
+ * @param[in] entries The number of submission entries.
+ * @returns `0` on success, `-1` on failure with `errno` set.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_uring_init(rs_uring *r, unsigned entries);
+
+/**
+ * @brief Destroys an io_uring instance.
+ *
+ * Intended for internal use.
+ *
+ * @param[in] r An initialized instance.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_uring_free(rs_uring *r);
+
+/**
+ * @brief Queues the read of the rest of a file.
+ *
+ * Intended for internal use.
+ *
+ * @param[in,out] r An initialized instance with a free submission entry.
+ * @param[in] slot The slot of the file, whose address is the user data.
+ * @param[in] s The string the file is read into.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_uring_read(rs_uring *r, rs_load_slot *slot, rapidstring *s);
+
+/**
+ * @brief Submits the queued entries and waits for a completion.
+ *
+ * Intended for internal use.
+ *
+ * @param[in,out] r An initialized instance.
+ * @returns `0` on success, `-1` on failure with `errno` set.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_uring_enter(rs_uring *r);
+
+/**
+ * @brief Waits for a completion without submitting.
+ *
+ * Intended for internal use.
+ *
+ * @param[in,out] r An initialized instance.
+ * @returns `0` on success, `-1` on failure with `errno` set.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_uring_wait(rs_uring *r);
+
+/**
+ * @brief Takes a completion.
+ *
+ * Intended for internal use.
+ *
+ * @param[in,out] r An initialized instance.
+ * @param[out] slot The slot of the completed read.
+ * @param[out] res The result of the read.
+ * @returns `1` if there was a completion, `0` otherwise.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_uring_reap(rs_uring *r, rs_load_slot **slot, int *res);
+
+/**
+ * @brief Loads files through io_uring.
+ *
+ * Intended for internal use.
+ *
+ * @param[in,out] r An initialized instance.
+ * @param[in,out] dst The strings.
+ * @param[in] paths The paths of the files.
+ * @param[in] n The number of files.
+ * @param[out] errors The errors of the files. May be `NULL`.
+ * @param[in,out] first The first error.
+ * @returns The number of files loaded, which is less than @n if the ring
+ * failed.
+ *
+ * @since 1.0.0
+ */
+RS_API size_t rs_uring_load(rs_uring *r, rapidstring *dst,
+			    const char *const *paths, size_t n, int *errors,
+			    int *first);
+
+#endif /* RS_URING */
+
+#endif /* RS_POSIX */
+
+/*
+ * ===============================================================
+ *
+ *                            STREAMING
+ *
+ * ===============================================================
+ */
+
+/**
+ * @brief Default high-water mark of a sink.
+ *
+ * @since 1.0.0
+ */
+#ifndef RS_SINK_SIZE
+  #define RS_SINK_SIZE (64 * 1024)
+#endif
+
+/**
+ * @brief Called with the buffered characters of a sink.
+ *
+ * The arguments are the user data, the characters, and their number. A
+ * nonzero return is an error, which stops further calls.
+ *
+ * @since 1.0.0
+ */
+typedef int (*rs_flush_fn)(void *data, const char *buffer, size_t n);
+
+/**
+ * @brief A buffer which hands its characters to a callback when full.
+ *
+ * Output of any size is produced in a buffer of bounded size. The buffer is
+ * flushed when appending would take it past the high-water mark, and its
+ * capacity is kept for the characters which follow.
+ *
+ * @since 1.0.0
+ */
+typedef struct {
+	/**
+	 * @brief The buffered characters.
+	 */
+	rapidstring buffer;
+	/**
+	 * @brief The number of characters buffered before a flush.
+	 */
+	size_t high_water;
+	/**
+	 * @brief The callback.
+	 */
+	rs_flush_fn fn;
+	/**
+	 * @brief The user data of the callback.
+	 */
+	void *data;
+	/**
+	 * @brief The first error returned by the callback, or `0`.
+	 */
+	int error;
+	/**
+	 * @brief The number of characters passed to the callback.
+	 */
+	uint64_t flushed;
+} rs_sink;
+
+/**
+ * @brief Initializes a sink.
+ *
+ * @param[out] k The sink to initialize.
+ * @param[in] high_water The high-water mark, or `0` for #RS_SINK_SIZE.
+ * @param[in] fn The callback.
+ * @param[in] data The user data of the callback.
+ *
+ * @complexity Constant.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_sink_init(rs_sink *k, size_t high_water, rs_flush_fn fn,
+			 void *data);
+
+/**
+ * @brief Frees a sink.
+ *
+ * Buffered characters are discarded. Call rs_sink_flush() first to keep
+ * them.
+ *
+ * @param[in] k The sink to free.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_sink_free(rs_sink *k);
+
+/**
+ * @brief Passes the buffered characters to the callback.
+ *
+ * Once the callback has failed, buffered characters are discarded instead.
+ *
+ * @param[in,out] k An initialized sink.
+ * @returns `0`, or the first error returned by the callback.
+ *
+ * @complexity The complexity of the callback.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_sink_flush(rs_sink *k);
+
+/**
+ * @brief Accesses the buffer of a sink to append to it.
+ *
+ * Any function appending to a string may append to the buffer, followed by
+ * rs_sink_commit(). The buffer is flushed first if appending @n characters
+ * would take it past the high-water mark. An append longer than @n may grow
+ * the buffer, which then keeps that capacity.
+ *
+ * @param[in,out] k An initialized sink.
+ * @param[in] n The largest number of characters to be appended.
+ * @returns The buffer.
+ *
+ * @complexity The complexity of the callback.
+ *
+ * @since 1.0.0
+ */
+RS_API rapidstring *rs_sink_string(rs_sink *k, size_t n);
+
+/**
+ * @brief Flushes a sink if its buffer reached the high-water mark.
+ *
+ * @param[in,out] k An initialized sink.
+ *
+ * @complexity The complexity of the callback.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_sink_commit(rs_sink *k);
+
+/**
+ * @brief Appends a C string to a sink.
+ *
+ * Identicle to `rs_sink_cat_n(k, input, strlen(input))`.
+ *
+ * @param[in,out] k An initialized sink.
+ * @param[in] input The input to append.
+ *
+ * @complexity Linear in the input length.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_sink_cat(rs_sink *k, const char *input);
+
+/**
+ * @brief Appends characters to a sink.
+ *
+ * Input at least the size of the high-water mark is passed to the callback
+ * directly, after the buffer, without being copied.
+ *
+ * @param[in,out] k An initialized sink.
+ * @param[in] input The input to append.
+ * @param[in] n The input length.
+ *
+ * @complexity Linear in @n.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_sink_cat_n(rs_sink *k, const char *input, size_t n);
+
+/**
+ * @brief Appends a string to a sink.
+ *
+ * Identicle to `rs_sink_cat_n(k, rs_data_c(input), rs_len(input))`.
+ *
+ * @param[in,out] k An initialized sink.
+ * @param[in] input The string to append.
+ *
+ * @complexity Linear in the length of @input.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_sink_cat_rs(rs_sink *k, const rapidstring *input);
+
+/**
+ * @brief Appends a signed integer in decimal to a sink.
+ *
+ * @param[in,out] k An initialized sink.
+ * @param[in] value The integer.
+ *
+ * @complexity Linear in the number of digits.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_sink_cat_i64(rs_sink *k, int64_t value);
+
+/**
+ * @brief Appends an unsigned integer in decimal to a sink.
+ *
+ * @param[in,out] k An initialized sink.
+ * @param[in] value The integer.
+ *
+ * @complexity Linear in the number of digits.
+ *
+ * @since 1.0.0
+ */
+RS_API void rs_sink_cat_u64(rs_sink *k, uint64_t value);
+
+#if RS_PRINTF
+/**
+ * @brief Appends formatted characters to a sink.
+ *
+ * Identicle to `rs_sink_vprintf(k, format, args)`.
+ *
+ * @param[in,out] k An initialized sink.
+ * @param[in] format The `printf()` format.
+ * @returns The number of characters appended, or a negative value on an
+ * encoding error.
+ *
+ * @complexity Linear in the length of the output.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_sink_printf(rs_sink *k, const char *format, ...);
+
+/**
+ * @brief Appends formatted characters to a sink.
+ *
+ * The output is formatted into the room left in the buffer. Output which
+ * does not fit is formatted again once the buffer is flushed, and output
+ * larger than the whole buffer is passed to the callback directly, so the
+ * buffer never grows. Only available where rs_cat_vprintf() is.
+ *
+ * @param[in,out] k An initialized sink.
+ * @param[in] format The `printf()` format.
+ * @param[in] args The arguments of the format.
+ * @returns The number of characters appended, or a negative value on an
+ * encoding error.
+ *
+ * @complexity Linear in the length of the output.
+ *
+ * @since 1.0.0
+ */
+RS_API int rs_sink_vprintf(rs_sink *k, const char *format, va_list args);
+#endif
+
+/*
+ * ===============================================================
+ *
+ *                        COMPILED KERNELS
+ *
+ * ===============================================================
+ */
+
+/*
+ * With `RS_LIBRARY`, which the `rapidstring` CMake target defines for its
+ * users, the kernels below are called from librapidstring rather than
+ * compiled into every translation unit. The library holds a variant of each
+ * for every instruction set it was built for, and picks the best one the CPU
+ * supports once, on its first call or when the program is loaded. Every
+ * other function stays inline.
+ */
+#ifdef RS_LIBRARY
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The compiled rs_count_n().
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_count_n(const char *input, size_t n, char c);
+
+/**
+ * @brief The compiled rs_line_index_n().
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_line_index_n(const char *input, size_t n, size_t *offsets,
+			   size_t max);
+
+/**
+ * @brief The compiled rs_find_first_of_n(), which rs_cspn_n() also calls.
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_find_first_of_n(const char *input, size_t n,
+			      const rs_charset *set);
+
+/**
+ * @brief The compiled rs_find_last_of_n().
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_find_last_of_n(const char *input, size_t n,
+			     const rs_charset *set);
+
+/**
+ * @brief The compiled rs_span_n().
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_span_n(const char *input, size_t n, const rs_charset *set);
+
+/**
+ * @brief The compiled rs_count_any_n().
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_count_any_n(const char *input, size_t n, const rs_charset *set);
+
+/**
+ * @brief The compiled rs_json_escaped_len().
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_json_escaped_len(const char *input, size_t n);
+
+/**
+ * @brief The compiled rs_url_encoded_len().
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_url_encoded_len(const char *input, size_t n);
+
+/**
+ * @brief The compiled rs_html_escaped_len().
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_html_escaped_len(const char *input, size_t n);
+
+/**
+ * @brief Encodes the leading whole blocks of bytes in base64.
+ *
+ * The compiled rs_base64_encode_simd(), which encodes nothing when the CPU
+ * lacks the vector instructions.
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_base64_encode(char *output, const unsigned char *input,
+			    size_t n, int alphabet);
+
+/**
+ * @brief Decodes the leading whole blocks of base64.
+ *
+ * The compiled rs_base64_decode_simd(), which decodes nothing when the CPU
+ * lacks the vector instructions.
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_base64_decode(char *output, const char *input, size_t n);
+
+/**
+ * @brief Encodes the leading whole blocks of bytes in hexadecimal.
+ *
+ * The compiled rs_hex_encode_simd().
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_hex_encode(char *output, const unsigned char *input, size_t n);
+
+/**
+ * @brief Decodes the leading whole blocks of hexadecimal.
+ *
+ * The compiled rs_hex_decode_simd().
+ *
+ * @since 1.0.0
+ */
+size_t rs_lib_hex_decode(char *output, const char *input, size_t n);
+
+/**
+ * @brief Names the kernel variant the library picked.
+ *
+ * @returns `"avx2"` or `"baseline"`.
+ *
+ * @since 1.0.0
+ */
+const char *rs_lib_isa(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/*
+ * ===============================================================
+ *
+ *                   CONSTRUCTION & DESTRUCTION
+ *
+ * ===============================================================
+ */
+
+RS_API void rs_init(rapidstring *s)
+{
+	RS_ASSERT_PTR(s);
+
+	s->stack.buffer[0] = '\0';
+	s->stack.left = RS_STACK_CAPACITY;
+}
+
+RS_API void rs_init_w(rapidstring *s, const char *input)
+{
+	rs_init_w_n(s, input, strlen(input));
+}
+
+RS_API void rs_init_w_n(rapidstring *s, const char *input, size_t n)
+{
+	rs_init(s);
+	rs_cpy_n(s, input, n);
+}
+
+RS_API void rs_init_w_cap(rapidstring *s, size_t n)
+{
+	rs_heap_init(s, n);
+	rs_heap_resize(s, 0);
+}
+
+RS_API void rs_init_w_rs(rapidstring *s, const rapidstring *input)
+{
+	RS_DATA_SIZE(rs_init_w_n, s, input);
+}
+
+RS_API void rs_init_borrow(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	rs_init_borrow_n(s, input, strlen(input));
+}
+
+RS_API void rs_init_borrow_n(rapidstring *s, const char *input, size_t n)
+{
+	RS_ASSERT_PTR(s);
+	RS_ASSERT_PTR(input);
+	RS_CHECK_SIZE(n);
+	assert(input[n] == '\0');
+
+	/* Never written through, as every modification unborrows first. */
+	s->heap.buffer = (char*)input;
+	s->heap.size = (rs_size)n;
+	s->heap.capacity = (rs_size)n;
+	s->heap.flag = RS_BORROWED_FLAG;
+}
+
+RS_API void rs_free(rapidstring *s)
+{
+	RS_ASSERT_RS(s);
+
+	if (RS_UNLIKELY(s->heap.flag == RS_BORROWED_FLAG))
+		return;
+
+#ifdef RS_COMPRESSION
+	/* The encoding is freed like the characters, without decompressing. */
+	if (RS_UNLIKELY(s->heap.flag == RS_COMPRESSED_FLAG))
+		s->heap.flag = RS_HEAP_FLAG;
+#endif
+
+	RS_STATS_SIZE(rs_len(s));
+
+	if (RS_HEAP_LIKELY(rs_owns_heap(s))) {
+		RS_STATS_ADD(frees, 1);
+		RS_FREE(s->heap.buffer);
+	}
+}
+
+/*
+ * ===============================================================
+ *
+ *                           ASSIGNMENT
+ *
+ * ===============================================================
+ */
+
+RS_API void rs_stack_cpy(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	rs_stack_cpy_n(s, input, strlen(input));
+}
+
+RS_API void rs_stack_cpy_n(rapidstring *s, const char *input, size_t n)
+{
+	RS_ASSERT_STACK(s);
+	RS_ASSERT_PTR(input);
+	assert(RS_STACK_CAPACITY >= n);
+
+	memcpy(s->stack.buffer, input, n);
+	rs_stack_resize(s, n);
+}
+
+RS_API void rs_heap_cpy(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	rs_heap_cpy_n(s, input, strlen(input));
+}
+
+RS_API void rs_heap_cpy_n(rapidstring *s, const char *input, size_t n)
+{
+	RS_ASSERT_HEAP(s);
+	RS_ASSERT_PTR(input);
+	assert(s->heap.capacity >= n);
+
+	memcpy(s->heap.buffer, input, n);
+	rs_heap_resize(s, n);
+}
+
+RS_API void rs_cpy(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	rs_cpy_n(s, input, strlen(input));
+}
+
+RS_API void rs_cpy_n(rapidstring *s, const char *input, size_t n) {
+	RS_STATS_ADD(cpys, 1);
+
+	/* Borrowed characters are replaced rather than copied first. */
+	if (RS_UNLIKELY(s->heap.flag == RS_BORROWED_FLAG))
+		rs_init(s);
+
+	RS_DROP_COMPRESSED(s);
+
+	if (RS_HEAP_LIKELY(rs_owns_heap(s))) {
+		RS_STATS_ADD(cpy_heap, 1);
+		rs_grow_heap(s, n);
+		rs_heap_cpy_n(s, input, n);
+	} else if (RS_HEAP_LIKELY(n > RS_STACK_CAPACITY)) {
+		RS_STATS_ADD(cpy_spills, 1);
+		rs_heap_init_g(s, n);
+		rs_heap_cpy_n(s, input, n);
+	} else {
+		rs_stack_cpy_n(s, input, n);
+	}
+}
+
+RS_API void rs_cpy_rs(rapidstring *s, const rapidstring *input)
+{
+	RS_DATA_SIZE(rs_cpy_n, s, input);
+}
+
+#if RS_PRINTF
+RS_API int rs_cpy_printf(rapidstring *s, const char *format, ...)
+{
+	va_list args;
+	int ret;
+
+	va_start(args, format);
+	ret = rs_cpy_vprintf(s, format, args);
+	va_end(args);
+
+	return ret;
+}
+
+RS_API int rs_cpy_vprintf(rapidstring *s, const char *format, va_list args)
+{
+	/* Borrowed characters are replaced rather than copied first. */
+	if (RS_UNLIKELY(s->heap.flag == RS_BORROWED_FLAG))
+		rs_init(s);
+
+	RS_DROP_COMPRESSED(s);
+
+	if (RS_HEAP_LIKELY(rs_owns_heap(s)))
+		rs_heap_resize(s, 0);
+	else
+		rs_stack_resize(s, 0);
+
+	return rs_cat_vprintf(s, format, args);
+}
+#endif
+
+/*
+ * ===============================================================
+ *
+ *                            CAPACITY
+ *
+ * ===============================================================
  */
 
 RS_API int rs_empty(const rapidstring *s)
 {
-	return rs_len(s) == 0;
+	return rs_len(s) == 0;
+}
+
+RS_API size_t rs_stack_len(const rapidstring *s)
+{
+	RS_ASSERT_STACK(s);
+
+	/* Bounds every stack length, including those of the copies below. */
+	if (s->stack.left > RS_STACK_CAPACITY)
+		RS_UNREACHABLE();
+
+	return RS_STACK_CAPACITY - s->stack.left;
+}
+
+RS_API size_t rs_heap_len(const rapidstring *s)
+{
+	RS_ASSERT_HEAP(s);
+
+	return s->heap.size;
+}
+
+RS_API size_t rs_len(const rapidstring *s)
+{
+#ifdef RS_BRANCHLESS
+	const uintptr_t heap = RS_HEAP_MASK(s);
+
+	return (size_t)((s->heap.size & heap) |
+		((RS_STACK_CAPACITY - s->stack.left) & ~heap));
+#else
+	return rs_is_heap(s) ?
+		(size_t)s->heap.size :
+		rs_stack_len(s);
+#endif
+}
+
+RS_API size_t rs_capacity(const rapidstring *s)
+{
+#ifdef RS_COMPRESSION
+	/* The capacity holds the length of the encoding. */
+	if (RS_UNLIKELY(s->heap.flag == RS_COMPRESSED_FLAG))
+		return s->heap.size;
+#endif
+
+#ifdef RS_BRANCHLESS
+	const uintptr_t heap = RS_HEAP_MASK(s);
+
+	return (size_t)((s->heap.capacity & heap) |
+		(RS_STACK_CAPACITY & ~heap));
+#else
+	return rs_is_heap(s) ?
+		s->heap.capacity :
+		RS_STACK_CAPACITY;
+#endif
+}
+
+RS_API void rs_reserve(rapidstring *s, size_t n)
+{
+	rs_unborrow(s);
+
+	if (RS_HEAP_LIKELY(rs_owns_heap(s))) {
+		if (RS_LIKELY(s->heap.capacity < n))
+			rs_realloc(s, n);
+	} else {
+		rs_stack_to_heap(s, n);
+	}
+}
+
+RS_API void rs_shrink_to_fit(rapidstring *s)
+{
+	if (RS_LIKELY(rs_owns_heap(s)))
+		rs_realloc(s, rs_heap_len(s));
+}
+
+RS_API void rs_compact(rapidstring *s)
+{
+	size_t cap;
+
+	if (RS_UNLIKELY(!rs_owns_heap(s)))
+		return;
+
+	if (rs_heap_len(s) <= RS_STACK_CAPACITY) {
+		rs_heap_to_stack(s);
+	} else {
+		cap = rs_size_class(rs_heap_len(s));
+
+		if (RS_LIKELY(cap < s->heap.capacity))
+			rs_realloc(s, cap);
+	}
+}
+
+RS_API int rs_is_heap(const rapidstring *s)
+{
+	RS_ASSERT_RS(s);
+
+	return s->heap.flag >= RS_BORROWED_FLAG;
+}
+
+RS_API int rs_is_stack(const rapidstring *s)
+{
+	RS_ASSERT_RS(s);
+
+	return s->heap.flag <= RS_STACK_CAPACITY;
+}
+
+RS_API int rs_owns_heap(const rapidstring *s)
+{
+	RS_ASSERT_RS(s);
+
+	return s->heap.flag == RS_HEAP_FLAG;
+}
+
+RS_API int rs_is_borrowed(const rapidstring *s)
+{
+	RS_ASSERT_RS(s);
+
+	return s->heap.flag == RS_BORROWED_FLAG;
+}
+
+/*
+ * ===============================================================
+ *
+ *                            MODIFIERS
+ *
+ * ===============================================================
+ */
+
+RS_API char *rs_data(rapidstring *s)
+{
+	rs_unborrow(s);
+
+	return (char*)rs_data_c(s);
+}
+
+RS_API const char *rs_data_c(const rapidstring *s)
+{
+	RS_ASSERT_RS(s);
+	RS_CHECK_PLAIN(s);
+
+#ifdef RS_BRANCHLESS
+	{
+		const uintptr_t heap = RS_HEAP_MASK(s);
+
+		return (const char*)(((uintptr_t)s->heap.buffer & heap) |
+			((uintptr_t)s->stack.buffer & ~heap));
+	}
+#else
+	return rs_is_heap(s) ?
+		s->heap.buffer :
+		s->stack.buffer;
+#endif
+}
+
+RS_API void rs_stack_cat(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	rs_stack_cat_n(s, input, strlen(input));
+}
+
+RS_API void rs_stack_cat_n(rapidstring *s, const char *input, size_t n)
+{
+	size_t stack_size;
+
+	RS_ASSERT_PTR(input);
+	assert(RS_STACK_CAPACITY >= rs_stack_len(s) + n);
+
+	stack_size = rs_stack_len(s);
+	memcpy(s->stack.buffer + stack_size, input, n);
+	rs_stack_resize(s, stack_size + n);
+}
+
+RS_API void rs_heap_cat(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	rs_heap_cat_n(s, input, strlen(input));
+}
+
+RS_API void rs_heap_cat_n(rapidstring *s, const char *input, size_t n)
+{
+	RS_ASSERT_RS(s);
+	RS_ASSERT_PTR(input);
+	assert(s->heap.capacity >= s->heap.size + n);
+
+	memcpy(s->heap.buffer + rs_heap_len(s), input, n);
+	rs_heap_resize(s, rs_heap_len(s) + n);
+}
+
+RS_API void rs_cat(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	rs_cat_n(s, input, strlen(input));
+}
+
+RS_API void rs_cat_n(rapidstring *s, const char *input, size_t n)
+{
+	RS_STATS_ADD(cats, 1);
+
+	rs_unborrow(s);
+
+	if (RS_HEAP_LIKELY(rs_owns_heap(s))) {
+		RS_STATS_ADD(cat_heap, 1);
+		rs_grow_heap(s, rs_heap_len(s) + n);
+		rs_heap_cat_n(s, input, n);
+	} else if (RS_HEAP_LIKELY(s->stack.left < n)) {
+		RS_STATS_ADD(cat_spills, 1);
+		rs_stack_to_heap_g(s, n);
+		rs_heap_cat_n(s, input, n);
+	} else {
+		rs_stack_cat_n(s, input, n);
+	}
+}
+
+RS_API void rs_cat_rs(rapidstring *s, const rapidstring *input)
+{
+	RS_DATA_SIZE(rs_cat_n, s, input);
+}
+
+#if RS_PRINTF
+RS_API int rs_cat_printf(rapidstring *s, const char *format, ...)
+{
+	va_list args;
+	int ret;
+
+	va_start(args, format);
+	ret = rs_cat_vprintf(s, format, args);
+	va_end(args);
+
+	return ret;
+}
+
+RS_API int rs_cat_vprintf(rapidstring *s, const char *format, va_list args)
+{
+	size_t len;
+	va_list copy;
+	int heap;
+	int n;
+
+	RS_ASSERT_PTR(format);
+
+	rs_unborrow(s);
+	heap = rs_owns_heap(s);
+
+	RS_VA_COPY(copy, args);
+
+	/*
+	 * The available space of a heap string includes the null terminator.
+	 * A full stack string is terminated by its `left` field, which is not
+	 * part of the buffer, so only output shorter than it is written in
+	 * place.
+	 */
+	if (RS_HEAP_LIKELY(heap)) {
+		len = rs_heap_len(s);
+		n = vsnprintf(s->heap.buffer + len, s->heap.capacity - len + 1,
+			      format, copy);
+	} else {
+		len = rs_stack_len(s);
+		n = vsnprintf(s->stack.buffer + len, (size_t)s->stack.left,
+			      format, copy);
+	}
+
+	va_end(copy);
+
+	if (RS_UNLIKELY(n < 0)) {
+		if (heap)
+			rs_heap_resize(s, len);
+		else
+			rs_stack_resize(s, len);
+
+		return n;
+	}
+
+	if (RS_HEAP_LIKELY(heap)) {
+		if (RS_LIKELY(len + (size_t)n <= s->heap.capacity)) {
+			rs_heap_resize(s, len + (size_t)n);
+			return n;
+		}
+
+		rs_grow_heap(s, len + (size_t)n);
+	} else {
+		if (RS_STACK_LIKELY((size_t)n < s->stack.left)) {
+			rs_stack_resize(s, len + (size_t)n);
+			return n;
+		}
+
+		/* The truncated output overwrote the remaining capacity. */
+		rs_stack_resize(s, len);
+		rs_stack_to_heap_g(s, (size_t)n);
+	}
+
+	n = vsnprintf(s->heap.buffer + len, (size_t)n + 1, format, args);
+
+	/* The second pass may still fail, such as when out of memory. */
+	if (RS_UNLIKELY(n < 0))
+		rs_heap_resize(s, len);
+	else
+		rs_heap_resize(s, len + (size_t)n);
+
+	return n;
+}
+#endif
+
+RS_API char *rs_extend(rapidstring *s, size_t n)
+{
+	const size_t len = rs_len(s);
+
+	rs_unborrow(s);
+
+	if (RS_HEAP_LIKELY(rs_owns_heap(s))) {
+		rs_grow_heap(s, len + n);
+		rs_heap_resize(s, len + n);
+	} else if (RS_HEAP_LIKELY(s->stack.left < n)) {
+		rs_stack_to_heap_g(s, n);
+		rs_heap_resize(s, len + n);
+	} else {
+		rs_stack_resize(s, len + n);
+	}
+
+	return rs_data(s) + len;
+}
+
+RS_API void rs_truncate(rapidstring *s, size_t n)
+{
+	assert(rs_len(s) >= n);
+
+	rs_unborrow(s);
+
+	if (RS_HEAP_LIKELY(rs_owns_heap(s)))
+		rs_heap_resize(s, n);
+	else
+		rs_stack_resize(s, n);
+}
+
+RS_API void rs_steal(rapidstring *s, char *buffer)
+{
+	RS_ASSERT_PTR(buffer);
+
+	rs_steal_n(s, buffer, strlen(buffer));
+}
+
+RS_API void rs_steal_n(rapidstring *s, char *buffer, size_t n)
+{
+	RS_STATS_SIZE(rs_len(s));
+
+	/* The encoding is freed like the characters, without decompressing. */
+	RS_DROP_COMPRESSED(s);
+
+	/* Manual free as using rs_free creates an additional branch. */
+	if (RS_HEAP_LIKELY(rs_owns_heap(s))) {
+		RS_STATS_ADD(frees, 1);
+		RS_FREE(s->heap.buffer);
+	} else {
+		s->heap.flag = RS_HEAP_FLAG;
+	}
+
+	RS_CHECK_SIZE(n);
+
+	s->heap.buffer = buffer;
+	s->heap.size = (rs_size)n;
+	s->heap.capacity = (rs_size)n;
+}
+
+RS_API void rs_swap(rapidstring *a, rapidstring *b)
+{
+	rapidstring tmp;
+
+	RS_ASSERT_RS(a);
+	RS_ASSERT_RS(b);
+
+	tmp = *a;
+	*a = *b;
+	*b = tmp;
+}
+
+RS_API void rs_move(rapidstring *dst, rapidstring *src)
+{
+	RS_ASSERT_RS(src);
+	assert(dst != src);
+
+	rs_free(dst);
+	*dst = *src;
+	rs_init(src);
+}
+
+RS_API char *rs_release(rapidstring *s, size_t *len)
+{
+	char *buffer;
+
+	rs_unborrow(s);
+
+	if (!RS_HEAP_LIKELY(rs_owns_heap(s)))
+		rs_stack_to_heap(s, 0);
+
+	buffer = s->heap.buffer;
+
+	if (len)
+		*len = rs_heap_len(s);
+
+	rs_init(s);
+
+	return buffer;
+}
+
+RS_API void rs_stack_resize(rapidstring *s, size_t n)
+{
+	assert(RS_STACK_CAPACITY >= n);
+	
+	s->stack.buffer[n] = '\0';
+	s->stack.left = (unsigned char)(RS_STACK_CAPACITY - n);
+}
+
+RS_API void rs_heap_resize(rapidstring *s, size_t n)
+{
+	RS_ASSERT_HEAP(s);
+	assert(s->heap.capacity >= n);
+
+	s->heap.buffer[n] = '\0';
+	s->heap.size = (rs_size)n;
+}
+
+RS_API void rs_resize(rapidstring *s, size_t n)
+{
+	rs_unborrow(s);
+
+	if (RS_HEAP_LIKELY(rs_owns_heap(s))) {
+		if (RS_UNLIKELY(s->heap.capacity < n))
+			rs_realloc(s, n);
+
+		rs_heap_resize(s, n);
+
+#if RS_COMPACT_RATIO
+		if (RS_UNLIKELY(n < s->heap.capacity / RS_COMPACT_RATIO))
+			rs_compact(s);
+#endif
+	} else if (RS_HEAP_LIKELY(n > RS_STACK_CAPACITY)) {
+		/* The stack characters count towards the exact capacity. */
+		rs_stack_to_heap(s, n - rs_stack_len(s));
+		rs_heap_resize(s, n);
+	} else {
+		rs_stack_resize(s, n);
+	}
+}
+
+RS_API void rs_resize_w(rapidstring *s, size_t n, char c)
+{
+	size_t sz = rs_len(s);
+
+	rs_resize(s, n);
+
+	if (RS_LIKELY(sz < n)) {
+		size_t diff = n - sz;
+		memset(rs_data(s) + sz, c, diff);
+	}
+}
+
+/*
+ * ===============================================================
+ *
+ *                         HEAP OPERATIONS
+ *
+ * ===============================================================
+ */
+
+RS_API void rs_heap_init(rapidstring *s, size_t n)
+{
+	RS_CHECK_SIZE(n);
+
+	s->heap.buffer = (char*)RS_MALLOC(RS_ALLOC_SIZE(n));
+
+	RS_ASSERT_PTR(s->heap.buffer);
+	RS_STATS_ADD(allocs, 1);
+
+	s->heap.capacity = (rs_size)n;
+	s->heap.flag = RS_HEAP_FLAG;
+}
+
+RS_API size_t rs_grown(size_t n)
+{
+	const size_t limit = RS_SIZE_MAX - RS_STACK_CAPACITY;
+
+	if (RS_UNLIKELY(n > limit / RS_GROWTH_FACTOR))
+		return n > limit ? n : limit;
+
+	return n * RS_GROWTH_FACTOR;
+}
+
+RS_API void rs_heap_init_g(rapidstring *s, size_t n)
+{
+	rs_heap_init(s, rs_grown(n));
+}
+
+RS_API void rs_stack_to_heap(rapidstring *s, size_t n)
+{
+	const size_t stack_size = rs_stack_len(s);
+
+	char tmp[RS_STACK_CAPACITY];
+
+	memcpy(tmp, s->stack.buffer, stack_size);
+
+	RS_STATS_ADD(stack_to_heap, 1);
+	RS_STATS_ADD(bytes_copied, stack_size);
+
+	rs_heap_init(s, stack_size + n);
+	rs_heap_cpy_n(s, tmp, stack_size);
+}
+
+RS_API void rs_stack_to_heap_g(rapidstring *s, size_t n)
+{
+	rs_stack_to_heap(s, rs_grown(n));
+}
+
+RS_API void rs_realloc(rapidstring *s, size_t n)
+{
+	RS_CHECK_SIZE(n);
+	RS_STATS_ADD(reallocs, 1);
+	RS_STATS_ADD(bytes_copied, rs_heap_len(s));
+
+	s->heap.buffer = (char*)RS_REALLOC(s->heap.buffer, RS_ALLOC_SIZE(n));
+
+	RS_ASSERT_PTR(s->heap.buffer);
+
+	s->heap.capacity = (rs_size)n;
+}
+
+RS_API void rs_grow_heap(rapidstring *s, size_t n)
+{
+	if (RS_UNLIKELY(s->heap.capacity < n)) {
+		RS_STATS_ADD(grows, 1);
+		rs_realloc(s, rs_grown(n));
+	}
+}
+
+RS_API void rs_heap_to_stack(rapidstring *s)
+{
+	char *buffer = s->heap.buffer;
+	const size_t len = rs_heap_len(s);
+
+	RS_ASSERT_HEAP(s);
+	assert(RS_STACK_CAPACITY >= len);
+
+	RS_STATS_ADD(frees, 1);
+	RS_STATS_ADD(bytes_copied, len);
+
+	/* The buffer no longer aliases the string once its pointer is saved. */
+	memcpy(s->stack.buffer, buffer, len);
+	rs_stack_resize(s, len);
+
+	RS_FREE(buffer);
+}
+
+RS_API size_t rs_size_class(size_t n)
+{
+	size_t cap = 1;
+
+	while (cap < n)
+		cap = cap * 2 + 1;
+
+	return cap;
+}
+
+RS_API void rs_unborrow(rapidstring *s)
+{
+	const char *input;
+	size_t n;
+
+#ifdef RS_COMPRESSION
+	if (RS_UNLIKELY(s->heap.flag == RS_COMPRESSED_FLAG)) {
+		rs_decompress(s);
+		return;
+	}
+#endif
+
+	if (RS_LIKELY(s->heap.flag != RS_BORROWED_FLAG))
+		return;
+
+	input = s->heap.buffer;
+	n = s->heap.size;
+
+	rs_init_w_n(s, input, n);
+}
+
+/*
+ * ===============================================================
+ *
+ *                          SERIALIZATION
+ *
+ * ===============================================================
+ */
+
+#if RS_POSIX
+
+RS_API int rs_serialize(int fd, const rapidstring *arr, size_t n)
+{
+	rs_table_header header;
+	rapidstring buf;
+	uint64_t offset = 0;
+	size_t i;
+	int ret = 0;
+
+	assert(n == 0 || arr != NULL);
+
+	memcpy(header.magic, RS_TABLE_MAGIC, sizeof(header.magic));
+	header.endian = RS_TABLE_ENDIAN;
+	header.count = n;
+
+	rs_init_w_cap(&buf, RS_TABLE_BUFFER_SIZE);
+	rs_heap_cat_n(&buf, (const char*)&header, sizeof(header));
+
+	/* The offsets include the end of the last string. */
+	for (i = 0; ret == 0 && i <= n; i++) {
+		if (RS_UNLIKELY(rs_heap_len(&buf) + sizeof(offset) >
+				RS_TABLE_BUFFER_SIZE)) {
+			ret = rs_write_all(fd, buf.heap.buffer, rs_heap_len(&buf));
+			rs_heap_resize(&buf, 0);
+		}
+
+		rs_heap_cat_n(&buf, (const char*)&offset, sizeof(offset));
+
+		if (RS_LIKELY(i < n))
+			offset += rs_len(&arr[i]) + 1;
+	}
+
+	for (i = 0; ret == 0 && i < n; i++) {
+		/* Rapidstrings are always null terminated. */
+		const size_t len = rs_len(&arr[i]) + 1;
+
+		if (RS_UNLIKELY(rs_heap_len(&buf) + len > RS_TABLE_BUFFER_SIZE)) {
+			ret = rs_write_all(fd, buf.heap.buffer, rs_heap_len(&buf));
+			rs_heap_resize(&buf, 0);
+		}
+
+		if (RS_UNLIKELY(len > RS_TABLE_BUFFER_SIZE)) {
+			if (ret == 0)
+				ret = rs_write_all(fd, rs_data_c(&arr[i]), len);
+		} else {
+			rs_heap_cat_n(&buf, rs_data_c(&arr[i]), len);
+		}
+	}
+
+	if (RS_LIKELY(ret == 0))
+		ret = rs_write_all(fd, buf.heap.buffer, rs_heap_len(&buf));
+
+	rs_free(&buf);
+
+	return ret;
+}
+
+RS_API int rs_table_open(rs_table *t, const char *path)
+{
+	struct stat st;
+	int fd;
+
+	RS_ASSERT_PTR(t);
+	RS_ASSERT_PTR(path);
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+
+	if (RS_UNLIKELY(fd == -1))
+		return -1;
+
+	if (RS_UNLIKELY(fstat(fd, &st) == -1)) {
+		close(fd);
+		return -1;
+	}
+
+	if (RS_UNLIKELY((size_t)st.st_size < sizeof(rs_table_header))) {
+		close(fd);
+		errno = EINVAL;
+		return -1;
+	}
+
+	t->map_size = (size_t)st.st_size;
+	t->map = mmap(NULL, t->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	/* The mapping keeps its own reference to the file. */
+	close(fd);
+
+	if (RS_UNLIKELY(t->map == MAP_FAILED))
+		return -1;
+
+	if (RS_UNLIKELY(!rs_table_valid(t))) {
+		munmap(t->map, t->map_size);
+		errno = EINVAL;
+		return -1;
+	}
+
+	return 0;
+}
+
+RS_API void rs_table_close(rs_table *t)
+{
+	RS_ASSERT_PTR(t);
+
+	munmap(t->map, t->map_size);
+}
+
+RS_API size_t rs_table_count(const rs_table *t)
+{
+	RS_ASSERT_PTR(t);
+
+	return t->count;
+}
+
+RS_API const char *rs_table_at(const rs_table *t, size_t i, size_t *len)
+{
+	size_t begin;
+	size_t end;
+
+	RS_ASSERT_PTR(t);
+	assert(i < t->count);
+
+	begin = (size_t)t->offsets[i];
+	end = (size_t)t->offsets[i + 1] - 1;
+
+	/* Only a corrupted table lacks the terminator. */
+	if (RS_UNLIKELY(t->data[end] != '\0'))
+		return NULL;
+
+	if (len)
+		*len = end - begin;
+
+	return t->data + begin;
+}
+
+RS_API int rs_write_all(int fd, const void *input, size_t n)
+{
+	const char *p = (const char*)input;
+
+	while (n > 0) {
+		const ssize_t written = write(fd, p, n);
+
+		if (RS_UNLIKELY(written == -1)) {
+			if (errno == EINTR)
+				continue;
+
+			return -1;
+		}
+
+		p += written;
+		n -= (size_t)written;
+	}
+
+	return 0;
+}
+
+RS_API int rs_table_valid(rs_table *t)
+{
+	const rs_table_header *header = (const rs_table_header*)t->map;
+	const size_t max_count = (t->map_size - sizeof(rs_table_header)) /
+		sizeof(uint64_t);
+	size_t data_size;
+	size_t i;
+
+	if (memcmp(header->magic, RS_TABLE_MAGIC, sizeof(header->magic)) != 0 ||
+	    header->endian != RS_TABLE_ENDIAN ||
+	    header->count >= max_count)
+		return 0;
+
+	t->count = (size_t)header->count;
+	t->offsets = (const uint64_t*)(header + 1);
+	t->data = (const char*)(t->offsets + t->count + 1);
+	data_size = t->map_size - (size_t)(t->data - (const char*)t->map);
+
+	if (t->offsets[0] != 0 || t->offsets[t->count] != data_size)
+		return 0;
+
+	for (i = 0; i < t->count; i++)
+		if (t->offsets[i] >= t->offsets[i + 1])
+			return 0;
+
+	/*
+	 * Checking every terminator would fault in the whole file. The last
+	 * byte being a terminator is enough to keep any C string read of the
+	 * data within the mapping, and rs_table_at() checks the terminator of
+	 * each string it returns.
+	 */
+	return t->count == 0 || t->data[data_size - 1] == '\0';
+}
+
+#endif /* RS_POSIX */
+
+/*
+ * ===============================================================
+ *
+ *                           STATISTICS
+ *
+ * ===============================================================
+ */
+
+#ifdef RS_STATS
+
+RS_API void rs_stats_snapshot(rs_stats *stats)
+{
+	const rs_stats_block *block;
+
+	RS_ASSERT_PTR(stats);
+
+	pthread_mutex_lock(&rs_stats_lock);
+
+	memcpy(stats, &rs_stats_all.retired, sizeof(rs_stats));
+
+	for (block = rs_stats_all.head; block; block = block->next)
+		rs_stats_since(stats, block);
+
+	pthread_mutex_unlock(&rs_stats_lock);
+}
+
+RS_API void rs_stats_reset(void)
+{
+	rs_stats_block *block;
+	size_t i;
+
+	pthread_mutex_lock(&rs_stats_lock);
+
+	memset(&rs_stats_all.retired, 0, sizeof(rs_stats));
+
+	for (block = rs_stats_all.head; block; block = block->next) {
+		const size_t *counters = (const size_t*)&block->stats;
+		size_t *base = (size_t*)&block->base;
+
+		for (i = 0; i < sizeof(rs_stats) / sizeof(size_t); i++)
+			base[i] = RS_LOAD_RELAXED(&counters[i]);
+	}
+
+	pthread_mutex_unlock(&rs_stats_lock);
+}
+
+RS_API void rs_stats_merge(rs_stats *stats, const rs_stats *input)
+{
+	size_t i;
+
+	RS_ASSERT_PTR(stats);
+	RS_ASSERT_PTR(input);
+
+	stats->allocs += input->allocs;
+	stats->reallocs += input->reallocs;
+	stats->frees += input->frees;
+	stats->grows += input->grows;
+	stats->stack_to_heap += input->stack_to_heap;
+	stats->bytes_copied += input->bytes_copied;
+	stats->cats += input->cats;
+	stats->cat_heap += input->cat_heap;
+	stats->cat_spills += input->cat_spills;
+	stats->cpys += input->cpys;
+	stats->cpy_heap += input->cpy_heap;
+	stats->cpy_spills += input->cpy_spills;
+
+	for (i = 0; i < RS_STATS_BUCKETS; i++)
+		stats->sizes[i] += input->sizes[i];
+}
+
+RS_API int rs_stats_dump(FILE *f, const rs_stats *stats)
+{
+	size_t i;
+	int ret;
+
+	RS_ASSERT_PTR(f);
+	RS_ASSERT_PTR(stats);
+
+	ret = fprintf(f,
+		"stack_capacity %lu\n"
+		"growth_factor %lu\n"
+		"average_size %lu\n"
+		"allocs %lu\n"
+		"reallocs %lu\n"
+		"frees %lu\n"
+		"grows %lu\n"
+		"stack_to_heap %lu\n"
+		"bytes_copied %lu\n"
+		"cats %lu\n"
+		"cat_heap %lu\n"
+		"cat_spills %lu\n"
+		"cpys %lu\n"
+		"cpy_heap %lu\n"
+		"cpy_spills %lu\n",
+		(unsigned long)RS_STACK_CAPACITY,
+		(unsigned long)RS_GROWTH_FACTOR,
+		(unsigned long)RS_AVERAGE_SIZE,
+		(unsigned long)stats->allocs,
+		(unsigned long)stats->reallocs,
+		(unsigned long)stats->frees,
+		(unsigned long)stats->grows,
+		(unsigned long)stats->stack_to_heap,
+		(unsigned long)stats->bytes_copied,
+		(unsigned long)stats->cats,
+		(unsigned long)stats->cat_heap,
+		(unsigned long)stats->cat_spills,
+		(unsigned long)stats->cpys,
+		(unsigned long)stats->cpy_heap,
+		(unsigned long)stats->cpy_spills);
+
+	for (i = 0; ret >= 0 && i < RS_STATS_BUCKETS; i++)
+		if (stats->sizes[i])
+			ret = fprintf(f, "size %lu %lu\n", (unsigned long)i,
+				      (unsigned long)stats->sizes[i]);
+
+	return ret < 0 ? ret : 0;
+}
+
+RS_API void rs_stats_add(size_t *counter, size_t n)
+{
+	/* Only this thread writes the counter, so it reads it plainly. */
+	RS_STORE_RELAXED(counter, *counter + n);
+}
+
+RS_API void rs_stats_since(rs_stats *stats, const rs_stats_block *block)
+{
+	const size_t *counters = (const size_t*)&block->stats;
+	const size_t *base = (const size_t*)&block->base;
+	size_t *sum = (size_t*)stats;
+	size_t i;
+
+	for (i = 0; i < sizeof(rs_stats) / sizeof(size_t); i++)
+		sum[i] += RS_LOAD_RELAXED(&counters[i]) - base[i];
+}
+
+RS_API rs_stats *rs_stats_local(void)
+{
+	if (RS_UNLIKELY(!rs_stats_tls.linked))
+		rs_stats_link();
+
+	return &rs_stats_tls.stats;
+}
+
+RS_API void rs_stats_link(void)
+{
+	pthread_mutex_lock(&rs_stats_lock);
+
+	/* Created on first use, as there is no initialization function. */
+	if (RS_UNLIKELY(!rs_stats_all.keyed))
+		rs_stats_all.keyed = pthread_key_create(&rs_stats_all.key,
+							rs_stats_unlink) == 0;
+
+	rs_stats_tls.next = rs_stats_all.head;
+	rs_stats_all.head = &rs_stats_tls;
+	rs_stats_tls.linked = 1;
+
+	pthread_mutex_unlock(&rs_stats_lock);
+
+	/* A thread recording while it exits is linked and unlinked again. */
+	if (RS_LIKELY(rs_stats_all.keyed))
+		pthread_setspecific(rs_stats_all.key, &rs_stats_tls);
+}
+
+RS_API void rs_stats_unlink(void *block)
+{
+	rs_stats_block *b = (rs_stats_block*)block;
+	rs_stats_block **link;
+
+	pthread_mutex_lock(&rs_stats_lock);
+
+	for (link = &rs_stats_all.head; *link != b; link = &(*link)->next)
+		;
+
+	*link = b->next;
+	b->linked = 0;
+	rs_stats_since(&rs_stats_all.retired, b);
+	memset(&b->stats, 0, sizeof(rs_stats));
+	memset(&b->base, 0, sizeof(rs_stats));
+
+	pthread_mutex_unlock(&rs_stats_lock);
+}
+
+RS_API size_t rs_stats_bucket(size_t n)
+{
+#if RS_GCC_VERSION > 30400
+	return n == 0 ? 0 :
+		sizeof(unsigned long long) * 8 - (size_t)__builtin_clzll(n);
+#else
+	size_t bucket = 0;
+
+	while (n) {
+		n >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+#endif
+}
+
+#endif /* RS_STATS */
+
+/*
+ * ===============================================================
+ *
+ *                             SEARCH
+ *
+ * ===============================================================
+ */
+
+RS_API void rs_charset_init(rs_charset *set, const char *chars)
+{
+	RS_ASSERT_PTR(chars);
+
+	rs_charset_init_n(set, chars, strlen(chars));
+}
+
+RS_API void rs_charset_init_n(rs_charset *set, const char *chars, size_t n)
+{
+	unsigned char buckets[16];
+	size_t distinct = 0;
+	size_t ranges = 0;
+	size_t i;
+
+	RS_ASSERT_PTR(set);
+	assert(n == 0 || chars != NULL);
+
+	memset(set, 0, sizeof(rs_charset));
+	memset(buckets, 0, sizeof(buckets));
+
+	for (i = 0; i < n; i++) {
+		const unsigned char c = (unsigned char)chars[i];
+
+		set->bitmap[c >> 3] |= (unsigned char)(1 << (c & 7));
+	}
+
+	/* Each high nibble covers two bytes of the bitmap. */
+	for (i = 0; i < 16; i++)
+		if (set->bitmap[i * 2] | set->bitmap[i * 2 + 1])
+			buckets[i] = (unsigned char)(1 << (distinct++ & 7));
+
+	for (i = 0; i < 16; i++)
+		if (distinct > 8 && buckets[i])
+			buckets[i] = (unsigned char)(1 << (i & 7));
+
+	for (i = 0; i < 256; i++) {
+		if (!rs_charset_has(set, (char)i))
+			continue;
+
+		set->lo[i & 15] |= buckets[i >> 4];
+		set->hi[i >> 4] = buckets[i >> 4];
+
+		if (i > 0 && rs_charset_has(set, (char)(i - 1))) {
+			if (ranges <= RS_CHARSET_RANGES)
+				set->ranges[ranges - 1][1]++;
+		} else if (++ranges <= RS_CHARSET_RANGES) {
+			set->ranges[ranges - 1][0] = (unsigned char)i;
+		}
+	}
+
+	set->range_count = ranges <= RS_CHARSET_RANGES ? (int)ranges : 0;
+	set->nibble_exact = distinct <= 8;
+	set->ranges_exact = ranges <= RS_CHARSET_RANGES;
+}
+
+RS_API int rs_charset_has(const rs_charset *set, char c)
+{
+	const unsigned char u = (unsigned char)c;
+
+	return (set->bitmap[u >> 3] >> (u & 7)) & 1;
+}
+
+RS_API size_t rs_find_first_of(const rapidstring *s, const rs_charset *set)
+{
+	return rs_find_first_of_n(rs_data_c(s), rs_len(s), set);
+}
+
+RS_API size_t rs_find_first_of_n(const char *input, size_t n,
+				 const rs_charset *set)
+{
+#ifdef RS_LIBRARY
+	return rs_lib_find_first_of_n(input, n, set);
+#else
+	size_t i = 0;
+
+	RS_ASSERT_PTR(set);
+	assert(n == 0 || input != NULL);
+
+#if RS_AVX2
+	for (; i + 32 <= n; i += 32) {
+		uint32_t mask = rs_charset_mask32(set, input + i);
+
+		for (; mask; mask &= mask - 1) {
+			const size_t pos = i + rs_ctz(mask);
+
+			if (RS_LIKELY(RS_CHARSET_EXACT(set)) ||
+			    rs_charset_has(set, input[pos]))
+				return pos;
+		}
+	}
+#endif
+
+#if RS_SSE2
+	for (; i + 16 <= n; i += 16) {
+		uint32_t mask = rs_charset_mask16(set, input + i);
+
+		for (; mask; mask &= mask - 1) {
+			const size_t pos = i + rs_ctz(mask);
+
+			if (RS_LIKELY(RS_CHARSET_EXACT(set)) ||
+			    rs_charset_has(set, input[pos]))
+				return pos;
+		}
+	}
+#endif
+
+	for (; i < n; i++)
+		if (rs_charset_has(set, input[i]))
+			return i;
+
+	return RS_NPOS;
+#endif
+}
+
+RS_API size_t rs_find_last_of(const rapidstring *s, const rs_charset *set)
+{
+	return rs_find_last_of_n(rs_data_c(s), rs_len(s), set);
+}
+
+RS_API size_t rs_find_last_of_n(const char *input, size_t n,
+				const rs_charset *set)
+{
+#ifdef RS_LIBRARY
+	return rs_lib_find_last_of_n(input, n, set);
+#else
+	size_t i = n;
+
+	RS_ASSERT_PTR(set);
+	assert(n == 0 || input != NULL);
+
+#if RS_AVX2
+	for (; i >= 32; i -= 32) {
+		uint32_t mask = rs_charset_mask32(set, input + i - 32);
+
+		while (mask) {
+			const unsigned bit = 31 - rs_clz(mask);
+			const size_t pos = i - 32 + bit;
+
+			if (RS_LIKELY(RS_CHARSET_EXACT(set)) ||
+			    rs_charset_has(set, input[pos]))
+				return pos;
+
+			mask &= ~((uint32_t)1 << bit);
+		}
+	}
+#endif
+
+#if RS_SSE2
+	for (; i >= 16; i -= 16) {
+		uint32_t mask = rs_charset_mask16(set, input + i - 16);
+
+		while (mask) {
+			const unsigned bit = 31 - rs_clz(mask);
+			const size_t pos = i - 16 + bit;
+
+			if (RS_LIKELY(RS_CHARSET_EXACT(set)) ||
+			    rs_charset_has(set, input[pos]))
+				return pos;
+
+			mask &= ~((uint32_t)1 << bit);
+		}
+	}
+#endif
+
+	while (i > 0)
+		if (rs_charset_has(set, input[--i]))
+			return i;
+
+	return RS_NPOS;
+#endif
+}
+
+RS_API size_t rs_span(const rapidstring *s, const rs_charset *set)
+{
+	return rs_span_n(rs_data_c(s), rs_len(s), set);
+}
+
+RS_API size_t rs_span_n(const char *input, size_t n, const rs_charset *set)
+{
+#ifdef RS_LIBRARY
+	return rs_lib_span_n(input, n, set);
+#else
+	size_t i = 0;
+
+	RS_ASSERT_PTR(set);
+	assert(n == 0 || input != NULL);
+
+	/*
+	 * A false positive of the nibble tables would end the span too late,
+	 * therefore inexact sets are only searched with the bitmap.
+	 */
+	if (RS_LIKELY(RS_CHARSET_EXACT(set))) {
+#if RS_AVX2
+		for (; i + 32 <= n; i += 32) {
+			const uint32_t mask = ~rs_charset_mask32(set, input + i);
+
+			if (mask)
+				return i + rs_ctz(mask);
+		}
+#endif
+
+#if RS_SSE2
+		for (; i + 16 <= n; i += 16) {
+			const uint32_t mask =
+				~rs_charset_mask16(set, input + i) & 0xFFFF;
+
+			if (mask)
+				return i + rs_ctz(mask);
+		}
+#endif
+	}
+
+	for (; i < n; i++)
+		if (!rs_charset_has(set, input[i]))
+			return i;
+
+	return n;
+#endif
+}
+
+RS_API size_t rs_cspn(const rapidstring *s, const rs_charset *set)
+{
+	return rs_cspn_n(rs_data_c(s), rs_len(s), set);
+}
+
+RS_API size_t rs_cspn_n(const char *input, size_t n, const rs_charset *set)
+{
+	const size_t pos = rs_find_first_of_n(input, n, set);
+
+	return pos == RS_NPOS ? n : pos;
+}
+
+RS_API unsigned rs_ctz(uint32_t n)
+{
+	assert(n != 0);
+
+#if RS_GCC_VERSION > 30400
+	return (unsigned)__builtin_ctz(n);
+#elif defined(_MSC_VER)
+	{
+		unsigned long i;
+		_BitScanForward(&i, n);
+		return (unsigned)i;
+	}
+#else
+	{
+		unsigned i = 0;
+
+		for (; !(n & 1); n >>= 1)
+			i++;
+
+		return i;
+	}
+#endif
+}
+
+RS_API unsigned rs_clz(uint32_t n)
+{
+	assert(n != 0);
+
+#if RS_GCC_VERSION > 30400
+	return (unsigned)__builtin_clz(n);
+#elif defined(_MSC_VER)
+	{
+		unsigned long i;
+		_BitScanReverse(&i, n);
+		return 31 - (unsigned)i;
+	}
+#else
+	{
+		unsigned i = 0;
+
+		for (; !(n & 0x80000000UL); n <<= 1)
+			i++;
+
+		return i;
+	}
+#endif
+}
+
+RS_API unsigned rs_popcount(uint32_t n)
+{
+#if RS_GCC_VERSION > 30400
+	return (unsigned)__builtin_popcount(n);
+#else
+	n = n - (n >> 1 & 0x55555555UL);
+	n = (n & 0x33333333UL) + (n >> 2 & 0x33333333UL);
+	n = (n + (n >> 4)) & 0x0F0F0F0FUL;
+
+	return (unsigned)((n * 0x01010101UL) >> 24 & 0xFF);
+#endif
+}
+
+#if RS_SSSE3
+RS_API uint32_t rs_charset_mask16(const rs_charset *set, const char *input)
+{
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	const __m128i v = _mm_loadu_si128((const __m128i*)input);
+	const __m128i lo = _mm_shuffle_epi8(
+		_mm_loadu_si128((const __m128i*)set->lo),
+		_mm_and_si128(v, nibble));
+	const __m128i hi = _mm_shuffle_epi8(
+		_mm_loadu_si128((const __m128i*)set->hi),
+		_mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+	const __m128i none = _mm_cmpeq_epi8(_mm_and_si128(lo, hi),
+					    _mm_setzero_si128());
+
+	return ~(uint32_t)_mm_movemask_epi8(none) & 0xFFFF;
+}
+#elif RS_SSE2
+RS_API uint32_t rs_charset_mask16(const rs_charset *set, const char *input)
+{
+	const __m128i v = _mm_loadu_si128((const __m128i*)input);
+	__m128i any = _mm_setzero_si128();
+	int i;
+
+	if (RS_UNLIKELY(!set->ranges_exact))
+		return 0xFFFF;
+
+	/* A member is at most the length of its range past the first. */
+	for (i = 0; i < set->range_count; i++) {
+		const __m128i first = _mm_set1_epi8((char)set->ranges[i][0]);
+		const __m128i len = _mm_set1_epi8((char)set->ranges[i][1]);
+		const __m128i past = _mm_subs_epu8(_mm_sub_epi8(v, first), len);
+
+		any = _mm_or_si128(any, _mm_cmpeq_epi8(past,
+						       _mm_setzero_si128()));
+	}
+
+	return (uint32_t)_mm_movemask_epi8(any);
+}
+#endif
+
+#if RS_AVX2
+RS_API uint32_t rs_charset_mask32(const rs_charset *set, const char *input)
+{
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+	const __m256i v = _mm256_loadu_si256((const __m256i*)input);
+	const __m256i lo = _mm256_shuffle_epi8(
+		_mm256_broadcastsi128_si256(
+			_mm_loadu_si128((const __m128i*)set->lo)),
+		_mm256_and_si256(v, nibble));
+	const __m256i hi = _mm256_shuffle_epi8(
+		_mm256_broadcastsi128_si256(
+			_mm_loadu_si128((const __m128i*)set->hi)),
+		_mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+	const __m256i none = _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi),
+					       _mm256_setzero_si256());
+
+	return ~(uint32_t)_mm256_movemask_epi8(none);
+}
+#endif
+
+RS_API uint32_t rs_charset_block(const rs_charset *set, const char *input,
+				 size_t n, size_t *width)
+{
+	uint32_t mask = 0;
+	size_t i;
+
+	assert(n != 0);
+
+#if RS_AVX2
+	if (RS_LIKELY(n >= 32)) {
+		*width = 32;
+		mask = rs_charset_mask32(set, input);
+	} else
+#endif
+#if RS_SSE2
+	if (RS_LIKELY(n >= 16)) {
+		*width = 16;
+		mask = rs_charset_mask16(set, input);
+	} else
+#endif
+	{
+		const size_t w = n < 32 ? n : 32;
+
+		for (i = 0; i < w; i++)
+			mask |= (uint32_t)rs_charset_has(set, input[i]) << i;
+
+		*width = w;
+
+		return mask;
+	}
+
+	if (RS_UNLIKELY(!RS_CHARSET_EXACT(set))) {
+		uint32_t candidates = mask;
+
+		for (; candidates; candidates &= candidates - 1) {
+			const unsigned bit = rs_ctz(candidates);
+
+			if (!rs_charset_has(set, input[bit]))
+				mask &= ~((uint32_t)1 << bit);
+		}
+	}
+
+	return mask;
+}
+
+RS_API size_t rs_count(const rapidstring *s, char c)
+{
+	return rs_count_n(rs_data_c(s), rs_len(s), c);
+}
+
+RS_API size_t rs_count_n(const char *input, size_t n, char c)
+{
+#ifdef RS_LIBRARY
+	return rs_lib_count_n(input, n, c);
+#else
+	size_t count = 0;
+	size_t i = 0;
+
+	assert(n == 0 || input != NULL);
+
+#if RS_AVX2
+	{
+		const __m256i needle = _mm256_set1_epi8(c);
+		__m256i total = _mm256_setzero_si256();
+		uint64_t lanes[4];
+
+		while (i + 32 <= n) {
+			/* Byte counters are summed before they can overflow. */
+			const size_t end = n - i > 32 * 255 ? i + 32 * 255 : n;
+			__m256i bytes = _mm256_setzero_si256();
+
+			for (; i + 32 <= end; i += 32)
+				bytes = _mm256_sub_epi8(bytes,
+					_mm256_cmpeq_epi8(_mm256_loadu_si256(
+						(const __m256i*)(input + i)),
+						needle));
+
+			total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes,
+				_mm256_setzero_si256()));
+		}
+
+		_mm256_storeu_si256((__m256i*)lanes, total);
+		count += (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+	}
+#endif
+
+#if RS_SSE2
+	{
+		const __m128i needle = _mm_set1_epi8(c);
+		__m128i total = _mm_setzero_si128();
+		uint64_t lanes[2];
+
+		while (i + 16 <= n) {
+			const size_t end = n - i > 16 * 255 ? i + 16 * 255 : n;
+			__m128i bytes = _mm_setzero_si128();
+
+			for (; i + 16 <= end; i += 16)
+				bytes = _mm_sub_epi8(bytes,
+					_mm_cmpeq_epi8(_mm_loadu_si128(
+						(const __m128i*)(input + i)),
+						needle));
+
+			total = _mm_add_epi64(total, _mm_sad_epu8(bytes,
+				_mm_setzero_si128()));
+		}
+
+		_mm_storeu_si128((__m128i*)lanes, total);
+		count += (size_t)(lanes[0] + lanes[1]);
+	}
+#endif
+
+	for (; i < n; i++)
+		count += input[i] == c;
+
+	return count;
+#endif
+}
+
+RS_API size_t rs_count_any(const rapidstring *s, const rs_charset *set)
+{
+	return rs_count_any_n(rs_data_c(s), rs_len(s), set);
+}
+
+RS_API size_t rs_count_any_n(const char *input, size_t n,
+			     const rs_charset *set)
+{
+#ifdef RS_LIBRARY
+	return rs_lib_count_any_n(input, n, set);
+#else
+	size_t count = 0;
+	size_t width;
+	size_t i;
+
+	RS_ASSERT_PTR(set);
+	assert(n == 0 || input != NULL);
+
+	for (i = 0; i < n; i += width)
+		count += rs_popcount(rs_charset_block(set, input + i, n - i,
+						      &width));
+
+	return count;
+#endif
+}
+
+RS_API size_t rs_line_index(const rapidstring *s, size_t *offsets,
+			    size_t max)
+{
+	return rs_line_index_n(rs_data_c(s), rs_len(s), offsets, max);
+}
+
+RS_API size_t rs_line_index_n(const char *input, size_t n, size_t *offsets,
+			      size_t max)
+{
+#ifdef RS_LIBRARY
+	return rs_lib_line_index_n(input, n, offsets, max);
+#else
+	size_t count = 0;
+	size_t i = 0;
+
+	assert(n == 0 || input != NULL);
+	assert(max == 0 || offsets != NULL);
+
+#if RS_AVX2
+	{
+		const __m256i newline = _mm256_set1_epi8('\n');
+
+		for (; i + 32 <= n; i += 32) {
+			const uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+				_mm256_cmpeq_epi8(_mm256_loadu_si256(
+					(const __m256i*)(input + i)), newline));
+
+			if (mask)
+				count = rs_mask_offsets(mask, i, offsets,
+							count, max);
+		}
+	}
+#endif
+
+#if RS_SSE2
+	{
+		const __m128i newline = _mm_set1_epi8('\n');
+
+		for (; i + 16 <= n; i += 16) {
+			const uint32_t mask = (uint32_t)_mm_movemask_epi8(
+				_mm_cmpeq_epi8(_mm_loadu_si128(
+					(const __m128i*)(input + i)), newline));
+
+			if (mask)
+				count = rs_mask_offsets(mask, i, offsets,
+							count, max);
+		}
+	}
+#endif
+
+	for (; i < n; i++)
+		if (input[i] == '\n') {
+			if (RS_LIKELY(count < max))
+				offsets[count] = i;
+
+			count++;
+		}
+
+	return count;
+#endif
+}
+
+RS_API size_t rs_mask_offsets(uint32_t mask, size_t base, size_t *offsets,
+			      size_t count, size_t max)
+{
+	/* A whole block of positions fits without checking each one. */
+	if (RS_LIKELY(count <= max && max - count >= 32)) {
+		for (; mask; mask &= mask - 1)
+			offsets[count++] = base + rs_ctz(mask);
+
+		return count;
+	}
+
+	for (; mask; mask &= mask - 1) {
+		if (count < max)
+			offsets[count] = base + rs_ctz(mask);
+
+		count++;
+	}
+
+	return count;
+}
+
+/*
+ * ===============================================================
+ *
+ *                            MATCHING
+ *
+ * ===============================================================
+ */
+
+RS_API void rs_matcher_init(rs_matcher *m, const rapidstring *patterns,
+			    size_t n)
+{
+	unsigned char used[256];
+	unsigned char first[256];
+	size_t max_states = 1;
+	size_t states = 1;
+	size_t distinct = 0;
+	size_t firsts = 0;
+	size_t head = 0;
+	size_t tail = 0;
+	size_t classes;
+	size_t i;
+	size_t j;
+	uint32_t *fail;
+	uint32_t *queue;
+	uint32_t *map;
+	uint32_t *next;
+	uint32_t *emit;
+	uint32_t id;
+
+	RS_ASSERT_PTR(m);
+	assert(n == 0 || patterns != NULL);
+
+	memset(used, 0, sizeof(used));
+
+	for (i = 0; i < n; i++) {
+		const unsigned char *p =
+			(const unsigned char*)rs_data_c(&patterns[i]);
+		const size_t len = rs_len(&patterns[i]);
+
+		for (j = 0; j < len; j++)
+			used[p[j]] = 1;
+
+		if (len > 0 && !memchr(first, p[0], firsts))
+			first[firsts++] = p[0];
+
+		if (RS_UNLIKELY(len > 0xFFFFFFFFUL - max_states))
+			abort();
+
+		max_states += len;
+	}
+
+	for (i = 0; i < 256; i++)
+		distinct += used[i];
+
+	/* Characters which appear in no pattern always lead to the root. */
+	if (distinct == 256) {
+		for (i = 0; i < 256; i++)
+			m->classes[i] = (unsigned char)i;
+
+		classes = 256;
+	} else {
+		classes = 1;
+
+		for (i = 0; i < 256; i++)
+			m->classes[i] = used[i] ? (unsigned char)classes++ : 0;
+	}
+
+	m->class_count = classes;
+
+	/*
+	 * The state ids are premultiplied by the number of classes in 32 bits,
+	 * and the arrays hold `classes + 4` entries per state.
+	 */
+	if (RS_UNLIKELY(n > 0xFFFFFFFFUL ||
+			max_states > 0xFFFFFFFFUL / (classes + 4) ||
+			max_states > (size_t)-1 / sizeof(uint32_t) /
+				     (classes + 4)))
+		abort();
+
+	/*
+	 * The arrays are sized for the worst case of a trie without shared
+	 * prefixes, until the states are counted.
+	 */
+	m->next = (uint32_t*)RS_MALLOC(max_states * (classes + 4) *
+				       sizeof(uint32_t));
+	fail = (uint32_t*)RS_MALLOC(max_states * 2 * sizeof(uint32_t));
+
+	RS_ASSERT_PTR(m->next);
+	RS_ASSERT_PTR(fail);
+
+	queue = fail + max_states;
+
+	memset(m->next, 0, max_states * (classes + 4) * sizeof(uint32_t));
+
+	m->emit = m->next + max_states * classes;
+	m->dict = m->emit + max_states;
+	m->depth = m->dict + max_states;
+	m->pattern = m->depth + max_states;
+
+	/* Build the trie, marking the states which end a pattern. */
+	for (i = 0; i < n; i++) {
+		const unsigned char *p =
+			(const unsigned char*)rs_data_c(&patterns[i]);
+		const size_t len = rs_len(&patterns[i]);
+		uint32_t state = 0;
+
+		for (j = 0; j < len; j++) {
+			uint32_t *t = &m->next[state * classes +
+					       m->classes[p[j]]];
+
+			if (!*t) {
+				*t = (uint32_t)states++;
+				m->depth[*t] = m->depth[state] + 1;
+			}
+
+			state = *t;
+		}
+
+		if (len > 0 && !m->emit[state]) {
+			m->emit[state] = state;
+			m->pattern[state] = (uint32_t)i;
+		}
+	}
+
+	/*
+	 * Resolve the failure links breadth first, so the links of shallower
+	 * states are complete when a state is reached. Missing transitions
+	 * take the transition of the failure state, leaving a full table.
+	 */
+	queue[tail++] = 0;
+	fail[0] = 0;
+
+	while (head < tail) {
+		const uint32_t state = queue[head++];
+		uint32_t *row = &m->next[state * classes];
+
+		for (j = 0; j < classes; j++) {
+			const uint32_t child = row[j];
+
+			if (!child) {
+				if (state != 0)
+					row[j] = m->next[fail[state] *
+							 classes + j];
+
+				continue;
+			}
+
+			fail[child] = state == 0 ? 0 :
+				m->next[fail[state] * classes + j];
+			m->dict[child] = m->emit[fail[child]];
+
+			if (!m->emit[child])
+				m->emit[child] = m->dict[child];
+
+			queue[tail++] = child;
+		}
+	}
+
+	/*
+	 * Renumber the states in breadth first order, keeping the frequently
+	 * visited shallow states together, with the states ending a pattern
+	 * last so a match is found by comparing the state. The transitions
+	 * hold the position of the row of the next state rather than its
+	 * number, which saves a multiplication per character.
+	 */
+	map = fail;
+	id = 0;
+
+	for (i = 0; i < states; i++)
+		if (!m->emit[queue[i]])
+			map[queue[i]] = id++;
+
+	m->match_start = id * classes;
+
+	for (i = 0; i < states; i++)
+		if (m->emit[queue[i]])
+			map[queue[i]] = id++;
+
+	next = (uint32_t*)RS_MALLOC(states * (classes + 4) * sizeof(uint32_t));
+
+	RS_ASSERT_PTR(next);
+
+	for (i = 0; i < states; i++) {
+		const uint32_t *row = &m->next[i * classes];
+		uint32_t *dst = &next[map[i] * classes];
+
+		for (j = 0; j < classes; j++)
+			dst[j] = (uint32_t)(map[row[j]] * classes);
+	}
+
+	emit = next + states * classes;
+
+	for (i = 0; i < states; i++) {
+		emit[map[i]] = map[m->emit[i]];
+		emit[states + map[i]] = map[m->dict[i]];
+		emit[states * 2 + map[i]] = m->depth[i];
+		emit[states * 3 + map[i]] = m->pattern[i];
+	}
+
+	RS_FREE(fail);
+	RS_FREE(m->next);
+
+	m->state_count = states;
+	m->next = next;
+	m->emit = emit;
+	m->dict = emit + states;
+	m->depth = m->dict + states;
+	m->pattern = m->depth + states;
+
+	rs_charset_init_n(&m->first, (const char*)first, firsts);
+
+	/*
+	 * Skipping to the next first character pays off when few characters
+	 * start a pattern, otherwise most skips would be a single character.
+	 */
+	m->prefilter = firsts <= 16;
+}
+
+RS_API void rs_matcher_free(rs_matcher *m)
+{
+	RS_ASSERT_PTR(m);
+
+	RS_FREE(m->next);
+}
+
+RS_API int rs_matcher_find(const rs_matcher *m, const rapidstring *s,
+			   size_t pos, size_t *begin, size_t *end,
+			   size_t *pattern)
+{
+	return rs_matcher_find_n(m, rs_data_c(s), rs_len(s), pos, begin, end,
+				 pattern);
+}
+
+RS_API int rs_matcher_find_n(const rs_matcher *m, const char *input,
+			     size_t n, size_t pos, size_t *begin, size_t *end,
+			     size_t *pattern)
+{
+	const unsigned char *in = (const unsigned char*)input;
+	const size_t classes = m->class_count;
+	size_t best = RS_NPOS;
+	size_t state = 0;
+	size_t i;
+
+	RS_ASSERT_PTR(m);
+	assert(n == 0 || input != NULL);
+	assert(pos <= n);
+
+	for (i = pos; i < n; i++) {
+		uint32_t e;
+
+		if (state == 0 && m->prefilter) {
+			i += rs_cspn_n(input + i, n - i, &m->first);
+
+			if (i == n)
+				break;
+		}
+
+		state = m->next[state + m->classes[in[i]]];
+
+		if (RS_LIKELY(best == RS_NPOS && state < m->match_start))
+			continue;
+
+		/*
+		 * A match starting at or before the best one must continue the
+		 * prefix of the current state.
+		 */
+		if (best != RS_NPOS &&
+		    i + 1 - m->depth[state / classes] > best)
+			break;
+
+		if (state < m->match_start)
+			continue;
+
+		e = m->emit[state / classes];
+
+		if (best == RS_NPOS || i + 1 - m->depth[e] <= best) {
+			best = i + 1 - m->depth[e];
+			*end = i + 1;
+			*pattern = m->pattern[e];
+		}
+	}
+
+	if (best == RS_NPOS)
+		return 0;
+
+	*begin = best;
+
+	return 1;
+}
+
+RS_API size_t rs_matcher_find_all(const rs_matcher *m, const rapidstring *s,
+				  rs_match_fn fn, void *data)
+{
+	return rs_matcher_find_all_n(m, rs_data_c(s), rs_len(s), fn, data);
+}
+
+RS_API size_t rs_matcher_find_all_n(const rs_matcher *m, const char *input,
+				    size_t n, rs_match_fn fn, void *data)
+{
+	const unsigned char *in = (const unsigned char*)input;
+	const size_t classes = m->class_count;
+	size_t count = 0;
+	size_t state = 0;
+	size_t i;
+
+	RS_ASSERT_PTR(m);
+	RS_ASSERT_PTR(fn);
+	assert(n == 0 || input != NULL);
+
+	for (i = 0; i < n; i++) {
+		uint32_t t;
+
+		if (state == 0 && m->prefilter) {
+			i += rs_cspn_n(input + i, n - i, &m->first);
+
+			if (i == n)
+				break;
+		}
+
+		state = m->next[state + m->classes[in[i]]];
+
+		if (RS_LIKELY(state < m->match_start))
+			continue;
+
+		for (t = m->emit[state / classes]; t; t = m->dict[t]) {
+			count++;
+
+			if (fn(data, m->pattern[t], i + 1 - m->depth[t], i + 1))
+				return count;
+		}
+	}
+
+	return count;
+}
+
+RS_API void rs_matcher_replace_all(const rs_matcher *m, rapidstring *dst,
+				   const rapidstring *s,
+				   const rapidstring *repls)
+{
+	assert(dst != s);
+
+	rs_matcher_replace_all_n(m, dst, rs_data_c(s), rs_len(s), repls);
+}
+
+RS_API void rs_matcher_replace_all_n(const rs_matcher *m, rapidstring *dst,
+				     const char *input, size_t n,
+				     const rapidstring *repls)
+{
+	/* Holds the beginning, end and pattern of each match. */
+	size_t buffer[RS_MATCHER_BUFFER_SIZE * 3];
+	size_t *matches = buffer;
+	size_t cap = RS_MATCHER_BUFFER_SIZE;
+	size_t count = 0;
+	size_t total = n;
+	size_t pos = 0;
+	size_t i;
+	char *out;
+
+	RS_ASSERT_PTR(repls);
+
+	/* The matches are kept so the result is sized in a single search. */
+	while (rs_matcher_find_n(m, input, n, pos, &matches[count * 3],
+				 &matches[count * 3 + 1],
+				 &matches[count * 3 + 2])) {
+		pos = matches[count * 3 + 1];
+		total += rs_len(&repls[matches[count * 3 + 2]]) -
+			(pos - matches[count * 3]);
+
+		if (RS_UNLIKELY(++count == cap)) {
+			if (matches == buffer) {
+				matches = (size_t*)RS_MALLOC(
+					cap * 2 * 3 * sizeof(size_t));
+
+				RS_ASSERT_PTR(matches);
+
+				memcpy(matches, buffer, sizeof(buffer));
+			} else {
+				matches = (size_t*)RS_REALLOC(matches,
+					cap * 2 * 3 * sizeof(size_t));
+
+				RS_ASSERT_PTR(matches);
+			}
+
+			cap *= 2;
+		}
+	}
+
+	/* Borrowed characters are replaced rather than copied first. */
+	if (RS_UNLIKELY(dst->heap.flag == RS_BORROWED_FLAG))
+		rs_init(dst);
+
+	RS_DROP_COMPRESSED(dst);
+
+	if (RS_HEAP_LIKELY(rs_owns_heap(dst))) {
+		rs_heap_resize(dst, 0);
+		rs_reserve(dst, total);
+	} else if (RS_HEAP_LIKELY(total > RS_STACK_CAPACITY)) {
+		rs_heap_init(dst, total);
+	}
+
+	out = rs_data(dst);
+	pos = 0;
+
+	for (i = 0; i < count; i++) {
+		const size_t begin = matches[i * 3];
+		const rapidstring *repl = &repls[matches[i * 3 + 2]];
+
+		memcpy(out, input + pos, begin - pos);
+		out += begin - pos;
+		memcpy(out, rs_data_c(repl), rs_len(repl));
+		out += rs_len(repl);
+		pos = matches[i * 3 + 1];
+	}
+
+	memcpy(out, input + pos, n - pos);
+
+	if (RS_HEAP_LIKELY(rs_owns_heap(dst)))
+		rs_heap_resize(dst, total);
+	else
+		rs_stack_resize(dst, total);
+
+	if (matches != buffer)
+		RS_FREE(matches);
+}
+
+/*
+ * ===============================================================
+ *
+ *                            ENCODING
+ *
+ * ===============================================================
+ */
+
+RS_API void rs_cat_json_escaped(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	rs_cat_json_escaped_n(s, input, strlen(input));
+}
+
+RS_API void rs_cat_json_escaped_n(rapidstring *s, const char *input, size_t n)
+{
+	static const char hex[] = "0123456789abcdef";
+	/* The short escapes of control characters, or zero. */
+	static const char controls[32] = {
+		0, 0, 0, 0, 0, 0, 0, 0, 'b', 't', 'n', 0, 'f', 'r'
+	};
+	const rs_charset *set = rs_json_escape_set();
+	size_t width;
+	size_t i;
+	char *out;
+
+	RS_ASSERT_PTR(input);
+
+	/* The output is sized first so the string grows at most once. */
+	out = rs_extend(s, rs_json_escaped_len(input, n));
+
+	for (i = 0; i < n; i += width) {
+		uint32_t mask = rs_charset_block(set, input + i, n - i, &width);
+		size_t done = 0;
+
+		for (; mask; mask &= mask - 1) {
+			const size_t pos = rs_ctz(mask);
+			const unsigned char c = (unsigned char)input[i + pos];
+
+			memcpy(out, input + i + done, pos - done);
+			out += pos - done;
+			done = pos + 1;
+
+			*out++ = '\\';
+
+			if (c >= 0x20) {
+				*out++ = (char)c;
+			} else if (controls[c]) {
+				*out++ = controls[c];
+			} else {
+				memcpy(out, "u00", 3);
+				out[3] = hex[c >> 4];
+				out[4] = hex[c & 15];
+				out += 5;
+			}
+		}
+
+		memcpy(out, input + i + done, width - done);
+		out += width - done;
+	}
+}
+
+RS_API int rs_cat_json_unescaped(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	return rs_cat_json_unescaped_n(s, input, strlen(input));
+}
+
+RS_API int rs_cat_json_unescaped_n(rapidstring *s, const char *input,
+				   size_t n)
+{
+	static const char from[] = "\"\\/bfnrt";
+	static const char to[] = "\"\\/\b\f\n\r\t";
+	const size_t len = rs_len(s);
+	const char *end = input + n;
+	char *out;
+	char *start;
+	int ret = 0;
+
+	RS_ASSERT_PTR(input);
+
+	/* Decoding never lengthens the input. */
+	start = out = rs_extend(s, n);
+
+	while (input < end) {
+		const char *esc = (const char*)memchr(input, '\\',
+						      (size_t)(end - input));
+		const char *short_esc;
+		uint32_t cp;
+		uint32_t low;
+
+		if (!esc) {
+			memcpy(out, input, (size_t)(end - input));
+			out += end - input;
+			break;
+		}
+
+		memcpy(out, input, (size_t)(esc - input));
+		out += esc - input;
+
+		if (end - esc < 2) {
+			ret = -1;
+			break;
+		}
+
+		input = esc + 2;
+
+		short_esc = (const char*)memchr(from, esc[1], sizeof(from) - 1);
+
+		if (short_esc) {
+			*out++ = to[short_esc - from];
+			continue;
+		}
+
+		if (esc[1] != 'u' || rs_hex_n(input, end, 4, &cp) != 0 ||
+		    (cp >= 0xDC00 && cp <= 0xDFFF)) {
+			ret = -1;
+			break;
+		}
+
+		input += 4;
+
+		/* A high surrogate must be followed by a low surrogate. */
+		if (cp >= 0xD800 && cp <= 0xDBFF) {
+			if (end - input < 6 || input[0] != '\\' ||
+			    input[1] != 'u' ||
+			    rs_hex_n(input + 2, end, 4, &low) != 0 ||
+			    low < 0xDC00 || low > 0xDFFF) {
+				ret = -1;
+				break;
+			}
+
+			cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+			input += 6;
+		}
+
+		out += rs_utf8_encode(out, cp);
+	}
+
+	rs_truncate(s, ret == 0 ? len + (size_t)(out - start) : len);
+
+	return ret;
+}
+
+RS_API void rs_cat_url_encoded(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	rs_cat_url_encoded_n(s, input, strlen(input));
+}
+
+RS_API void rs_cat_url_encoded_n(rapidstring *s, const char *input, size_t n)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	const rs_charset *set = rs_url_unreserved_set();
+	size_t width;
+	size_t i;
+	char *out;
+
+	RS_ASSERT_PTR(input);
+
+	out = rs_extend(s, rs_url_encoded_len(input, n));
+
+	/* The characters to encode are those outside the set. */
+	for (i = 0; i < n; i += width) {
+		uint32_t mask = ~rs_charset_block(set, input + i, n - i, &width);
+		size_t done = 0;
+
+		if (width < 32)
+			mask &= ((uint32_t)1 << width) - 1;
+
+		for (; mask; mask &= mask - 1) {
+			const size_t pos = rs_ctz(mask);
+			const unsigned char c = (unsigned char)input[i + pos];
+
+			memcpy(out, input + i + done, pos - done);
+			out += pos - done;
+			done = pos + 1;
+
+			out[0] = '%';
+			out[1] = hex[c >> 4];
+			out[2] = hex[c & 15];
+			out += 3;
+		}
+
+		memcpy(out, input + i + done, width - done);
+		out += width - done;
+	}
+}
+
+RS_API int rs_cat_url_decoded(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	return rs_cat_url_decoded_n(s, input, strlen(input));
+}
+
+RS_API int rs_cat_url_decoded_n(rapidstring *s, const char *input, size_t n)
+{
+	const size_t len = rs_len(s);
+	const char *end = input + n;
+	char *out;
+	char *start;
+	int ret = 0;
+
+	RS_ASSERT_PTR(input);
+
+	start = out = rs_extend(s, n);
+
+	while (input < end) {
+		const char *pct = (const char*)memchr(input, '%',
+						      (size_t)(end - input));
+		uint32_t c;
+
+		if (!pct) {
+			memcpy(out, input, (size_t)(end - input));
+			out += end - input;
+			break;
+		}
+
+		memcpy(out, input, (size_t)(pct - input));
+		out += pct - input;
+
+		if (rs_hex_n(pct + 1, end, 2, &c) != 0) {
+			ret = -1;
+			break;
+		}
+
+		*out++ = (char)c;
+		input = pct + 3;
+	}
+
+	rs_truncate(s, ret == 0 ? len + (size_t)(out - start) : len);
+
+	return ret;
+}
+
+RS_API void rs_cat_html_escaped(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	rs_cat_html_escaped_n(s, input, strlen(input));
+}
+
+RS_API void rs_cat_html_escaped_n(rapidstring *s, const char *input, size_t n)
+{
+	const rs_charset *set = rs_html_escape_set();
+	size_t width;
+	size_t i;
+	char *out;
+
+	RS_ASSERT_PTR(input);
+
+	out = rs_extend(s, rs_html_escaped_len(input, n));
+
+	for (i = 0; i < n; i += width) {
+		uint32_t mask = rs_charset_block(set, input + i, n - i, &width);
+		size_t done = 0;
+
+		for (; mask; mask &= mask - 1) {
+			const size_t pos = rs_ctz(mask);
+			const char *ref = rs_html_reference(input[i + pos]);
+			const size_t ref_len = strlen(ref);
+
+			memcpy(out, input + i + done, pos - done);
+			out += pos - done;
+			done = pos + 1;
+
+			memcpy(out, ref, ref_len);
+			out += ref_len;
+		}
+
+		memcpy(out, input + i + done, width - done);
+		out += width - done;
+	}
+}
+
+RS_API void rs_cat_html_unescaped(rapidstring *s, const char *input)
+{
+	RS_ASSERT_PTR(input);
+
+	rs_cat_html_unescaped_n(s, input, strlen(input));
+}
+
+RS_API void rs_cat_html_unescaped_n(rapidstring *s, const char *input,
+				    size_t n)
+{
+	static const char *const from[] = {
+		"amp", "lt", "gt", "quot", "apos"
+	};
+	static const char to[] = "&<>\"'";
+	const size_t len = rs_len(s);
+	const char *end = input + n;
+	char *out;
+	char *start;
+
+	RS_ASSERT_PTR(input);
+
+	/* References are never shorter than what they decode to. */
+	start = out = rs_extend(s, n);
+
+	while (input < end) {
+		const char *amp = (const char*)memchr(input, '&',
+						      (size_t)(end - input));
+		const char *name;
+		const char *semi;
+		size_t name_len;
+		size_t i;
+
+		if (!amp) {
+			memcpy(out, input, (size_t)(end - input));
+			out += end - input;
+			break;
+		}
+
+		memcpy(out, input, (size_t)(amp - input));
+		out += amp - input;
+		input = amp + 1;
+
+		/* No reference decoded here is longer than `&#x10FFFF;`. */
+		name = amp + 1;
+		semi = (const char*)memchr(name, ';', (size_t)(end - name) < 10 ?
+					   (size_t)(end - name) : 10);
+
+		if (!semi) {
+			*out++ = '&';
+			continue;
+		}
+
+		name_len = (size_t)(semi - name);
+
+		for (i = 0; i < sizeof(to) - 1; i++)
+			if (strlen(from[i]) == name_len &&
+			    memcmp(from[i], name, name_len) == 0)
+				break;
+
+		if (i < sizeof(to) - 1) {
+			*out++ = to[i];
+			input = semi + 1;
+		} else if (name_len > 1 && name[0] == '#') {
+			const int hex = name[1] == 'x' || name[1] == 'X';
+			const char *digit = name + 1 + hex;
+			uint32_t cp = 0;
+
+			for (; digit < semi && cp <= 0x10FFFF; digit++) {
+				const int v = hex ? rs_hex_value(*digit) :
+					*digit >= '0' && *digit <= '9' ?
+					*digit - '0' : -1;
+
+				if (v < 0)
+					break;
+
+				cp = cp * (hex ? 16 : 10) + (uint32_t)v;
+			}
+
+			if (digit == semi && semi > name + 1 + hex && cp != 0 &&
+			    cp <= 0x10FFFF && (cp < 0xD800 || cp > 0xDFFF)) {
+				out += rs_utf8_encode(out, cp);
+				input = semi + 1;
+			} else {
+				*out++ = '&';
+			}
+		} else {
+			*out++ = '&';
+		}
+	}
+
+	rs_truncate(s, len + (size_t)(out - start));
+}
+
+RS_API void rs_cat_base64(rapidstring *s, const void *input, size_t n,
+			  int alphabet)
+{
+	const unsigned char *in = (const unsigned char*)input;
+	size_t len = n / 3 * 4;
+	size_t i = 0;
+	char *out;
+
+	assert(n == 0 || input != NULL);
+	assert(alphabet == RS_BASE64_STANDARD || alphabet == RS_BASE64_URL);
+
+	if (n % 3)
+		len += alphabet == RS_BASE64_URL ? n % 3 + 1 : 4;
+
+	out = rs_extend(s, len);
+
+#ifdef RS_LIBRARY
+	i = rs_lib_base64_encode(out, in, n, alphabet);
+	out += i / 3 * 4;
+#elif RS_SSSE3
+	i = rs_base64_encode_simd(out, in, n, alphabet);
+	out += i / 3 * 4;
+#endif
+
+	rs_base64_encode_scalar(out, in + i, n - i, alphabet);
+}
+
+RS_API int rs_decode_base64(rapidstring *s, const char *input, size_t n)
+{
+	const size_t len = rs_len(s);
+	size_t i = 0;
+	char *out;
+
+	assert(n == 0 || input != NULL);
+
+	/* Padding is optional, but completes the last group when present. */
+	if (n > 0 && input[n - 1] == '=') {
+		if (n % 4)
+			return -1;
+
+		n -= n > 1 && input[n - 2] == '=' ? 2 : 1;
+	}
+
+	if (n % 4 == 1)
+		return -1;
+
+	out = rs_extend(s, n / 4 * 3 + (n % 4 ? n % 4 - 1 : 0));
+
+#ifdef RS_LIBRARY
+	i = rs_lib_base64_decode(out, input, n);
+	out += i / 4 * 3;
+#elif RS_SSSE3
+	i = rs_base64_decode_simd(out, input, n);
+	out += i / 4 * 3;
+#endif
+
+	if (rs_base64_decode_scalar(out, input + i, n - i) == 0)
+		return 0;
+
+	rs_truncate(s, len);
+
+	return -1;
+}
+
+RS_API void rs_cat_hex(rapidstring *s, const void *input, size_t n)
+{
+	const unsigned char *in = (const unsigned char*)input;
+	size_t i = 0;
+	char *out;
+
+	assert(n == 0 || input != NULL);
+
+	out = rs_extend(s, n * 2);
+
+#ifdef RS_LIBRARY
+	i = rs_lib_hex_encode(out, in, n);
+	out += i * 2;
+#elif RS_SSE2
+	i = rs_hex_encode_simd(out, in, n);
+	out += i * 2;
+#endif
+
+	rs_hex_encode_scalar(out, in + i, n - i);
+}
+
+RS_API int rs_decode_hex(rapidstring *s, const char *input, size_t n)
+{
+	const size_t len = rs_len(s);
+	size_t i = 0;
+	char *out;
+
+	assert(n == 0 || input != NULL);
+
+	if (n % 2)
+		return -1;
+
+	out = rs_extend(s, n / 2);
+
+#ifdef RS_LIBRARY
+	i = rs_lib_hex_decode(out, input, n);
+	out += i / 2;
+#elif RS_SSE2
+	i = rs_hex_decode_simd(out, input, n);
+	out += i / 2;
+#endif
+
+	if (rs_hex_decode_scalar(out, input + i, n - i) == 0)
+		return 0;
+
+	rs_truncate(s, len);
+
+	return -1;
+}
+
+RS_API int rs_hex_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	else if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	else if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	else
+		return -1;
+}
+
+RS_API int rs_hex_n(const char *input, const char *end, size_t n,
+		    uint32_t *value)
+{
+	size_t i;
+
+	if ((size_t)(end - input) < n)
+		return -1;
+
+	*value = 0;
+
+	for (i = 0; i < n; i++) {
+		const int v = rs_hex_value(input[i]);
+
+		if (v < 0)
+			return -1;
+
+		*value = *value << 4 | (uint32_t)v;
+	}
+
+	return 0;
+}
+
+RS_API size_t rs_utf8_encode(char *output, uint32_t cp)
+{
+	assert(cp <= 0x10FFFF);
+
+	if (cp < 0x80) {
+		output[0] = (char)cp;
+		return 1;
+	} else if (cp < 0x800) {
+		output[0] = (char)(0xC0 | cp >> 6);
+		output[1] = (char)(0x80 | (cp & 0x3F));
+		return 2;
+	} else if (cp < 0x10000) {
+		output[0] = (char)(0xE0 | cp >> 12);
+		output[1] = (char)(0x80 | (cp >> 6 & 0x3F));
+		output[2] = (char)(0x80 | (cp & 0x3F));
+		return 3;
+	} else {
+		output[0] = (char)(0xF0 | cp >> 18);
+		output[1] = (char)(0x80 | (cp >> 12 & 0x3F));
+		output[2] = (char)(0x80 | (cp >> 6 & 0x3F));
+		output[3] = (char)(0x80 | (cp & 0x3F));
+		return 4;
+	}
+}
+
+RS_API const char *rs_html_reference(char c)
+{
+	static const char chars[] = "&<>\"'";
+	static const char *const refs[] = {
+		"&amp;", "&lt;", "&gt;", "&quot;", "&#39;"
+	};
+	const char *p = (const char*)memchr(chars, c, sizeof(chars) - 1);
+
+	assert(p != NULL);
+
+	return refs[p - chars];
+}
+
+/*
+ * The sets are initialized constants, as initializing them on each call would
+ * cost more than escaping short inputs. They are the output of
+ * rs_charset_init_n().
+ */
+
+RS_API const rs_charset *rs_json_escape_set(void)
+{
+	/* Control characters, `"` and `\`. */
+	static const rs_charset set = {
+		{
+			0x03, 0x03, 0x07, 0x03, 0x03, 0x03, 0x03, 0x03,
+			0x03, 0x03, 0x03, 0x03, 0x0B, 0x03, 0x03, 0x03
+		},
+		{
+			0x01, 0x02, 0x04, 0x00, 0x00, 0x08, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+		},
+		{
+			0xFF, 0xFF, 0xFF, 0xFF, 0x04, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+		},
+		{
+			{ 0x00, 0x1F },
+			{ 0x22, 0x00 },
+			{ 0x5C, 0x00 }
+		},
+		3,
+		1,
+		1
+	};
+
+	return &set;
+}
+
+RS_API const rs_charset *rs_url_unreserved_set(void)
+{
+	/* Letters, digits, `-`, `.`, `_` and `~`. */
+	static const rs_charset set = {
+		{
+			0x2A, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E,
+			0x3E, 0x3E, 0x3C, 0x14, 0x14, 0x15, 0x35, 0x1C
+		},
+		{
+			0x00, 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+		},
+		{
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xFF, 0x03,
+			0xFE, 0xFF, 0xFF, 0x87, 0xFE, 0xFF, 0xFF, 0x47,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+		},
+		{
+			{ 0x2D, 0x01 },
+			{ 0x30, 0x09 },
+			{ 0x41, 0x19 },
+			{ 0x5F, 0x00 },
+			{ 0x61, 0x19 },
+			{ 0x7E, 0x00 }
+		},
+		6,
+		1,
+		1
+	};
+
+	return &set;
+}
+
+RS_API const rs_charset *rs_html_escape_set(void)
+{
+	/* `&`, `<`, `>`, `"` and `'`. */
+	static const rs_charset set = {
+		{
+			0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x01,
+			0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00
+		},
+		{
+			0x00, 0x00, 0x01, 0x02, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+		},
+		{
+			0x00, 0x00, 0x00, 0x00, 0xC4, 0x00, 0x00, 0x50,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+		},
+		{
+			{ 0x22, 0x00 },
+			{ 0x26, 0x01 },
+			{ 0x3C, 0x00 },
+			{ 0x3E, 0x00 }
+		},
+		4,
+		1,
+		1
+	};
+
+	return &set;
+}
+
+RS_API size_t rs_json_escaped_len(const char *input, size_t n)
+{
+#ifdef RS_LIBRARY
+	return rs_lib_json_escaped_len(input, n);
+#else
+	const rs_charset *set = rs_json_escape_set();
+	size_t len = n;
+	size_t width;
+	size_t i;
+
+	assert(n == 0 || input != NULL);
+
+	for (i = 0; i < n; i += width) {
+		uint32_t mask = rs_charset_block(set, input + i, n - i, &width);
+
+		for (; mask; mask &= mask - 1) {
+			const unsigned char c =
+				(unsigned char)input[i + rs_ctz(mask)];
+
+			/* Only `\b`, `\t`, `\n`, `\f` and `\r` are short. */
+			len += c < 0x20 && !(0x3700UL >> c & 1) ? 5 : 1;
+		}
+	}
+
+	return len;
+#endif
+}
+
+RS_API size_t rs_url_encoded_len(const char *input, size_t n)
+{
+#ifdef RS_LIBRARY
+	return rs_lib_url_encoded_len(input, n);
+#else
+	const rs_charset *set = rs_url_unreserved_set();
+	size_t len = n;
+	size_t width;
+	size_t i;
+
+	assert(n == 0 || input != NULL);
+
+	for (i = 0; i < n; i += width) {
+		const uint32_t mask =
+			rs_charset_block(set, input + i, n - i, &width);
+
+		len += 2 * (width - rs_popcount(mask));
+	}
+
+	return len;
+#endif
+}
+
+RS_API size_t rs_html_escaped_len(const char *input, size_t n)
+{
+#ifdef RS_LIBRARY
+	return rs_lib_html_escaped_len(input, n);
+#else
+	const rs_charset *set = rs_html_escape_set();
+	size_t len = n;
+	size_t width;
+	size_t i;
+
+	assert(n == 0 || input != NULL);
+
+	for (i = 0; i < n; i += width) {
+		uint32_t mask = rs_charset_block(set, input + i, n - i, &width);
+
+		for (; mask; mask &= mask - 1)
+			len += strlen(rs_html_reference(
+				input[i + rs_ctz(mask)])) - 1;
+	}
+
+	return len;
+#endif
+}
+
+RS_API size_t rs_base64_encode_scalar(char *output,
+				      const unsigned char *input, size_t n,
+				      int alphabet)
+{
+	static const char standard[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	static const char url[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+	const char *chars = alphabet == RS_BASE64_URL ? url : standard;
+	char *out = output;
+	size_t i;
+
+	for (i = 0; i + 3 <= n; i += 3) {
+		const uint32_t v = (uint32_t)input[i] << 16 |
+			(uint32_t)input[i + 1] << 8 | input[i + 2];
+
+		out[0] = chars[v >> 18];
+		out[1] = chars[v >> 12 & 0x3F];
+		out[2] = chars[v >> 6 & 0x3F];
+		out[3] = chars[v & 0x3F];
+		out += 4;
+	}
+
+	if (i < n) {
+		const uint32_t v = (uint32_t)input[i] << 16 |
+			(i + 1 < n ? (uint32_t)input[i + 1] << 8 : 0);
+
+		*out++ = chars[v >> 18];
+		*out++ = chars[v >> 12 & 0x3F];
+
+		if (i + 1 < n)
+			*out++ = chars[v >> 6 & 0x3F];
+		else if (alphabet != RS_BASE64_URL)
+			*out++ = '=';
+
+		if (alphabet != RS_BASE64_URL)
+			*out++ = '=';
+	}
+
+	return (size_t)(out - output);
+}
+
+RS_API int rs_base64_decode_scalar(char *output, const char *input,
+				   size_t n)
+{
+	size_t i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		const int a = rs_base64_value(input[i]);
+		const int b = rs_base64_value(input[i + 1]);
+		const int c = rs_base64_value(input[i + 2]);
+		const int d = rs_base64_value(input[i + 3]);
+		uint32_t v;
+
+		if ((a | b | c | d) < 0)
+			return -1;
+
+		v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 |
+			(uint32_t)d;
+
+		*output++ = (char)(v >> 16);
+		*output++ = (char)(v >> 8 & 0xFF);
+		*output++ = (char)(v & 0xFF);
+	}
+
+	/* A group of a single character would hold less than a byte. */
+	if (n - i == 1) {
+		return -1;
+	} else if (n - i > 1) {
+		const int a = rs_base64_value(input[i]);
+		const int b = rs_base64_value(input[i + 1]);
+		const int c = n - i > 2 ? rs_base64_value(input[i + 2]) : 0;
+
+		if ((a | b | c) < 0)
+			return -1;
+
+		*output++ = (char)(a << 2 | b >> 4);
+
+		if (n - i > 2)
+			*output = (char)((b & 0x0F) << 4 | c >> 2);
+	}
+
+	return 0;
+}
+
+RS_API int rs_base64_value(char c)
+{
+	/* Both alphabets, `-1` for the other ASCII characters. */
+	static const signed char values[128] = {
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, 62, -1, 63,
+		52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+		-1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+		15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, 63,
+		-1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+		41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1
+	};
+	const unsigned char u = (unsigned char)c;
+
+	return u < 128 ? values[u] : -1;
+}
+
+RS_API void rs_hex_encode_scalar(char *output, const unsigned char *input,
+				 size_t n)
+{
+	static const char hex[] = "0123456789abcdef";
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		*output++ = hex[input[i] >> 4];
+		*output++ = hex[input[i] & 0x0F];
+	}
+}
+
+RS_API int rs_hex_decode_scalar(char *output, const char *input, size_t n)
+{
+	size_t i;
+
+	assert(n % 2 == 0);
+
+	for (i = 0; i < n; i += 2) {
+		const int hi = rs_hex_value(input[i]);
+		const int lo = rs_hex_value(input[i + 1]);
+
+		if ((hi | lo) < 0)
+			return -1;
+
+		*output++ = (char)(hi << 4 | lo);
+	}
+
+	return 0;
+}
+
+/*
+ * The base64 kernels follow Muła and Lemire. Encoding spreads every three
+ * bytes over four bytes of six bits with a shuffle and two multiplies, then
+ * maps the values to characters by adding an offset chosen per range of
+ * values. Decoding classifies the characters by range, and packs the values
+ * back with multiply adds.
+ */
+
+#if RS_SSSE3
+RS_API size_t rs_base64_encode_simd(char *output,
+				    const unsigned char *input, size_t n,
+				    int alphabet)
+{
+	/* The offsets of the characters of the values 62 and 63. */
+	const char c62 = alphabet == RS_BASE64_URL ? '-' - 62 : '+' - 62;
+	const char c63 = alphabet == RS_BASE64_URL ? '_' - 63 : '/' - 63;
+	size_t i = 0;
+
+#if RS_AVX2
+	{
+		const __m256i shuffle = _mm256_setr_epi8(
+			1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+			1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+		const __m256i offsets = _mm256_setr_epi8(
+			'A', 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, c62, c63, 0, 0,
+			'A', 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, c62, c63, 0, 0);
+
+		/* Each lane encodes 12 bytes, loaded 16 at a time. */
+		for (; i + 28 <= n; i += 24, output += 32) {
+			__m256i v = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(_mm_loadu_si128(
+					(const __m128i*)(input + i))),
+				_mm_loadu_si128(
+					(const __m128i*)(input + i + 12)), 1);
+			__m256i index;
+
+			v = _mm256_shuffle_epi8(v, shuffle);
+			v = _mm256_or_si256(
+				_mm256_mulhi_epu16(_mm256_and_si256(v,
+					_mm256_set1_epi32(0x0FC0FC00)),
+					_mm256_set1_epi32(0x04000040)),
+				_mm256_mullo_epi16(_mm256_and_si256(v,
+					_mm256_set1_epi32(0x003F03F0)),
+					_mm256_set1_epi32(0x01000010)));
+
+			index = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+			index = _mm256_sub_epi8(index, _mm256_cmpgt_epi8(v,
+				_mm256_set1_epi8(25)));
+
+			_mm256_storeu_si256((__m256i*)output, _mm256_add_epi8(v,
+				_mm256_shuffle_epi8(offsets, index)));
+		}
+	}
+#endif
+
+	{
+		const __m128i shuffle = _mm_setr_epi8(
+			1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+		const __m128i offsets = _mm_setr_epi8(
+			'A', 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, c62, c63, 0, 0);
+
+		for (; i + 16 <= n; i += 12, output += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(input + i));
+			__m128i index;
+
+			v = _mm_shuffle_epi8(v, shuffle);
+			v = _mm_or_si128(
+				_mm_mulhi_epu16(_mm_and_si128(v,
+					_mm_set1_epi32(0x0FC0FC00)),
+					_mm_set1_epi32(0x04000040)),
+				_mm_mullo_epi16(_mm_and_si128(v,
+					_mm_set1_epi32(0x003F03F0)),
+					_mm_set1_epi32(0x01000010)));
+
+			index = _mm_subs_epu8(v, _mm_set1_epi8(51));
+			index = _mm_sub_epi8(index, _mm_cmpgt_epi8(v,
+				_mm_set1_epi8(25)));
+
+			_mm_storeu_si128((__m128i*)output, _mm_add_epi8(v,
+				_mm_shuffle_epi8(offsets, index)));
+		}
+	}
+
+	return i;
+}
+
+RS_API size_t rs_base64_decode_simd(char *output, const char *input,
+				    size_t n)
+{
+	size_t i = 0;
+
+	/*
+	 * The stores write past the decoded bytes, so a block is only decoded
+	 * while enough characters are left to overwrite the excess.
+	 */
+#if RS_AVX2
+	for (; i + 44 <= n; i += 32, output += 24) {
+		const __m256i v = _mm256_loadu_si256((const __m256i*)(input + i));
+		const __m256i upper = rs_in_range32(v, 'A', 'Z');
+		const __m256i lower = rs_in_range32(v, 'a', 'z');
+		const __m256i digit = rs_in_range32(v, '0', '9');
+		const __m256i plus = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('+'));
+		const __m256i minus = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-'));
+		const __m256i slash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'));
+		const __m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+		const __m256i valid = _mm256_or_si256(
+			_mm256_or_si256(_mm256_or_si256(upper, lower),
+					_mm256_or_si256(digit, plus)),
+			_mm256_or_si256(_mm256_or_si256(minus, slash), under));
+		__m256i shift;
+		__m256i bits;
+
+		if (~_mm256_movemask_epi8(valid))
+			break;
+
+		shift = _mm256_or_si256(
+			_mm256_or_si256(
+				_mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+				_mm256_and_si256(lower,
+						 _mm256_set1_epi8(26 - 'a'))),
+			_mm256_or_si256(
+				_mm256_and_si256(digit,
+						 _mm256_set1_epi8(52 - '0')),
+				_mm256_and_si256(plus,
+						 _mm256_set1_epi8(62 - '+'))));
+		shift = _mm256_or_si256(shift, _mm256_or_si256(
+			_mm256_or_si256(
+				_mm256_and_si256(minus,
+						 _mm256_set1_epi8(62 - '-')),
+				_mm256_and_si256(slash,
+						 _mm256_set1_epi8(63 - '/'))),
+			_mm256_and_si256(under, _mm256_set1_epi8(63 - '_'))));
+
+		bits = _mm256_add_epi8(v, shift);
+		bits = _mm256_maddubs_epi16(bits, _mm256_set1_epi32(0x01400140));
+		bits = _mm256_madd_epi16(bits, _mm256_set1_epi32(0x00011000));
+		bits = _mm256_shuffle_epi8(bits, _mm256_setr_epi8(
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		bits = _mm256_permutevar8x32_epi32(bits,
+			_mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+		_mm256_storeu_si256((__m256i*)output, bits);
+	}
+#endif
+
+	for (; i + 24 <= n; i += 16, output += 12) {
+		const __m128i v = _mm_loadu_si128((const __m128i*)(input + i));
+		const __m128i upper = rs_in_range16(v, 'A', 'Z');
+		const __m128i lower = rs_in_range16(v, 'a', 'z');
+		const __m128i digit = rs_in_range16(v, '0', '9');
+		const __m128i plus = _mm_cmpeq_epi8(v, _mm_set1_epi8('+'));
+		const __m128i minus = _mm_cmpeq_epi8(v, _mm_set1_epi8('-'));
+		const __m128i slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+		const __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+		const __m128i valid = _mm_or_si128(
+			_mm_or_si128(_mm_or_si128(upper, lower),
+				     _mm_or_si128(digit, plus)),
+			_mm_or_si128(_mm_or_si128(minus, slash), under));
+		__m128i shift;
+		__m128i bits;
+
+		if (_mm_movemask_epi8(valid) != 0xFFFF)
+			break;
+
+		shift = _mm_or_si128(
+			_mm_or_si128(
+				_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+				_mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+			_mm_or_si128(
+				_mm_and_si128(digit, _mm_set1_epi8(52 - '0')),
+				_mm_and_si128(plus, _mm_set1_epi8(62 - '+'))));
+		shift = _mm_or_si128(shift, _mm_or_si128(
+			_mm_or_si128(
+				_mm_and_si128(minus, _mm_set1_epi8(62 - '-')),
+				_mm_and_si128(slash, _mm_set1_epi8(63 - '/'))),
+			_mm_and_si128(under, _mm_set1_epi8(63 - '_'))));
+
+		bits = _mm_add_epi8(v, shift);
+		bits = _mm_maddubs_epi16(bits, _mm_set1_epi32(0x01400140));
+		bits = _mm_madd_epi16(bits, _mm_set1_epi32(0x00011000));
+		bits = _mm_shuffle_epi8(bits, _mm_setr_epi8(
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+		_mm_storeu_si128((__m128i*)output, bits);
+	}
+
+	return i;
+}
+#endif
+
+#if RS_SSE2
+RS_API size_t rs_hex_encode_simd(char *output, const unsigned char *input,
+				 size_t n)
+{
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	const __m128i nine = _mm_set1_epi8(9);
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i letter = _mm_set1_epi8('a' - '0' - 10);
+	size_t i;
+
+	for (i = 0; i + 16 <= n; i += 16, output += 32) {
+		const __m128i v = _mm_loadu_si128((const __m128i*)(input + i));
+		__m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+		__m128i lo = _mm_and_si128(v, nibble);
+
+		/* Digits past nine skip the characters between `9` and `a`. */
+		hi = _mm_add_epi8(_mm_add_epi8(hi, zero), _mm_and_si128(
+			_mm_cmpgt_epi8(hi, nine), letter));
+		lo = _mm_add_epi8(_mm_add_epi8(lo, zero), _mm_and_si128(
+			_mm_cmpgt_epi8(lo, nine), letter));
+
+		_mm_storeu_si128((__m128i*)output, _mm_unpacklo_epi8(hi, lo));
+		_mm_storeu_si128((__m128i*)(output + 16),
+				 _mm_unpackhi_epi8(hi, lo));
+	}
+
+	return i;
+}
+
+RS_API size_t rs_hex_decode_simd(char *output, const char *input, size_t n)
+{
+	const __m128i lower = _mm_set1_epi8(0x20);
+	const __m128i digit_shift = _mm_set1_epi8('0');
+	const __m128i letter_shift = _mm_set1_epi8('a' - 10);
+	const __m128i low_byte = _mm_set1_epi16(0x00FF);
+	__m128i words[2];
+	size_t i;
+	int j;
+
+	for (i = 0; i + 32 <= n; i += 32, output += 16) {
+		int valid = 0xFFFF;
+
+		for (j = 0; j < 2; j++) {
+			const __m128i v = _mm_loadu_si128(
+				(const __m128i*)(input + i + (size_t)j * 16));
+			const __m128i folded = _mm_or_si128(v, lower);
+			const __m128i digit = rs_in_range16(v, '0', '9');
+			const __m128i letter = rs_in_range16(folded, 'a', 'f');
+			const __m128i value = _mm_or_si128(
+				_mm_and_si128(digit, _mm_sub_epi8(v,
+								  digit_shift)),
+				_mm_and_si128(letter, _mm_sub_epi8(folded,
+								   letter_shift)));
+
+			valid &= _mm_movemask_epi8(_mm_or_si128(digit, letter));
+
+			/* The first digit of a pair is the high nibble. */
+			words[j] = _mm_or_si128(
+				_mm_slli_epi16(_mm_and_si128(value, low_byte), 4),
+				_mm_srli_epi16(value, 8));
+		}
+
+		if (valid != 0xFFFF)
+			break;
+
+		_mm_storeu_si128((__m128i*)output,
+				 _mm_packus_epi16(words[0], words[1]));
+	}
+
+	return i;
+}
+
+RS_API __m128i rs_in_range16(__m128i v, char first, char last)
+{
+	const __m128i past = _mm_subs_epu8(
+		_mm_sub_epi8(v, _mm_set1_epi8(first)),
+		_mm_set1_epi8((char)(last - first)));
+
+	return _mm_cmpeq_epi8(past, _mm_setzero_si128());
+}
+#endif
+
+#if RS_AVX2
+RS_API __m256i rs_in_range32(__m256i v, char first, char last)
+{
+	const __m256i past = _mm256_subs_epu8(
+		_mm256_sub_epi8(v, _mm256_set1_epi8(first)),
+		_mm256_set1_epi8((char)(last - first)));
+
+	return _mm256_cmpeq_epi8(past, _mm256_setzero_si256());
+}
+#endif
+
+/*
+ * ===============================================================
+ *
+ *                           CONVERSION
+ *
+ * ===============================================================
+ */
+
+RS_API size_t rs_to_i64(const rapidstring *s, int64_t *value)
+{
+	return rs_to_i64_n(rs_data_c(s), rs_len(s), value);
+}
+
+RS_API size_t rs_to_i64_n(const char *input, size_t n, int64_t *value)
+{
+	const int negative = n > 0 && input[0] == '-';
+	uint64_t v;
+	size_t len;
+
+	assert(n == 0 || input != NULL);
+	RS_ASSERT_PTR(value);
+
+	if (negative && n > 1 && input[1] == '+')
+		return 0;
+
+	len = rs_to_u64_n(input + negative, n - (size_t)negative, &v);
+
+	if (len == 0 || v > (uint64_t)INT64_MAX + (uint64_t)negative)
+		return 0;
+
+	/* The magnitude of the minimum does not fit before it is negated. */
+	*value = negative ? -(int64_t)(v - 1) - 1 : (int64_t)v;
+
+	return len + (size_t)negative;
+}
+
+RS_API size_t rs_to_u64(const rapidstring *s, uint64_t *value)
+{
+	return rs_to_u64_n(rs_data_c(s), rs_len(s), value);
+}
+
+RS_API size_t rs_to_u64_n(const char *input, size_t n, uint64_t *value)
+{
+	const char *end = input + n;
+	const char *p = input;
+	const char *digits;
+	uint64_t v = 0;
+	size_t count;
+
+	assert(n == 0 || input != NULL);
+	RS_ASSERT_PTR(value);
+
+	if (p < end && *p == '+')
+		p++;
+
+	digits = p;
+
+	/* Leading zeros do not count towards the length limit. */
+	while (p < end && *p == '0')
+		p++;
+
+	count = rs_parse_digits(p, end, &v);
+
+	if (p + count == digits)
+		return 0;
+
+	/*
+	 * The maximum has twenty digits and starts with a one. Below twice
+	 * 10^19, a value which wrapped around is less than 10^19.
+	 */
+	if (count > 20 || (count == 20 && (*p != '1' ||
+					  v < 0x8AC7230489E80000)))
+		return 0;
+
+	*value = v;
+
+	return (size_t)(p + count - input);
+}
+
+RS_API size_t rs_to_double(const rapidstring *s, double *value)
+{
+	return rs_to_double_n(rs_data_c(s), rs_len(s), value);
+}
+
+RS_API size_t rs_to_double_n(const char *input, size_t n, double *value)
+{
+#if RS_DOUBLE_EVAL
+	/* The powers of ten which are exact doubles. */
+	static const double exact[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+#endif
+	const char *end = input + n;
+	const char *p = input;
+	const char *first;
+	uint64_t w = 0;
+	long exponent = 0;
+	size_t digits;
+	size_t len;
+	int negative = 0;
+	int point = 0;
+	double d;
+
+	assert(n == 0 || input != NULL);
+	RS_ASSERT_PTR(value);
+
+	if (p < end && (*p == '-' || *p == '+'))
+		negative = *p++ == '-';
+
+	first = p;
+
+	/* Only the significant digits are accumulated. */
+	while (p < end && *p == '0')
+		p++;
+
+	digits = rs_parse_digits(p, end, &w);
+	p += digits;
+
+	if (p < end && *p == '.') {
+		const char *fraction = ++p;
+
+		point = 1;
+
+		if (digits == 0)
+			while (p < end && *p == '0')
+				p++;
+
+		len = rs_parse_digits(p, end, &w);
+		digits += len;
+		p += len;
+		exponent = -(long)(p - fraction);
+	}
+
+	if ((size_t)(p - first) == (size_t)point) {
+		len = rs_word_ci(first, end, "infinity");
+
+		if (!len)
+			len = rs_word_ci(first, end, "inf");
+
+		if (!len)
+			len = rs_word_ci(first, end, "nan");
+
+		if (!len)
+			return 0;
+
+		*value = rs_strtod_n(input, (size_t)(first + len - input));
+
+		return (size_t)(first + len - input);
+	}
+
+	/* An exponent without digits is not part of the number. */
+	if (p < end && (*p | 0x20) == 'e') {
+		const char *e = p + 1;
+		int minus = 0;
+		long e10 = 0;
+
+		if (e < end && (*e == '-' || *e == '+'))
+			minus = *e++ == '-';
+
+		if (e < end && (unsigned)(*e - '0') < 10) {
+			/* Any larger exponent overflows or underflows. */
+			for (; e < end && (unsigned)(*e - '0') < 10; e++)
+				if (e10 < 100000)
+					e10 = e10 * 10 + (*e - '0');
+
+			exponent += minus ? -e10 : e10;
+			p = e;
+		}
+	}
+
+	/*
+	 * Exact operands are multiplied exactly with a single rounding. Other
+	 * significands of up to 19 digits are rounded by Eisel-Lemire, which
+	 * fails on the rare ambiguous case. Anything else is left to strtod().
+	 */
+	if (digits > 19)
+		d = rs_strtod_n(first, (size_t)(p - first));
+	else if (w == 0)
+		d = 0;
+#if RS_DOUBLE_EVAL
+	else if (w <= (uint64_t)1 << 53 && exponent >= -22 && exponent <= 22)
+		d = exponent < 0 ? (double)w / exact[-exponent] :
+			(double)w * exact[exponent];
+#endif
+	else if (exponent < -64 || exponent > 64 ||
+		 rs_eisel_lemire(w, (int)exponent, &d) != 0)
+		d = rs_strtod_n(first, (size_t)(p - first));
+
+	*value = negative ? -d : d;
+
+	return (size_t)(p - input);
+}
+
+RS_API void rs_cat_i64(rapidstring *s, int64_t value)
+{
+	char buf[20];
+	const char *begin = rs_format_i64(buf + sizeof(buf), value);
+
+	rs_cat_n(s, begin, (size_t)(buf + sizeof(buf) - begin));
+}
+
+RS_API void rs_cat_u64(rapidstring *s, uint64_t value)
+{
+	char buf[20];
+	const char *begin = rs_format_u64(buf + sizeof(buf), value);
+
+	rs_cat_n(s, begin, (size_t)(buf + sizeof(buf) - begin));
+}
+
+RS_API uint64_t rs_load_le64(const char *input)
+{
+	const unsigned char *p = (const unsigned char*)input;
+
+	/* Compilers merge the bytes into a single load. */
+	return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 |
+		(uint64_t)p[3] << 24 | (uint64_t)p[4] << 32 |
+		(uint64_t)p[5] << 40 | (uint64_t)p[6] << 48 |
+		(uint64_t)p[7] << 56;
+}
+
+RS_API size_t rs_parse_digits(const char *input, const char *end,
+			      uint64_t *value)
+{
+	const char *p = input;
+	uint64_t v = *value;
+
+	for (; end - p >= 8; p += 8) {
+		uint64_t chunk = rs_load_le64(p);
+
+		/* Every byte is in `0x30` to `0x39` if adding 6 keeps it there. */
+		if (((chunk & 0xF0F0F0F0F0F0F0F0) |
+		     ((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4) !=
+		    0x3333333333333333)
+			break;
+
+		/* Combine pairs of digits, then pairs of pairs, and so on. */
+		chunk -= 0x3030303030303030;
+		chunk = chunk * 10 + (chunk >> 8);
+		chunk = ((chunk & 0x000000FF000000FF) * 0x000F424000000064 +
+			 (chunk >> 16 & 0x000000FF000000FF) *
+			 0x0000271000000001) >> 32;
+
+		v = v * 100000000 + chunk;
+	}
+
+	for (; p < end && (unsigned)(*p - '0') < 10; p++)
+		v = v * 10 + (uint64_t)(*p - '0');
+
+	*value = v;
+
+	return (size_t)(p - input);
+}
+
+RS_API uint64_t rs_mul128(uint64_t a, uint64_t b, uint64_t *low)
+{
+#if defined(__SIZEOF_INT128__)
+	__extension__ typedef unsigned __int128 rs_u128;
+	const rs_u128 product = (rs_u128)a * b;
+
+	*low = (uint64_t)product;
+
+	return (uint64_t)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	uint64_t high;
+
+	*low = _umul128(a, b, &high);
+
+	return high;
+#else
+	const uint64_t ll = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+	const uint64_t lh = (a & 0xFFFFFFFF) * (b >> 32);
+	const uint64_t hl = (a >> 32) * (b & 0xFFFFFFFF);
+	const uint64_t hh = (a >> 32) * (b >> 32);
+	const uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) +
+		(hl & 0xFFFFFFFF);
+
+	*low = mid << 32 | (ll & 0xFFFFFFFF);
+
+	return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+RS_API int rs_eisel_lemire(uint64_t w, int q, double *value)
+{
+	/*
+	 * 5^q for q from -64 to 64, scaled to 128 bits and truncated. Negative
+	 * powers are rounded up instead. Generated as by the fast_float
+	 * library.
+	 */
+	static const uint64_t powers[][2] = {
+		{ 0xA87FEA27A539E9A5, 0x3F2398D747B36224 },
+		{ 0xD29FE4B18E88640E, 0x8EEC7F0D19A03AAD },
+		{ 0x83A3EEEEF9153E89, 0x1953CF68300424AC },
+		{ 0xA48CEAAAB75A8E2B, 0x5FA8C3423C052DD7 },
+		{ 0xCDB02555653131B6, 0x3792F412CB06794D },
+		{ 0x808E17555F3EBF11, 0xE2BBD88BBEE40BD0 },
+		{ 0xA0B19D2AB70E6ED6, 0x5B6ACEAEAE9D0EC4 },
+		{ 0xC8DE047564D20A8B, 0xF245825A5A445275 },
+		{ 0xFB158592BE068D2E, 0xEED6E2F0F0D56712 },
+		{ 0x9CED737BB6C4183D, 0x55464DD69685606B },
+		{ 0xC428D05AA4751E4C, 0xAA97E14C3C26B886 },
+		{ 0xF53304714D9265DF, 0xD53DD99F4B3066A8 },
+		{ 0x993FE2C6D07B7FAB, 0xE546A8038EFE4029 },
+		{ 0xBF8FDB78849A5F96, 0xDE98520472BDD033 },
+		{ 0xEF73D256A5C0F77C, 0x963E66858F6D4440 },
+		{ 0x95A8637627989AAD, 0xDDE7001379A44AA8 },
+		{ 0xBB127C53B17EC159, 0x5560C018580D5D52 },
+		{ 0xE9D71B689DDE71AF, 0xAAB8F01E6E10B4A6 },
+		{ 0x9226712162AB070D, 0xCAB3961304CA70E8 },
+		{ 0xB6B00D69BB55C8D1, 0x3D607B97C5FD0D22 },
+		{ 0xE45C10C42A2B3B05, 0x8CB89A7DB77C506A },
+		{ 0x8EB98A7A9A5B04E3, 0x77F3608E92ADB242 },
+		{ 0xB267ED1940F1C61C, 0x55F038B237591ED3 },
+		{ 0xDF01E85F912E37A3, 0x6B6C46DEC52F6688 },
+		{ 0x8B61313BBABCE2C6, 0x2323AC4B3B3DA015 },
+		{ 0xAE397D8AA96C1B77, 0xABEC975E0A0D081A },
+		{ 0xD9C7DCED53C72255, 0x96E7BD358C904A21 },
+		{ 0x881CEA14545C7575, 0x7E50D64177DA2E54 },
+		{ 0xAA242499697392D2, 0xDDE50BD1D5D0B9E9 },
+		{ 0xD4AD2DBFC3D07787, 0x955E4EC64B44E864 },
+		{ 0x84EC3C97DA624AB4, 0xBD5AF13BEF0B113E },
+		{ 0xA6274BBDD0FADD61, 0xECB1AD8AEACDD58E },
+		{ 0xCFB11EAD453994BA, 0x67DE18EDA5814AF2 },
+		{ 0x81CEB32C4B43FCF4, 0x80EACF948770CED7 },
+		{ 0xA2425FF75E14FC31, 0xA1258379A94D028D },
+		{ 0xCAD2F7F5359A3B3E, 0x096EE45813A04330 },
+		{ 0xFD87B5F28300CA0D, 0x8BCA9D6E188853FC },
+		{ 0x9E74D1B791E07E48, 0x775EA264CF55347E },
+		{ 0xC612062576589DDA, 0x95364AFE032A819E },
+		{ 0xF79687AED3EEC551, 0x3A83DDBD83F52205 },
+		{ 0x9ABE14CD44753B52, 0xC4926A9672793543 },
+		{ 0xC16D9A0095928A27, 0x75B7053C0F178294 },
+		{ 0xF1C90080BAF72CB1, 0x5324C68B12DD6339 },
+		{ 0x971DA05074DA7BEE, 0xD3F6FC16EBCA5E04 },
+		{ 0xBCE5086492111AEA, 0x88F4BB1CA6BCF585 },
+		{ 0xEC1E4A7DB69561A5, 0x2B31E9E3D06C32E6 },
+		{ 0x9392EE8E921D5D07, 0x3AFF322E62439FD0 },
+		{ 0xB877AA3236A4B449, 0x09BEFEB9FAD487C3 },
+		{ 0xE69594BEC44DE15B, 0x4C2EBE687989A9B4 },
+		{ 0x901D7CF73AB0ACD9, 0x0F9D37014BF60A11 },
+		{ 0xB424DC35095CD80F, 0x538484C19EF38C95 },
+		{ 0xE12E13424BB40E13, 0x2865A5F206B06FBA },
+		{ 0x8CBCCC096F5088CB, 0xF93F87B7442E45D4 },
+		{ 0xAFEBFF0BCB24AAFE, 0xF78F69A51539D749 },
+		{ 0xDBE6FECEBDEDD5BE, 0xB573440E5A884D1C },
+		{ 0x89705F4136B4A597, 0x31680A88F8953031 },
+		{ 0xABCC77118461CEFC, 0xFDC20D2B36BA7C3E },
+		{ 0xD6BF94D5E57A42BC, 0x3D32907604691B4D },
+		{ 0x8637BD05AF6C69B5, 0xA63F9A49C2C1B110 },
+		{ 0xA7C5AC471B478423, 0x0FCF80DC33721D54 },
+		{ 0xD1B71758E219652B, 0xD3C36113404EA4A9 },
+		{ 0x83126E978D4FDF3B, 0x645A1CAC083126EA },
+		{ 0xA3D70A3D70A3D70A, 0x3D70A3D70A3D70A4 },
+		{ 0xCCCCCCCCCCCCCCCC, 0xCCCCCCCCCCCCCCCD },
+		{ 0x8000000000000000, 0x0000000000000000 },
+		{ 0xA000000000000000, 0x0000000000000000 },
+		{ 0xC800000000000000, 0x0000000000000000 },
+		{ 0xFA00000000000000, 0x0000000000000000 },
+		{ 0x9C40000000000000, 0x0000000000000000 },
+		{ 0xC350000000000000, 0x0000000000000000 },
+		{ 0xF424000000000000, 0x0000000000000000 },
+		{ 0x9896800000000000, 0x0000000000000000 },
+		{ 0xBEBC200000000000, 0x0000000000000000 },
+		{ 0xEE6B280000000000, 0x0000000000000000 },
+		{ 0x9502F90000000000, 0x0000000000000000 },
+		{ 0xBA43B74000000000, 0x0000000000000000 },
+		{ 0xE8D4A51000000000, 0x0000000000000000 },
+		{ 0x9184E72A00000000, 0x0000000000000000 },
+		{ 0xB5E620F480000000, 0x0000000000000000 },
+		{ 0xE35FA931A0000000, 0x0000000000000000 },
+		{ 0x8E1BC9BF04000000, 0x0000000000000000 },
+		{ 0xB1A2BC2EC5000000, 0x0000000000000000 },
+		{ 0xDE0B6B3A76400000, 0x0000000000000000 },
+		{ 0x8AC7230489E80000, 0x0000000000000000 },
+		{ 0xAD78EBC5AC620000, 0x0000000000000000 },
+		{ 0xD8D726B7177A8000, 0x0000000000000000 },
+		{ 0x878678326EAC9000, 0x0000000000000000 },
+		{ 0xA968163F0A57B400, 0x0000000000000000 },
+		{ 0xD3C21BCECCEDA100, 0x0000000000000000 },
+		{ 0x84595161401484A0, 0x0000000000000000 },
+		{ 0xA56FA5B99019A5C8, 0x0000000000000000 },
+		{ 0xCECB8F27F4200F3A, 0x0000000000000000 },
+		{ 0x813F3978F8940984, 0x4000000000000000 },
+		{ 0xA18F07D736B90BE5, 0x5000000000000000 },
+		{ 0xC9F2C9CD04674EDE, 0xA400000000000000 },
+		{ 0xFC6F7C4045812296, 0x4D00000000000000 },
+		{ 0x9DC5ADA82B70B59D, 0xF020000000000000 },
+		{ 0xC5371912364CE305, 0x6C28000000000000 },
+		{ 0xF684DF56C3E01BC6, 0xC732000000000000 },
+		{ 0x9A130B963A6C115C, 0x3C7F400000000000 },
+		{ 0xC097CE7BC90715B3, 0x4B9F100000000000 },
+		{ 0xF0BDC21ABB48DB20, 0x1E86D40000000000 },
+		{ 0x96769950B50D88F4, 0x1314448000000000 },
+		{ 0xBC143FA4E250EB31, 0x17D955A000000000 },
+		{ 0xEB194F8E1AE525FD, 0x5DCFAB0800000000 },
+		{ 0x92EFD1B8D0CF37BE, 0x5AA1CAE500000000 },
+		{ 0xB7ABC627050305AD, 0xF14A3D9E40000000 },
+		{ 0xE596B7B0C643C719, 0x6D9CCD05D0000000 },
+		{ 0x8F7E32CE7BEA5C6F, 0xE4820023A2000000 },
+		{ 0xB35DBF821AE4F38B, 0xDDA2802C8A800000 },
+		{ 0xE0352F62A19E306E, 0xD50B2037AD200000 },
+		{ 0x8C213D9DA502DE45, 0x4526F422CC340000 },
+		{ 0xAF298D050E4395D6, 0x9670B12B7F410000 },
+		{ 0xDAF3F04651D47B4C, 0x3C0CDD765F114000 },
+		{ 0x88D8762BF324CD0F, 0xA5880A69FB6AC800 },
+		{ 0xAB0E93B6EFEE0053, 0x8EEA0D047A457A00 },
+		{ 0xD5D238A4ABE98068, 0x72A4904598D6D880 },
+		{ 0x85A36366EB71F041, 0x47A6DA2B7F864750 },
+		{ 0xA70C3C40A64E6C51, 0x999090B65F67D924 },
+		{ 0xD0CF4B50CFE20765, 0xFFF4B4E3F741CF6D },
+		{ 0x82818F1281ED449F, 0xBFF8F10E7A8921A4 },
+		{ 0xA321F2D7226895C7, 0xAFF72D52192B6A0D },
+		{ 0xCBEA6F8CEB02BB39, 0x9BF4F8A69F764490 },
+		{ 0xFEE50B7025C36A08, 0x02F236D04753D5B4 },
+		{ 0x9F4F2726179A2245, 0x01D762422C946590 },
+		{ 0xC722F0EF9D80AAD6, 0x424D3AD2B7B97EF5 },
+		{ 0xF8EBAD2B84E0D58B, 0xD2E0898765A7DEB2 },
+		{ 0x9B934C3B330C8577, 0x63CC55F49F88EB2F },
+		{ 0xC2781F49FFCFA6D5, 0x3CBF6B71C76B25FB }
+
+	};
+	const uint64_t *power;
+	uint64_t high;
+	uint64_t low;
+	uint64_t mantissa;
+	uint64_t bits;
+	unsigned lz;
+	unsigned upper;
+	int power2;
+
+	assert(w != 0);
+
+	if (q < -64 || q > 64)
+		return -1;
+
+	power = powers[q + 64];
+	lz = w >> 32 ? rs_clz((uint32_t)(w >> 32)) :
+		32 + rs_clz((uint32_t)w);
+	w <<= lz;
+	high = rs_mul128(w, power[0], &low);
+
+	/*
+	 * The low half of the power only matters when it may carry into the
+	 * 55 bits which are kept.
+	 */
+	if ((high & 0x1FF) == 0x1FF) {
+		uint64_t ignored;
+		const uint64_t second = rs_mul128(w, power[1], &ignored);
+
+		low += second;
+		high += second > low;
+	}
+
+	/* Beyond these exponents the truncated powers are not exact enough. */
+	if (low == 0xFFFFFFFFFFFFFFFF && (q < -27 || q > 55))
+		return -1;
+
+	upper = (unsigned)(high >> 63);
+	mantissa = high >> (upper + 9);
+
+	/* floor(q * log2(10)), with the shift kept on a positive operand. */
+	power2 = ((217706 * q + (256 << 16)) >> 16) - 256 + 63 +
+		(int)upper - (int)lz + 1023;
+
+	if (power2 <= 0 || power2 >= 0x7FF)
+		return -1;
+
+	/* A product exactly between two doubles rounds to even. */
+	if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 &&
+	    mantissa << (upper + 9) == high)
+		mantissa &= ~(uint64_t)1;
+
+	mantissa += mantissa & 1;
+	mantissa >>= 1;
+
+	if (mantissa >= (uint64_t)2 << 52) {
+		mantissa = (uint64_t)1 << 52;
+		power2++;
+	}
+
+	bits = (mantissa & ~((uint64_t)1 << 52)) | (uint64_t)power2 << 52;
+	memcpy(value, &bits, sizeof(bits));
+
+	return 0;
+}
+
+RS_API double rs_strtod_n(const char *input, size_t n)
+{
+	const char point = *localeconv()->decimal_point;
+	char buffer[64];
+	char *copy = n < sizeof(buffer) ? buffer : (char*)RS_MALLOC(n + 1);
+	double result;
+	size_t i;
+
+	RS_ASSERT_PTR(copy);
+
+	for (i = 0; i < n; i++)
+		copy[i] = input[i] == '.' ? point : input[i];
+
+	copy[n] = '\0';
+	result = strtod(copy, NULL);
+
+	if (copy != buffer)
+		RS_FREE(copy);
+
+	return result;
+}
+
+RS_API size_t rs_word_ci(const char *input, const char *end,
+			 const char *word)
+{
+	size_t i;
+
+	for (i = 0; word[i]; i++)
+		if (input + i == end || (input[i] | 0x20) != word[i])
+			return 0;
+
+	return i;
+}
+
+RS_API char *rs_format_u64(char *end, uint64_t value)
+{
+	static const char pairs[] =
+		"0001020304050607080910111213141516171819"
+		"2021222324252627282930313233343536373839"
+		"4041424344454647484950515253545556575859"
+		"6061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+	/* Two digits per division. */
+	while (value >= 100) {
+		const size_t i = (size_t)(value % 100) * 2;
+
+		value /= 100;
+		end -= 2;
+		end[0] = pairs[i];
+		end[1] = pairs[i + 1];
+	}
+
+	if (value >= 10) {
+		end -= 2;
+		end[0] = pairs[value * 2];
+		end[1] = pairs[value * 2 + 1];
+	} else {
+		*--end = (char)('0' + value);
+	}
+
+	return end;
+}
+
+RS_API char *rs_format_i64(char *end, int64_t value)
+{
+	/* The magnitude of the minimum is computed without overflow. */
+	char *begin = rs_format_u64(end, value < 0 ? 0 - (uint64_t)value :
+				    (uint64_t)value);
+
+	if (value < 0)
+		*--begin = '-';
+
+	return begin;
+}
+
+/*
+ * ===============================================================
+ *
+ *                             POOLING
+ *
+ * ===============================================================
+ */
+
+RS_API void rs_pool_init(rs_pool *p, size_t max_capacity)
+{
+	RS_ASSERT_PTR(p);
+
+	p->count = 0;
+	p->max_capacity = max_capacity ? max_capacity : RS_POOL_MAX_CAPACITY;
+}
+
+RS_API void rs_pool_free(rs_pool *p)
+{
+	RS_ASSERT_PTR(p);
+
+	while (p->count)
+		rs_free(&p->strings[--p->count]);
+}
+
+RS_API void rs_pool_acquire(rs_pool *p, rapidstring *s)
+{
+	RS_ASSERT_PTR(p);
+	RS_ASSERT_PTR(s);
+
+	if (RS_LIKELY(p->count))
+		*s = p->strings[--p->count];
+	else
+		rs_init(s);
+}
+
+RS_API void rs_pool_release(rs_pool *p, rapidstring *s)
+{
+	RS_ASSERT_PTR(p);
+
+	if (RS_STACK_LIKELY(!rs_owns_heap(s)) || RS_UNLIKELY(p->count ==
+							   RS_POOL_SIZE)) {
+		rs_free(s);
+		return;
+	}
+
+	RS_STATS_SIZE(rs_len(s));
+
+	rs_heap_resize(s, 0);
+
+	if (RS_UNLIKELY(s->heap.capacity > p->max_capacity))
+		rs_realloc(s, p->max_capacity);
+
+	p->strings[p->count++] = *s;
+}
+
+#if defined(RS_THREAD_LOCAL) && RS_POSIX
+RS_API rs_pool *rs_pool_local(void)
+{
+	/* A zeroed pool is empty, only the capacity is left to set. */
+	if (RS_UNLIKELY(!rs_pool_tls.max_capacity)) {
+		rs_pool_tls.max_capacity = RS_POOL_MAX_CAPACITY;
+
+		pthread_once(&rs_pool_once, rs_pool_key_init);
+		pthread_setspecific(rs_pool_key, &rs_pool_tls);
+	}
+
+	return &rs_pool_tls;
+}
+
+RS_API void rs_pool_key_init(void)
+{
+	const int ret = pthread_key_create(&rs_pool_key, rs_pool_exit);
+
+	assert(ret == 0);
+	(void)ret;
+}
+
+RS_API void rs_pool_exit(void *p)
+{
+	rs_pool_free((rs_pool*)p);
+
+	/* A pool used again while its thread exits registers again. */
+	((rs_pool*)p)->max_capacity = 0;
+}
+#endif
+
+/*
+ * ===============================================================
+ *
+ *                            HASH MAP
+ *
+ * ===============================================================
+ */
+
+RS_API uint64_t rs_hash(const rapidstring *s)
+{
+	return rs_hash_n(rs_data_c(s), rs_len(s));
+}
+
+RS_API uint64_t rs_hash_n(const char *input, size_t n)
+{
+	static const uint64_t secret[] = {
+		0x2D358DCCAA6C78A5, 0x8BB84B93962EACC9,
+		0x4B33A62ED433D4A3, 0x4D5A2DA51DE1AA47
+	};
+	const unsigned char *in = (const unsigned char*)input;
+	uint64_t seed = rs_mix(secret[0], secret[1]);
+	uint64_t a;
+	uint64_t b;
+
+	assert(n == 0 || input != NULL);
+
+	if (RS_LIKELY(n <= 16)) {
+		if (n >= 4) {
+			/* Four overlapping loads cover up to 16 characters. */
+			const size_t mid = n >> 3 << 2;
+
+			a = rs_load_le32(input) << 32 |
+				rs_load_le32(input + mid);
+			b = rs_load_le32(input + n - 4) << 32 |
+				rs_load_le32(input + n - 4 - mid);
+		} else if (n > 0) {
+			a = (uint64_t)in[0] << 16 | (uint64_t)in[n >> 1] << 8 |
+				in[n - 1];
+			b = 0;
+		} else {
+			a = 0;
+			b = 0;
+		}
+	} else {
+		size_t i = n;
+		const char *p = input;
+
+		if (i > 48) {
+			uint64_t see1 = seed;
+			uint64_t see2 = seed;
+
+			for (; i > 48; i -= 48, p += 48) {
+				seed = rs_mix(rs_load_le64(p) ^ secret[1],
+					      rs_load_le64(p + 8) ^ seed);
+				see1 = rs_mix(rs_load_le64(p + 16) ^ secret[2],
+					      rs_load_le64(p + 24) ^ see1);
+				see2 = rs_mix(rs_load_le64(p + 32) ^ secret[3],
+					      rs_load_le64(p + 40) ^ see2);
+			}
+
+			seed ^= see1 ^ see2;
+		}
+
+		for (; i > 16; i -= 16, p += 16)
+			seed = rs_mix(rs_load_le64(p) ^ secret[1],
+				      rs_load_le64(p + 8) ^ seed);
+
+		a = rs_load_le64(p + i - 16);
+		b = rs_load_le64(p + i - 8);
+	}
+
+	a ^= secret[1];
+	b ^= seed;
+	b = rs_mul128(a, b, &a);
+
+	return rs_mix(a ^ secret[0] ^ (uint64_t)n, b ^ secret[1]);
+}
+
+RS_API void rs_map_init(rs_map *m, size_t value_size, int flags)
+{
+	RS_ASSERT_PTR(m);
+
+	m->ctrl = NULL;
+	m->slots = NULL;
+	m->capacity = 0;
+	m->size = 0;
+	m->growth_left = 0;
+	m->value_offset = sizeof(rapidstring) +
+		(flags & RS_MAP_CACHE_HASH ? sizeof(uint64_t) : 0);
+	m->slot_size = (m->value_offset + value_size + RS_ALIGNMENT - 1) /
+		RS_ALIGNMENT * RS_ALIGNMENT;
+	m->flags = flags;
+}
+
+RS_API void rs_map_free(rs_map *m)
+{
+	size_t i;
+
+	RS_ASSERT_PTR(m);
+
+	for (i = 0; i < m->capacity; i++)
+		if (m->ctrl[i] < RS_MAP_EMPTY)
+			rs_free((rapidstring*)(m->slots + i * m->slot_size));
+
+	RS_FREE(m->ctrl);
+}
+
+RS_API void rs_map_reserve(rs_map *m, size_t n)
+{
+	const size_t capacity = rs_map_capacity_for(n);
+
+	RS_ASSERT_PTR(m);
+
+	if (capacity > m->capacity)
+		rs_map_rehash(m, capacity);
+}
+
+RS_API void *rs_map_find(const rs_map *m, const rapidstring *key)
+{
+	return rs_map_find_n(m, rs_data_c(key), rs_len(key));
+}
+
+RS_API void *rs_map_find_n(const rs_map *m, const char *key, size_t n)
+{
+	size_t i;
+
+	RS_ASSERT_PTR(m);
+	assert(n == 0 || key != NULL);
+
+	i = rs_map_find_slot(m, key, n, rs_hash_n(key, n));
+
+	if (i == RS_NPOS)
+		return NULL;
+
+	return m->slots + i * m->slot_size + m->value_offset;
+}
+
+RS_API void *rs_map_insert(rs_map *m, const rapidstring *key, int *inserted)
+{
+	return rs_map_insert_n(m, rs_data_c(key), rs_len(key), inserted);
+}
+
+RS_API void *rs_map_insert_n(rs_map *m, const char *key, size_t n,
+			     int *inserted)
+{
+	const uint64_t hash = rs_hash_n(key, n);
+	size_t i;
+	char *slot;
+
+	RS_ASSERT_PTR(m);
+	assert(n == 0 || key != NULL);
+
+	i = rs_map_find_slot(m, key, n, hash);
+
+	if (i != RS_NPOS) {
+		if (inserted)
+			*inserted = 0;
+
+		return m->slots + i * m->slot_size + m->value_offset;
+	}
+
+	if (RS_UNLIKELY(!m->capacity))
+		rs_map_rehash(m, RS_MAP_GROUP);
+
+	i = rs_map_free_slot(m, hash);
+
+	/*
+	 * Deleted slots are reused freely. Filling an empty slot past the load
+	 * factor either clears the deleted slots, when they make up much of the
+	 * map, or doubles the capacity.
+	 */
+	if (RS_UNLIKELY(!m->growth_left && m->ctrl[i] == RS_MAP_EMPTY)) {
+		rs_map_rehash(m, m->size + 1 <= m->capacity / 16 * 7 ?
+			      m->capacity : m->capacity * 2);
+		i = rs_map_free_slot(m, hash);
+	}
+
+	m->growth_left -= m->ctrl[i] == RS_MAP_EMPTY;
+	m->ctrl[i] = (unsigned char)(hash & 0x7F);
+	m->size++;
+
+	slot = m->slots + i * m->slot_size;
+	rs_init_w_n((rapidstring*)slot, key, n);
+
+	if (m->flags & RS_MAP_CACHE_HASH)
+		*(uint64_t*)(slot + sizeof(rapidstring)) = hash;
+
+	if (inserted)
+		*inserted = 1;
+
+	return slot + m->value_offset;
+}
+
+RS_API int rs_map_erase(rs_map *m, const rapidstring *key)
+{
+	return rs_map_erase_n(m, rs_data_c(key), rs_len(key));
+}
+
+RS_API int rs_map_erase_n(rs_map *m, const char *key, size_t n)
+{
+	size_t i;
+
+	RS_ASSERT_PTR(m);
+	assert(n == 0 || key != NULL);
+
+	i = rs_map_find_slot(m, key, n, rs_hash_n(key, n));
+
+	if (i == RS_NPOS)
+		return 0;
+
+	rs_free((rapidstring*)(m->slots + i * m->slot_size));
+
+	/*
+	 * Probes only continue past groups without empty slots. A group with an
+	 * empty slot never had a probe continue past it, so the slot may be
+	 * emptied rather than marked as deleted.
+	 */
+	if (rs_map_match(m->ctrl + (i & ~(size_t)(RS_MAP_GROUP - 1)),
+			 RS_MAP_EMPTY)) {
+		m->ctrl[i] = RS_MAP_EMPTY;
+		m->growth_left++;
+	} else {
+		m->ctrl[i] = RS_MAP_DELETED;
+	}
+
+	m->size--;
+
+	return 1;
+}
+
+RS_API int rs_map_next(const rs_map *m, size_t *pos, const rapidstring **key,
+		       void **value)
+{
+	RS_ASSERT_PTR(m);
+	RS_ASSERT_PTR(pos);
+
+	for (; *pos < m->capacity; ++*pos) {
+		if (m->ctrl[*pos] < RS_MAP_EMPTY) {
+			char *slot = m->slots + *pos * m->slot_size;
+
+			*key = (const rapidstring*)slot;
+			*value = slot + m->value_offset;
+			++*pos;
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+RS_API uint64_t rs_load_le32(const char *input)
+{
+	const unsigned char *p = (const unsigned char*)input;
+
+	return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 |
+		(uint64_t)p[3] << 24;
+}
+
+RS_API uint64_t rs_mix(uint64_t a, uint64_t b)
+{
+	uint64_t low;
+	const uint64_t high = rs_mul128(a, b, &low);
+
+	return high ^ low;
+}
+
+RS_API uint32_t rs_map_match(const unsigned char *ctrl, unsigned char c)
+{
+#if RS_SSE2
+	const __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group,
+		_mm_set1_epi8((char)c)));
+#else
+	uint32_t mask = 0;
+	int i;
+
+	for (i = 0; i < RS_MAP_GROUP; i++)
+		mask |= (uint32_t)(ctrl[i] == c) << i;
+
+	return mask;
+#endif
+}
+
+RS_API uint32_t rs_map_match_free(const unsigned char *ctrl)
+{
+#if RS_SSE2
+	/* Only empty and deleted slots have the high bit set. */
+	return (uint32_t)_mm_movemask_epi8(
+		_mm_loadu_si128((const __m128i*)ctrl));
+#else
+	uint32_t mask = 0;
+	int i;
+
+	for (i = 0; i < RS_MAP_GROUP; i++)
+		mask |= (uint32_t)(ctrl[i] >> 7) << i;
+
+	return mask;
+#endif
+}
+
+RS_API size_t rs_map_find_slot(const rs_map *m, const char *key, size_t n,
+			       uint64_t hash)
+{
+	const unsigned char h2 = (unsigned char)(hash & 0x7F);
+	const size_t mask = m->capacity / RS_MAP_GROUP - 1;
+	size_t group = (size_t)(hash >> 7) & mask;
+	size_t step = 0;
+
+	if (RS_UNLIKELY(!m->capacity))
+		return RS_NPOS;
+
+	/*
+	 * Groups are probed with triangular steps, which visit every group as
+	 * the number of groups is a power of two. The load factor leaves an
+	 * empty slot to end every probe.
+	 */
+	for (;;) {
+		const unsigned char *ctrl = m->ctrl + group * RS_MAP_GROUP;
+		uint32_t match = rs_map_match(ctrl, h2);
+
+		for (; match; match &= match - 1) {
+			const size_t i = group * RS_MAP_GROUP + rs_ctz(match);
+			const char *slot = m->slots + i * m->slot_size;
+			const rapidstring *k = (const rapidstring*)slot;
+
+			if ((!(m->flags & RS_MAP_CACHE_HASH) ||
+			     *(const uint64_t*)(slot + sizeof(rapidstring)) ==
+			     hash) && rs_len(k) == n &&
+			    memcmp(rs_data_c(k), key, n) == 0)
+				return i;
+		}
+
+		if (RS_LIKELY(rs_map_match(ctrl, RS_MAP_EMPTY)))
+			return RS_NPOS;
+
+		group = (group + ++step) & mask;
+	}
+}
+
+RS_API size_t rs_map_free_slot(const rs_map *m, uint64_t hash)
+{
+	const size_t mask = m->capacity / RS_MAP_GROUP - 1;
+	size_t group = (size_t)(hash >> 7) & mask;
+	size_t step = 0;
+	uint32_t match;
+
+	while (!(match = rs_map_match_free(m->ctrl + group * RS_MAP_GROUP)))
+		group = (group + ++step) & mask;
+
+	return group * RS_MAP_GROUP + rs_ctz(match);
+}
+
+RS_API void rs_map_rehash(rs_map *m, size_t capacity)
+{
+	unsigned char *old_ctrl = m->ctrl;
+	const char *old_slots = m->slots;
+	const size_t old_capacity = m->capacity;
+	size_t i;
+
+	assert(capacity % RS_MAP_GROUP == 0 && capacity / 8 * 7 >= m->size);
+
+	/* The slots follow the control bytes, which keep them aligned. */
+	m->ctrl = (unsigned char*)RS_MALLOC(capacity * (1 + m->slot_size));
+
+	RS_ASSERT_PTR(m->ctrl);
+
+	memset(m->ctrl, RS_MAP_EMPTY, capacity);
+	m->slots = (char*)m->ctrl + capacity;
+	m->capacity = capacity;
+	m->growth_left = capacity / 8 * 7 - m->size;
+
+	/* Strings are moved by copying their bytes, heap strings included. */
+	for (i = 0; i < old_capacity; i++) {
+		const char *slot = old_slots + i * m->slot_size;
+		uint64_t hash;
+		size_t j;
+
+		if (old_ctrl[i] >= RS_MAP_EMPTY)
+			continue;
+
+		if (m->flags & RS_MAP_CACHE_HASH)
+			hash = *(const uint64_t*)(slot + sizeof(rapidstring));
+		else
+			hash = rs_hash((const rapidstring*)slot);
+
+		j = rs_map_free_slot(m, hash);
+		m->ctrl[j] = old_ctrl[i];
+		memcpy(m->slots + j * m->slot_size, slot, m->slot_size);
+	}
+
+	RS_FREE(old_ctrl);
+}
+
+RS_API size_t rs_map_capacity_for(size_t n)
+{
+	size_t capacity = RS_MAP_GROUP;
+
+	while (capacity / 8 * 7 < n)
+		capacity *= 2;
+
+	return capacity;
+}
+
+/*
+ * ===============================================================
+ *
+ *                           RADIX TREE
+ *
+ * ===============================================================
+ */
+
+RS_API void rs_radix_init(rs_radix_tree *t)
+{
+	RS_ASSERT_PTR(t);
+
+	t->root = NULL;
+	t->size = 0;
+}
+
+RS_API void rs_radix_free(rs_radix_tree *t)
+{
+	RS_ASSERT_PTR(t);
+
+	if (t->root)
+		rs_radix_free_child(t->root);
+}
+
+RS_API void rs_radix_build(rs_radix_tree *t, const rapidstring *keys,
+			   void *const *values, size_t n)
+{
+	RS_ASSERT_PTR(t);
+	assert(t->root == NULL);
+	assert(n == 0 || keys != NULL);
+
+	if (n)
+		t->root = rs_radix_build_range(keys, values, 0, n, 0);
+
+	t->size = n;
+}
+
+RS_API void **rs_radix_insert(rs_radix_tree *t, const rapidstring *key,
+			      int *inserted)
+{
+	return rs_radix_insert_n(t, rs_data_c(key), rs_len(key), inserted);
+}
+
+RS_API void **rs_radix_insert_n(rs_radix_tree *t, const char *key, size_t n,
+				int *inserted)
+{
+	void **ref;
+	size_t depth = 0;
+	rs_radix_leaf *leaf;
+
+	RS_ASSERT_PTR(t);
+	assert(n == 0 || key != NULL);
+
+	for (ref = &t->root;; depth++) {
+		void *p = *ref;
+		rs_radix_node *node;
+		void **child;
+		size_t len;
+
+		if (!p) {
+			leaf = rs_radix_leaf_new(key, n, NULL);
+			*ref = RS_RADIX_TAG(leaf);
+			break;
+		}
+
+		if (RS_RADIX_IS_LEAF(p)) {
+			rs_radix_leaf *old = RS_RADIX_LEAF(p);
+			const char *old_key = rs_radix_leaf_key(old);
+
+			if (old->len == n && memcmp(old_key, key, n) == 0) {
+				if (inserted)
+					*inserted = 0;
+
+				return &old->value;
+			}
+
+			/* The leaf becomes a node of what both keys share. */
+			len = rs_common_prefix(old_key + depth, old->len - depth,
+					       key + depth, n - depth);
+			node = rs_radix_node_new(RS_RADIX_NODE4, key + depth, len);
+			depth += len;
+			leaf = rs_radix_leaf_new(key, n, NULL);
+
+			if (old->len == depth)
+				node->leaf = old;
+			else
+				node = rs_radix_add_child(node,
+					(unsigned char)old_key[depth], p);
+
+			if (n == depth)
+				node->leaf = leaf;
+			else
+				node = rs_radix_add_child(node,
+					(unsigned char)key[depth],
+					RS_RADIX_TAG(leaf));
+
+			*ref = node;
+			break;
+		}
+
+		node = (rs_radix_node*)p;
+		len = rs_common_prefix(rs_radix_prefix(node), node->prefix_len,
+				       key + depth, n - depth);
+
+		if (len < node->prefix_len) {
+			/* The prefix is split at the first difference. */
+			char *prefix = rs_radix_prefix(node);
+			rs_radix_node *parent = rs_radix_node_new(RS_RADIX_NODE4,
+								  prefix, len);
+
+			parent = rs_radix_add_child(parent,
+				(unsigned char)prefix[len], node);
+			node->prefix_len -= (uint32_t)(len + 1);
+			memmove(prefix, prefix + len + 1, node->prefix_len);
+
+			depth += len;
+			leaf = rs_radix_leaf_new(key, n, NULL);
+
+			if (n == depth)
+				parent->leaf = leaf;
+			else
+				parent = rs_radix_add_child(parent,
+					(unsigned char)key[depth],
+					RS_RADIX_TAG(leaf));
+
+			*ref = parent;
+			break;
+		}
+
+		depth += len;
+
+		if (depth == n) {
+			if (node->leaf) {
+				if (inserted)
+					*inserted = 0;
+
+				return &node->leaf->value;
+			}
+
+			leaf = node->leaf = rs_radix_leaf_new(key, n, NULL);
+			break;
+		}
+
+		child = rs_radix_child(node, (unsigned char)key[depth]);
+
+		if (!child) {
+			leaf = rs_radix_leaf_new(key, n, NULL);
+			*ref = rs_radix_add_child(node, (unsigned char)key[depth],
+						  RS_RADIX_TAG(leaf));
+			break;
+		}
+
+		ref = child;
+	}
+
+	t->size++;
+
+	if (inserted)
+		*inserted = 1;
+
+	return &leaf->value;
+}
+
+RS_API void **rs_radix_find(const rs_radix_tree *t, const rapidstring *key)
+{
+	return rs_radix_find_n(t, rs_data_c(key), rs_len(key));
+}
+
+RS_API void **rs_radix_find_n(const rs_radix_tree *t, const char *key,
+			      size_t n)
+{
+	const void *p;
+	size_t depth = 0;
+
+	RS_ASSERT_PTR(t);
+	assert(n == 0 || key != NULL);
+
+	for (p = t->root; p; depth++) {
+		const rs_radix_node *node;
+		void **child;
+
+		/* The characters before the depth match along the path. */
+		if (RS_RADIX_IS_LEAF(p)) {
+			rs_radix_leaf *leaf = RS_RADIX_LEAF(p);
+
+			if (leaf->len == n &&
+			    memcmp(rs_radix_leaf_key(leaf) + depth, key + depth,
+				   n - depth) == 0)
+				return &leaf->value;
+
+			return NULL;
+		}
+
+		node = (const rs_radix_node*)p;
+
+		if (n - depth < node->prefix_len ||
+		    memcmp(rs_radix_prefix(node), key + depth,
+			   node->prefix_len) != 0)
+			return NULL;
+
+		depth += node->prefix_len;
+
+		if (depth == n)
+			return node->leaf ? &node->leaf->value : NULL;
+
+		child = rs_radix_child(node, (unsigned char)key[depth]);
+
+		if (!child)
+			return NULL;
+
+		p = *child;
+	}
+
+	return NULL;
+}
+
+RS_API void **rs_radix_longest_prefix(const rs_radix_tree *t,
+				      const rapidstring *s, size_t *len)
+{
+	return rs_radix_longest_prefix_n(t, rs_data_c(s), rs_len(s), len);
+}
+
+RS_API void **rs_radix_longest_prefix_n(const rs_radix_tree *t,
+					const char *input, size_t n,
+					size_t *len)
+{
+	rs_radix_leaf *best = NULL;
+	const void *p;
+	size_t depth = 0;
+
+	RS_ASSERT_PTR(t);
+	assert(n == 0 || input != NULL);
+
+	for (p = t->root; p; depth++) {
+		const rs_radix_node *node;
+		void **child;
+
+		if (RS_RADIX_IS_LEAF(p)) {
+			rs_radix_leaf *leaf = RS_RADIX_LEAF(p);
+
+			if (leaf->len <= n &&
+			    memcmp(rs_radix_leaf_key(leaf) + depth,
+				   input + depth, leaf->len - depth) == 0)
+				best = leaf;
+
+			break;
+		}
+
+		node = (const rs_radix_node*)p;
+
+		if (n - depth < node->prefix_len ||
+		    memcmp(rs_radix_prefix(node), input + depth,
+			   node->prefix_len) != 0)
+			break;
+
+		depth += node->prefix_len;
+
+		if (node->leaf)
+			best = node->leaf;
+
+		if (depth == n)
+			break;
+
+		child = rs_radix_child(node, (unsigned char)input[depth]);
+
+		if (!child)
+			break;
+
+		p = *child;
+	}
+
+	if (!best)
+		return NULL;
+
+	if (len)
+		*len = best->len;
+
+	return &best->value;
+}
+
+RS_API size_t rs_radix_iterate_prefix(const rs_radix_tree *t,
+				      const rapidstring *prefix,
+				      rs_radix_fn fn, void *data)
+{
+	return rs_radix_iterate_prefix_n(t, rs_data_c(prefix), rs_len(prefix),
+					 fn, data);
+}
+
+RS_API size_t rs_radix_iterate_prefix_n(const rs_radix_tree *t,
+					const char *prefix, size_t n,
+					rs_radix_fn fn, void *data)
+{
+	const void *p;
+	size_t count = 0;
+	size_t depth = 0;
+
+	RS_ASSERT_PTR(t);
+	RS_ASSERT_PTR(fn);
+	assert(n == 0 || prefix != NULL);
+
+	/* Find the subtree of the keys starting with the prefix. */
+	for (p = t->root; p && !RS_RADIX_IS_LEAF(p); depth++) {
+		const rs_radix_node *node = (const rs_radix_node*)p;
+		const size_t len = rs_common_prefix(rs_radix_prefix(node),
+						    node->prefix_len,
+						    prefix + depth, n - depth);
+		void **child;
+
+		if (depth + len == n)
+			break;
+
+		if (len < node->prefix_len)
+			return 0;
+
+		depth += len;
+		child = rs_radix_child(node, (unsigned char)prefix[depth]);
+
+		if (!child)
+			return 0;
+
+		p = *child;
+	}
+
+	if (!p)
+		return 0;
+
+	if (RS_RADIX_IS_LEAF(p)) {
+		const rs_radix_leaf *leaf = RS_RADIX_LEAF(p);
+
+		if (leaf->len < n || memcmp(rs_radix_leaf_key(leaf) + depth,
+					    prefix + depth, n - depth) != 0)
+			return 0;
+	}
+
+	rs_radix_walk(p, fn, data, &count);
+
+	return count;
+}
+
+RS_API rs_radix_leaf *rs_radix_leaf_new(const char *key, size_t n,
+					void *value)
+{
+	rs_radix_leaf *leaf = (rs_radix_leaf*)RS_MALLOC(sizeof(rs_radix_leaf) +
+							n);
+
+	RS_ASSERT_PTR(leaf);
+
+	leaf->value = value;
+	leaf->len = n;
+	memcpy(leaf + 1, key, n);
+
+	return leaf;
+}
+
+RS_API const char *rs_radix_leaf_key(const rs_radix_leaf *leaf)
+{
+	return (const char*)(leaf + 1);
+}
+
+RS_API rs_radix_node *rs_radix_node_new(unsigned char type,
+					const char *prefix, size_t n)
+{
+	const size_t size = rs_radix_node_size(type);
+	rs_radix_node *node = (rs_radix_node*)RS_MALLOC(size + n);
+
+	RS_ASSERT_PTR(node);
+	assert(n <= 0xFFFFFFFFUL);
+
+	/* Zeroed keys keep the vector search of unused slots defined. */
+	memset(node, 0, size);
+	node->type = type;
+	node->prefix_len = (uint32_t)n;
+	memcpy((char*)node + size, prefix, n);
+
+	return node;
+}
+
+RS_API char *rs_radix_prefix(const rs_radix_node *node)
+{
+	return (char*)node + rs_radix_node_size(node->type);
+}
+
+RS_API size_t rs_radix_node_size(unsigned char type)
+{
+	static const size_t sizes[] = {
+		sizeof(rs_radix_node4), sizeof(rs_radix_node16),
+		sizeof(rs_radix_node48), sizeof(rs_radix_node256)
+	};
+
+	return sizes[type];
+}
+
+RS_API void **rs_radix_child(const rs_radix_node *node, unsigned char c)
+{
+	if (node->type == RS_RADIX_NODE4) {
+		rs_radix_node4 *n4 = (rs_radix_node4*)node;
+		int i;
+
+		for (i = 0; i < node->count; i++)
+			if (n4->keys[i] == c)
+				return &n4->children[i];
+
+		return NULL;
+	} else if (node->type == RS_RADIX_NODE16) {
+		rs_radix_node16 *n16 = (rs_radix_node16*)node;
+#if RS_SSE2
+		const __m128i eq = _mm_cmpeq_epi8(_mm_set1_epi8((char)c),
+			_mm_loadu_si128((const __m128i*)n16->keys));
+		const uint32_t mask = (uint32_t)_mm_movemask_epi8(eq) &
+			((1U << node->count) - 1);
+
+		return mask ? &n16->children[rs_ctz(mask)] : NULL;
+#else
+		int i;
+
+		for (i = 0; i < node->count; i++)
+			if (n16->keys[i] == c)
+				return &n16->children[i];
+
+		return NULL;
+#endif
+	} else if (node->type == RS_RADIX_NODE48) {
+		rs_radix_node48 *n48 = (rs_radix_node48*)node;
+		const unsigned char i = n48->index[c];
+
+		return i ? &n48->children[i - 1] : NULL;
+	} else {
+		rs_radix_node256 *n256 = (rs_radix_node256*)node;
+
+		return n256->children[c] ? &n256->children[c] : NULL;
+	}
+}
+
+RS_API rs_radix_node *rs_radix_add_child(rs_radix_node *node,
+					 unsigned char c, void *child)
+{
+	static const unsigned short capacity[] = { 4, 16, 48, 256 };
+
+	if (RS_UNLIKELY(node->count == capacity[node->type]))
+		node = rs_radix_grow(node);
+
+	if (node->type <= RS_RADIX_NODE16) {
+		unsigned char *keys;
+		void **children;
+		int i;
+
+		if (node->type == RS_RADIX_NODE4) {
+			keys = ((rs_radix_node4*)node)->keys;
+			children = ((rs_radix_node4*)node)->children;
+		} else {
+			keys = ((rs_radix_node16*)node)->keys;
+			children = ((rs_radix_node16*)node)->children;
+		}
+
+		/* The children are kept in order for iteration. */
+		for (i = node->count; i > 0 && keys[i - 1] > c; i--) {
+			keys[i] = keys[i - 1];
+			children[i] = children[i - 1];
+		}
+
+		keys[i] = c;
+		children[i] = child;
+	} else if (node->type == RS_RADIX_NODE48) {
+		rs_radix_node48 *n48 = (rs_radix_node48*)node;
+
+		n48->children[node->count] = child;
+		n48->index[c] = (unsigned char)(node->count + 1);
+	} else {
+		((rs_radix_node256*)node)->children[c] = child;
+	}
+
+	node->count++;
+
+	return node;
+}
+
+RS_API rs_radix_node *rs_radix_grow(rs_radix_node *node)
+{
+	rs_radix_node *grown = rs_radix_node_new(
+		(unsigned char)(node->type + 1), rs_radix_prefix(node),
+		node->prefix_len);
+	int i;
+
+	grown->leaf = node->leaf;
+	grown->count = node->count;
+
+	if (node->type == RS_RADIX_NODE4) {
+		rs_radix_node4 *n4 = (rs_radix_node4*)node;
+		rs_radix_node16 *n16 = (rs_radix_node16*)grown;
+
+		memcpy(n16->keys, n4->keys, sizeof(n4->keys));
+		memcpy(n16->children, n4->children, sizeof(n4->children));
+	} else if (node->type == RS_RADIX_NODE16) {
+		rs_radix_node16 *n16 = (rs_radix_node16*)node;
+		rs_radix_node48 *n48 = (rs_radix_node48*)grown;
+
+		for (i = 0; i < 16; i++) {
+			n48->index[n16->keys[i]] = (unsigned char)(i + 1);
+			n48->children[i] = n16->children[i];
+		}
+	} else {
+		rs_radix_node48 *n48 = (rs_radix_node48*)node;
+		rs_radix_node256 *n256 = (rs_radix_node256*)grown;
+
+		for (i = 0; i < 256; i++)
+			if (n48->index[i])
+				n256->children[i] =
+					n48->children[n48->index[i] - 1];
+	}
+
+	RS_FREE(node);
+
+	return grown;
+}
+
+RS_API size_t rs_common_prefix(const char *a, size_t a_len, const char *b,
+			       size_t b_len)
+{
+	const size_t n = a_len < b_len ? a_len : b_len;
+	size_t i;
+
+	/* The lowest differing byte of eight is the first difference. */
+	for (i = 0; i + 8 <= n; i += 8) {
+		const uint64_t x = rs_load_le64(a + i) ^ rs_load_le64(b + i);
+
+		if (x)
+			return i + ((uint32_t)x ? rs_ctz((uint32_t)x) :
+				    32 + rs_ctz((uint32_t)(x >> 32))) / 8;
+	}
+
+	while (i < n && a[i] == b[i])
+		i++;
+
+	return i;
+}
+
+RS_API void *rs_radix_build_range(const rapidstring *keys,
+				  void *const *values, size_t lo, size_t hi,
+				  size_t depth)
+{
+	const char *first = rs_data_c(&keys[lo]);
+	const size_t first_len = rs_len(&keys[lo]);
+	const char *last = rs_data_c(&keys[hi - 1]);
+	size_t count = 1;
+	size_t d;
+	size_t i;
+	size_t j;
+	unsigned char type;
+	rs_radix_node *node;
+
+	if (hi - lo == 1)
+		return RS_RADIX_TAG(rs_radix_leaf_new(first, first_len,
+			values ? values[lo] : NULL));
+
+	/* The keys of a sorted range share what its first and last share. */
+	d = depth + rs_common_prefix(first + depth, first_len - depth,
+				     last + depth, rs_len(&keys[hi - 1]) - depth);
+
+	/* Only the first key may end at the node. */
+	i = lo + (first_len == d);
+
+	for (j = i + 1; j < hi; j++)
+		count += rs_data_c(&keys[j])[d] != rs_data_c(&keys[j - 1])[d];
+
+	type = count <= 4 ? RS_RADIX_NODE4 : count <= 16 ? RS_RADIX_NODE16 :
+		count <= 48 ? RS_RADIX_NODE48 : RS_RADIX_NODE256;
+	node = rs_radix_node_new(type, first + depth, d - depth);
+
+	if (first_len == d)
+		node->leaf = rs_radix_leaf_new(first, first_len,
+					       values ? values[lo] : NULL);
+
+	for (; i < hi; i = j) {
+		const char c = rs_data_c(&keys[i])[d];
+
+		j = i + 1;
+
+		while (j < hi && rs_data_c(&keys[j])[d] == c)
+			j++;
+
+		node = rs_radix_add_child(node, (unsigned char)c,
+			rs_radix_build_range(keys, values, i, j, d + 1));
+	}
+
+	return node;
+}
+
+RS_API int rs_radix_walk(const void *child, rs_radix_fn fn, void *data,
+			 size_t *count)
+{
+	const rs_radix_node *node = (const rs_radix_node*)child;
+	int i;
+
+	if (RS_RADIX_IS_LEAF(child)) {
+		const rs_radix_leaf *leaf = RS_RADIX_LEAF(child);
+
+		++*count;
+
+		return fn(data, rs_radix_leaf_key(leaf), leaf->len,
+			  leaf->value);
+	}
+
+	if (node->leaf) {
+		++*count;
+
+		if (fn(data, rs_radix_leaf_key(node->leaf), node->leaf->len,
+		       node->leaf->value))
+			return 1;
+	}
+
+	if (node->type == RS_RADIX_NODE4) {
+		const rs_radix_node4 *n4 = (const rs_radix_node4*)node;
+
+		for (i = 0; i < node->count; i++)
+			if (rs_radix_walk(n4->children[i], fn, data, count))
+				return 1;
+	} else if (node->type == RS_RADIX_NODE16) {
+		const rs_radix_node16 *n16 = (const rs_radix_node16*)node;
+
+		for (i = 0; i < node->count; i++)
+			if (rs_radix_walk(n16->children[i], fn, data, count))
+				return 1;
+	} else if (node->type == RS_RADIX_NODE48) {
+		const rs_radix_node48 *n48 = (const rs_radix_node48*)node;
+
+		for (i = 0; i < 256; i++)
+			if (n48->index[i] &&
+			    rs_radix_walk(n48->children[n48->index[i] - 1], fn,
+					  data, count))
+				return 1;
+	} else {
+		const rs_radix_node256 *n256 = (const rs_radix_node256*)node;
+
+		for (i = 0; i < 256; i++)
+			if (n256->children[i] &&
+			    rs_radix_walk(n256->children[i], fn, data, count))
+				return 1;
+	}
+
+	return 0;
+}
+
+RS_API void rs_radix_free_child(void *child)
+{
+	rs_radix_node *node = (rs_radix_node*)child;
+	int i;
+
+	if (RS_RADIX_IS_LEAF(child)) {
+		RS_FREE(RS_RADIX_LEAF(child));
+		return;
+	}
+
+	RS_FREE(node->leaf);
+
+	if (node->type == RS_RADIX_NODE4) {
+		for (i = 0; i < node->count; i++)
+			rs_radix_free_child(((rs_radix_node4*)node)->children[i]);
+	} else if (node->type == RS_RADIX_NODE16) {
+		for (i = 0; i < node->count; i++)
+			rs_radix_free_child(
+				((rs_radix_node16*)node)->children[i]);
+	} else if (node->type == RS_RADIX_NODE48) {
+		rs_radix_node48 *n48 = (rs_radix_node48*)node;
+
+		for (i = 0; i < node->count; i++)
+			rs_radix_free_child(n48->children[i]);
+	} else {
+		rs_radix_node256 *n256 = (rs_radix_node256*)node;
+
+		for (i = 0; i < 256; i++)
+			if (n256->children[i])
+				rs_radix_free_child(n256->children[i]);
+	}
+
+	RS_FREE(node);
+}
+
+/*
+ * ===============================================================
+ *
+ *                           COMPRESSION
+ *
+ * ===============================================================
+ */
+
+#ifdef RS_COMPRESSION
+
+RS_API int rs_compress(rapidstring *s)
+{
+	char *scratch;
+	size_t saved;
+
+	RS_ASSERT_RS(s);
+
+	if (!rs_is_compressible(s))
+		return 0;
+
+	scratch = (char*)RS_MALLOC(rs_lz_bound(s->heap.size));
+
+	RS_ASSERT_PTR(scratch);
+	RS_STATS_ADD(allocs, 1);
+
+	saved = rs_compress_with(s, scratch);
+
+	RS_STATS_ADD(frees, 1);
+	RS_FREE(scratch);
+
+	return saved != 0;
+}
+
+RS_API size_t rs_compress_all(rapidstring *s, size_t n)
+{
+	char *scratch;
+	size_t saved = 0;
+	size_t max = 0;
+	size_t i;
+
+	assert(n == 0 || s != NULL);
+
+	for (i = 0; i < n; i++)
+		if (rs_is_compressible(&s[i]) && s[i].heap.size > max)
+			max = s[i].heap.size;
+
+	if (max == 0)
+		return 0;
+
+	scratch = (char*)RS_MALLOC(rs_lz_bound(max));
+
+	RS_ASSERT_PTR(scratch);
+	RS_STATS_ADD(allocs, 1);
+
+	for (i = 0; i < n; i++)
+		if (rs_is_compressible(&s[i]))
+			saved += rs_compress_with(&s[i], scratch);
+
+	RS_STATS_ADD(frees, 1);
+	RS_FREE(scratch);
+
+	return saved;
+}
+
+RS_API void rs_decompress(rapidstring *s)
+{
+	RS_ASSERT_PTR(s);
+
+	if (s->heap.flag == RS_COMPRESSED_FLAG) {
+		char *buffer = (char*)RS_MALLOC(RS_ALLOC_SIZE(s->heap.size));
+
+		RS_ASSERT_PTR(buffer);
+		RS_STATS_ADD(allocs, 1);
+
+		rs_lz_decompress(buffer, s->heap.size + 1, s->heap.buffer,
+				 s->heap.capacity);
+		buffer[s->heap.size] = '\0';
+
+		RS_STATS_ADD(frees, 1);
+		RS_FREE(s->heap.buffer);
+
+		s->heap.buffer = buffer;
+		s->heap.capacity = s->heap.size;
+		s->heap.flag = RS_HEAP_FLAG;
+	}
+}
+
+RS_API int rs_is_compressed(const rapidstring *s)
+{
+	RS_ASSERT_RS(s);
+
+	return s->heap.flag == RS_COMPRESSED_FLAG;
 }
 
-RS_API size_t rs_stack_len(const rapidstring *s)
+RS_API size_t rs_compressed_len(const rapidstring *s)
 {
-	RS_ASSERT_STACK(s);
+	return rs_is_compressed(s) ? s->heap.capacity : rs_len(s);
+}
 
-	return RS_STACK_CAPACITY - s->stack.left;
+RS_API int rs_is_compressible(const rapidstring *s)
+{
+	/* The 32 bit length limit of compressed strings always holds then. */
+	return s->heap.flag == RS_HEAP_FLAG &&
+#ifndef RS_SIZE_T32
+		s->heap.size <= 0xFFFFFFFFUL &&
+#endif
+		s->heap.size >= RS_COMPRESS_MIN;
 }
 
-RS_API size_t rs_heap_len(const rapidstring *s)
+RS_API size_t rs_compress_with(rapidstring *s, char *scratch)
 {
-	RS_ASSERT_HEAP(s);
+	const size_t n = s->heap.size;
+	const size_t len = rs_lz_compress(scratch, s->heap.buffer, n);
+	size_t saved;
 
-	return s->heap.size;
+	/* Small savings are not worth decompressing for. */
+	if (len > n - n / 8)
+		return 0;
+
+	saved = RS_ALLOC_SIZE(s->heap.capacity) - len;
+
+	memcpy(s->heap.buffer, scratch, len);
+
+	RS_STATS_ADD(reallocs, 1);
+	s->heap.buffer = (char*)RS_REALLOC(s->heap.buffer, len);
+
+	RS_ASSERT_PTR(s->heap.buffer);
+
+	s->heap.capacity = (rs_size)len;
+	s->heap.flag = RS_COMPRESSED_FLAG;
+
+	return saved;
 }
 
-RS_API size_t rs_len(const rapidstring *s)
+RS_API size_t rs_lz_bound(size_t n)
 {
-	return rs_is_heap(s) ?
-		rs_heap_len(s) :
-		rs_stack_len(s);
+	return n + n / 255 + 16;
 }
 
-RS_API size_t rs_capacity(const rapidstring *s)
+RS_API size_t rs_lz_compress(char *dst, const char *src, size_t n)
 {
-	return rs_is_heap(s) ?
-		s->heap.capacity :
-		RS_STACK_CAPACITY;
+	uint32_t table[1 << RS_LZ_HASH_BITS];
+	const unsigned char *in = (const unsigned char*)src;
+	unsigned char *out = (unsigned char*)dst;
+	unsigned bits = 8;
+	size_t anchor = 0;
+	size_t i = 0;
+
+	assert(n <= 0xFFFFFFFFUL);
+
+	/* Short inputs clear a smaller table. */
+	while (bits < RS_LZ_HASH_BITS && ((size_t)1 << bits) < n)
+		bits++;
+
+	memset(table, 0, sizeof(uint32_t) << bits);
+
+	while (i + RS_LZ_MIN_MATCH <= n) {
+		const uint32_t seq = (uint32_t)rs_load_le32(src + i);
+		const uint32_t h = (uint32_t)(seq * 2654435761UL) >>
+			(32 - bits);
+		size_t ref = table[h];
+		size_t len;
+
+		table[h] = (uint32_t)i;
+
+		if (ref >= i || i - ref > RS_LZ_MAX_OFFSET ||
+		    (uint32_t)rs_load_le32(src + ref) != seq) {
+			/* Incompressible input is skipped increasingly fast. */
+			i += 1 + ((i - anchor) >> 6);
+			continue;
+		}
+
+		len = RS_LZ_MIN_MATCH + rs_common_prefix(
+			src + ref + RS_LZ_MIN_MATCH, n - ref - RS_LZ_MIN_MATCH,
+			src + i + RS_LZ_MIN_MATCH, n - i - RS_LZ_MIN_MATCH);
+
+		while (i > anchor && ref > 0 && in[i - 1] == in[ref - 1]) {
+			i--;
+			ref--;
+			len++;
+		}
+
+		out = rs_lz_sequence(out, in + anchor, i - anchor, i - ref, len);
+		i += len;
+		anchor = i;
+	}
+
+	out = rs_lz_sequence(out, in + anchor, n - anchor, 0, 0);
+
+	return (size_t)(out - (unsigned char*)dst);
 }
 
-RS_API void rs_reserve(rapidstring *s, size_t n)
+RS_API void rs_lz_decompress(char *dst, size_t dst_n, const char *src,
+			     size_t n)
 {
-	if (RS_HEAP_LIKELY(rs_is_heap(s))) {
-		if (RS_LIKELY(s->heap.capacity < n))
-			rs_realloc(s, n);
-	} else {
-		rs_stack_to_heap(s, n);
+	const unsigned char *in = (const unsigned char*)src;
+	const unsigned char *end = in + n;
+	char *out = dst;
+	char *const out_end = dst + dst_n;
+
+	for (;;) {
+		const unsigned char token = *in++;
+		const char *match;
+		size_t offset;
+		size_t len = rs_lz_read_length(&in, token >> 4);
+		size_t i;
+
+		/*
+		 * Short copies are done at a fixed size when there is room,
+		 * writing past their end.
+		 */
+		if (len <= 16 && in + 16 <= end && out + 16 <= out_end)
+			memcpy(out, in, 16);
+		else
+			memcpy(out, in, len);
+
+		out += len;
+		in += len;
+
+		if (in == end)
+			break;
+
+		offset = (size_t)in[0] | (size_t)in[1] << 8;
+		in += 2;
+		len = rs_lz_read_length(&in, token & 15) + RS_LZ_MIN_MATCH;
+		match = out - offset;
+
+		/* Each block of characters is written before it is read. */
+		if (offset >= 16 && out + len + 16 <= out_end) {
+			for (i = 0; i < len; i += 16)
+				memcpy(out + i, match + i, 16);
+		} else if (offset >= 8 && out + len + 8 <= out_end) {
+			for (i = 0; i < len; i += 8)
+				memcpy(out + i, match + i, 8);
+		} else {
+			/* An overlapping match repeats the last @offset characters. */
+			for (i = 0; i < len; i++)
+				out[i] = match[i];
+		}
+
+		out += len;
 	}
 }
 
-RS_API void rs_shrink_to_fit(rapidstring *s)
+RS_API unsigned char *rs_lz_sequence(unsigned char *out,
+				     const unsigned char *literals, size_t n,
+				     size_t offset, size_t len)
 {
-	if (RS_LIKELY(rs_is_heap(s)))
-		rs_realloc(s, rs_heap_len(s));
+	unsigned char *token = out++;
+
+	*token = (unsigned char)((n < 15 ? n : 15) << 4);
+
+	if (n >= 15)
+		out = rs_lz_write_length(out, n - 15);
+
+	memcpy(out, literals, n);
+	out += n;
+
+	if (len) {
+		len -= RS_LZ_MIN_MATCH;
+		out[0] = (unsigned char)offset;
+		out[1] = (unsigned char)(offset >> 8);
+		out += 2;
+
+		*token |= (unsigned char)(len < 15 ? len : 15);
+
+		if (len >= 15)
+			out = rs_lz_write_length(out, len - 15);
+	}
+
+	return out;
 }
 
-RS_API int rs_is_heap(const rapidstring *s)
+RS_API unsigned char *rs_lz_write_length(unsigned char *out, size_t len)
 {
-	RS_ASSERT_RS(s);
+	for (; len >= 255; len -= 255)
+		*out++ = 255;
 
-	return s->heap.flag == RS_HEAP_FLAG;
+	*out++ = (unsigned char)len;
+
+	return out;
 }
 
-RS_API int rs_is_stack(const rapidstring *s)
+RS_API size_t rs_lz_read_length(const unsigned char **in, size_t len)
 {
-	return !rs_is_heap(s);
+	unsigned char b;
+
+	if (len == 15) {
+		do {
+			b = *(*in)++;
+			len += b;
+		} while (b == 255);
+	}
+
+	return len;
 }
 
+#endif /* RS_COMPRESSION */
+
 /*
  * ===============================================================
  *
- *                            MODIFIERS
+ *                          FILE LOADING
  *
  * ===============================================================
  */
 
-RS_API char *rs_data(rapidstring *s)
-{
-	return (char*)rs_data_c(s);
-}
+#if RS_POSIX
 
-RS_API const char *rs_data_c(const rapidstring *s)
+RS_API int rs_load_files(rapidstring *dst, const char *const *paths,
+			 size_t n, int *errors)
 {
-	RS_ASSERT_RS(s);
+	rs_load_slot slots[RS_LOAD_QUEUE_DEPTH];
+	size_t base = 0;
+	size_t i;
+	int first = 0;
 
-	return rs_is_heap(s) ?
-		s->heap.buffer :
-		s->stack.buffer;
-}
+	assert(n == 0 || (dst != NULL && paths != NULL));
 
-RS_API void rs_stack_cat(rapidstring *s, const char *input)
-{
-	RS_ASSERT_PTR(input);
+#if RS_URING
+	{
+		rs_uring r;
 
-	rs_stack_cat_n(s, input, strlen(input));
-}
+		if (n > 1 && rs_uring_init(&r, RS_LOAD_QUEUE_DEPTH) == 0) {
+			base = rs_uring_load(&r, dst, paths, n, errors, &first);
+			rs_uring_free(&r);
+		}
+	}
+#endif
 
-RS_API void rs_stack_cat_n(rapidstring *s, const char *input, size_t n)
-{
-	size_t stack_size;
+	for (; base < n; base += RS_LOAD_QUEUE_DEPTH) {
+		const size_t count = n - base < RS_LOAD_QUEUE_DEPTH ?
+			n - base : RS_LOAD_QUEUE_DEPTH;
 
-	RS_ASSERT_PTR(input);
-	assert(RS_STACK_CAPACITY >= rs_stack_len(s) + n);
+		/* Every file of the window is read ahead before any is read. */
+		for (i = 0; i < count; i++) {
+			if (rs_load_open(&slots[i], &dst[base + i],
+					 paths[base + i]) == -1) {
+				rs_load_result(errno, base + i, errors, &first);
+				continue;
+			}
 
-	stack_size = rs_stack_len(s);
-	memcpy(s->stack.buffer + stack_size, input, n);
-	rs_stack_resize(s, stack_size + n);
+			slots[i].index = base + i;
+
+#ifdef POSIX_FADV_WILLNEED
+			if (slots[i].size != RS_NPOS)
+				posix_fadvise(slots[i].fd, 0, 0,
+					      POSIX_FADV_WILLNEED);
+#endif
+		}
+
+		for (i = 0; i < count; i++) {
+			if (slots[i].index == RS_NPOS)
+				continue;
+
+			if (rs_load_read(&slots[i], &dst[base + i]) == -1)
+				rs_load_result(errno, base + i, errors, &first);
+			else
+				rs_load_result(0, base + i, errors, &first);
+		}
+	}
+
+	if (first)
+		errno = first;
+
+	return first ? -1 : 0;
 }
 
-RS_API void rs_heap_cat(rapidstring *s, const char *input)
+RS_API int rs_load_open(rs_load_slot *slot, rapidstring *s,
+			const char *path)
 {
-	RS_ASSERT_PTR(input);
+	struct stat st;
 
-	rs_heap_cat_n(s, input, strlen(input));
+	RS_ASSERT_PTR(path);
+
+	slot->index = RS_NPOS;
+	rs_truncate(s, 0);
+
+	/* Another thread may fork and exec while the file is open. */
+	slot->fd = open(path, O_RDONLY | O_CLOEXEC);
+
+	if (RS_UNLIKELY(slot->fd == -1))
+		return -1;
+
+	if (RS_UNLIKELY(fstat(slot->fd, &st) == -1)) {
+		close(slot->fd);
+		return -1;
+	}
+
+	/* Other files, such as pipes, report no meaningful size. */
+	if (RS_LIKELY(S_ISREG(st.st_mode))) {
+		slot->size = (size_t)st.st_size;
+
+		/* The exact size, where extending alone would add growth. */
+		if (RS_HEAP_LIKELY(slot->size > RS_STACK_CAPACITY))
+			rs_reserve(s, slot->size);
+
+		rs_extend(s, slot->size);
+	} else {
+		slot->size = RS_NPOS;
+	}
+
+	slot->offset = 0;
+
+	return 0;
 }
 
-RS_API void rs_heap_cat_n(rapidstring *s, const char *input, size_t n)
+RS_API int rs_load_read(rs_load_slot *slot, rapidstring *s)
 {
-	RS_ASSERT_RS(s);
-	RS_ASSERT_PTR(input);
-	assert(s->heap.capacity >= s->heap.size + n);
+	int ret = 0;
 
-	memcpy(s->heap.buffer + rs_heap_len(s), input, n);
-	rs_heap_resize(s, rs_heap_len(s) + n);
+	/* The string only holds the characters read. */
+	rs_truncate(s, slot->offset);
+
+	/*
+	 * The ring reads at explicit offsets, which leaves the position of the
+	 * file at its start.
+	 */
+	if (slot->offset > 0 &&
+	    RS_UNLIKELY(lseek(slot->fd, (off_t)slot->offset, SEEK_SET) == -1))
+		ret = -1;
+
+	while (ret == 0 && slot->offset < slot->size) {
+		size_t room = rs_capacity(s) - slot->offset;
+		ssize_t got;
+
+		if (room == 0) {
+			rs_reserve(s, rs_grown(slot->offset) +
+				   RS_STACK_CAPACITY);
+			room = rs_capacity(s) - slot->offset;
+		}
+
+		if (room > slot->size - slot->offset)
+			room = slot->size - slot->offset;
+
+		got = read(slot->fd, rs_extend(s, room), room);
+		rs_truncate(s, slot->offset + (got > 0 ? (size_t)got : 0));
+
+		if (RS_UNLIKELY(got == -1)) {
+			if (errno == EINTR)
+				continue;
+
+			ret = -1;
+			break;
+		}
+
+		if (got == 0)
+			break;
+
+		slot->offset += (size_t)got;
+	}
+
+	if (RS_UNLIKELY(ret == -1)) {
+		const int err = errno;
+
+		rs_truncate(s, 0);
+		close(slot->fd);
+		errno = err;
+	} else {
+		close(slot->fd);
+	}
+
+	slot->index = RS_NPOS;
+
+	return ret;
 }
 
-RS_API void rs_cat(rapidstring *s, const char *input)
+RS_API void rs_load_result(int err, size_t i, int *errors, int *first)
 {
-	RS_ASSERT_PTR(input);
+	if (errors)
+		errors[i] = err;
 
-	rs_cat_n(s, input, strlen(input));
+	if (err && !*first)
+		*first = err;
 }
 
-RS_API void rs_cat_n(rapidstring *s, const char *input, size_t n)
+#if RS_URING
+
+RS_API int rs_uring_init(rs_uring *r, unsigned entries)
 {
-	if (RS_HEAP_LIKELY(rs_is_heap(s))) {
-		rs_grow_heap(s, rs_heap_len(s) + n);
-		rs_heap_cat_n(s, input, n);
-	} else if (RS_HEAP_LIKELY(s->stack.left < n)) {
-		rs_stack_to_heap_g(s, n);
-		rs_heap_cat_n(s, input, n);
-	} else {
-		rs_stack_cat_n(s, input, n);
+	struct io_uring_params p;
+	char *sq;
+	char *cq;
+
+	memset(&p, 0, sizeof(p));
+
+	r->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+
+	if (r->fd < 0)
+		return -1;
+
+	r->sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	r->cq_map_size = p.cq_off.cqes +
+		p.cq_entries * sizeof(struct io_uring_cqe);
+	r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+	/* Newer kernels map both rings at once. */
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (r->cq_map_size > r->sq_map_size)
+			r->sq_map_size = r->cq_map_size;
+
+		r->cq_map_size = 0;
+	}
+
+	r->sq_map = mmap(NULL, r->sq_map_size, PROT_READ | PROT_WRITE,
+			 MAP_SHARED, r->fd, IORING_OFF_SQ_RING);
+	r->cq_map = r->cq_map_size == 0 || r->sq_map == MAP_FAILED ?
+		r->sq_map : mmap(NULL, r->cq_map_size, PROT_READ | PROT_WRITE,
+				 MAP_SHARED, r->fd, IORING_OFF_CQ_RING);
+	r->sqes = r->cq_map == MAP_FAILED ? (struct io_uring_sqe*)MAP_FAILED :
+		(struct io_uring_sqe*)mmap(NULL, r->sqes_size,
+					   PROT_READ | PROT_WRITE, MAP_SHARED,
+					   r->fd, IORING_OFF_SQES);
+
+	if (RS_UNLIKELY(r->sqes == MAP_FAILED)) {
+		const int err = errno;
+
+		if (r->cq_map != MAP_FAILED && r->cq_map_size != 0)
+			munmap(r->cq_map, r->cq_map_size);
+
+		if (r->sq_map != MAP_FAILED)
+			munmap(r->sq_map, r->sq_map_size);
+
+		close(r->fd);
+		errno = err;
+
+		return -1;
 	}
+
+	sq = (char*)r->sq_map;
+	cq = (char*)r->cq_map;
+
+	r->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+	r->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+	r->sq_array = (unsigned*)(sq + p.sq_off.array);
+	r->cq_head = (unsigned*)(cq + p.cq_off.head);
+	r->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+	r->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+	r->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+	r->pending = 0;
+
+	return 0;
 }
 
-RS_API void rs_cat_rs(rapidstring *s, const rapidstring *input)
+RS_API void rs_uring_free(rs_uring *r)
 {
-	RS_DATA_SIZE(rs_cat_n, s, input);
+	munmap(r->sqes, r->sqes_size);
+
+	if (r->cq_map_size != 0)
+		munmap(r->cq_map, r->cq_map_size);
+
+	munmap(r->sq_map, r->sq_map_size);
+	close(r->fd);
 }
 
-RS_API void rs_steal(rapidstring *s, char *buffer)
+RS_API void rs_uring_read(rs_uring *r, rs_load_slot *slot, rapidstring *s)
 {
-	RS_ASSERT_PTR(buffer);
-
-	rs_steal_n(s, buffer, strlen(buffer));
+	/* Only this thread writes the tail. */
+	const unsigned tail = *r->sq_tail;
+	const unsigned i = tail & *r->sq_mask;
+	struct io_uring_sqe *sqe = &r->sqes[i];
+	size_t len = slot->size - slot->offset;
+
+	if (len > RS_LOAD_MAX_READ)
+		len = RS_LOAD_MAX_READ;
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = slot->fd;
+	sqe->addr = (uint64_t)(uintptr_t)(rs_data(s) + slot->offset);
+	sqe->len = (uint32_t)len;
+	sqe->off = (uint64_t)slot->offset;
+	sqe->user_data = (uint64_t)(uintptr_t)slot;
+
+	r->sq_array[i] = i;
+	__atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	r->pending++;
 }
 
-RS_API void rs_steal_n(rapidstring *s, char *buffer, size_t n)
+RS_API int rs_uring_enter(rs_uring *r)
 {
-	/* Manual free as using rs_free creates an additional branch. */
-	if (RS_HEAP_LIKELY(rs_is_heap(s)))
-		RS_FREE(s->heap.buffer);
-	else
-		s->heap.flag = RS_HEAP_FLAG;
+	long ret;
 
-	s->heap.buffer = buffer;
-	s->heap.size = n;
-	s->heap.capacity = n;
+	do {
+		ret = syscall(__NR_io_uring_enter, r->fd, r->pending, 1,
+			      IORING_ENTER_GETEVENTS, NULL, 0);
+	} while (ret == -1 && errno == EINTR);
+
+	if (RS_UNLIKELY(ret == -1))
+		return -1;
+
+	r->pending -= (unsigned)ret;
+
+	return 0;
 }
 
-RS_API void rs_stack_resize(rapidstring *s, size_t n)
+RS_API int rs_uring_wait(rs_uring *r)
 {
-	assert(RS_STACK_CAPACITY >= n);
-	
-	s->stack.buffer[n] = '\0';
-	s->stack.left = (unsigned char)(RS_STACK_CAPACITY - n);
+	long ret;
+
+	do {
+		ret = syscall(__NR_io_uring_enter, r->fd, 0, 1,
+			      IORING_ENTER_GETEVENTS, NULL, 0);
+	} while (ret == -1 && errno == EINTR);
+
+	return ret == -1 ? -1 : 0;
 }
 
-RS_API void rs_heap_resize(rapidstring *s, size_t n)
+RS_API int rs_uring_reap(rs_uring *r, rs_load_slot **slot, int *res)
 {
-	RS_ASSERT_HEAP(s);
-	assert(s->heap.capacity >= n);
+	const unsigned head = *r->cq_head;
+	const struct io_uring_cqe *cqe;
 
-	s->heap.buffer[n] = '\0';
-	s->heap.size = n;
+	if (head == __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE))
+		return 0;
+
+	cqe = &r->cqes[head & *r->cq_mask];
+	*slot = (rs_load_slot*)(uintptr_t)cqe->user_data;
+	*res = cqe->res;
+
+	__atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+
+	return 1;
 }
 
-RS_API void rs_resize(rapidstring *s, size_t n)
+RS_API size_t rs_uring_load(rs_uring *r, rapidstring *dst,
+			    const char *const *paths, size_t n, int *errors,
+			    int *first)
 {
-	if (RS_HEAP_LIKELY(n > RS_STACK_CAPACITY)) {
-		if (RS_HEAP_LIKELY(rs_is_heap(s)))
-			rs_reserve(s, n);
-		else
-			rs_heap_init(s, n);
+	rs_load_slot slots[RS_LOAD_QUEUE_DEPTH];
+	rs_load_slot *slot;
+	size_t next = 0;
+	size_t inflight = 0;
+	size_t i;
+	int err = 0;
+	int res;
+
+	for (i = 0; i < RS_LOAD_QUEUE_DEPTH; i++)
+		slots[i].index = RS_NPOS;
+
+	while (next < n || inflight > 0) {
+		/* Refill the free slots. */
+		for (i = 0; i < RS_LOAD_QUEUE_DEPTH && next < n; i++) {
+			if (slots[i].index != RS_NPOS)
+				continue;
+
+			if (rs_load_open(&slots[i], &dst[next],
+					 paths[next]) == -1) {
+				rs_load_result(errno, next++, errors, first);
+				continue;
+			}
+
+			slots[i].index = next;
+
+			/* Files of unknown or no size are read directly. */
+			if (slots[i].size == RS_NPOS || slots[i].size == 0) {
+				res = rs_load_read(&slots[i], &dst[next]);
+				rs_load_result(res ? errno : 0, next, errors,
+					       first);
+			} else {
+				rs_uring_read(r, &slots[i], &dst[next]);
+				inflight++;
+			}
+
+			next++;
+		}
+
+		if (inflight == 0)
+			continue;
+
+		if (RS_UNLIKELY(rs_uring_enter(r) == -1))
+			break;
+
+		while (rs_uring_reap(r, &slot, &res)) {
+			const size_t index = slot->index;
+
+			if (res > 0) {
+				slot->offset += (size_t)res;
+
+				if (slot->offset < slot->size) {
+					rs_uring_read(r, slot, &dst[index]);
+					continue;
+				}
+			} else if (res == -EINTR || res == -EAGAIN) {
+				rs_uring_read(r, slot, &dst[index]);
+				continue;
+			}
+
+			/*
+			 * The end of the file, or an error, which the reading
+			 * without the ring reports if it persists.
+			 */
+			if (res == 0)
+				slot->size = slot->offset;
+
+			inflight--;
+			res = rs_load_read(slot, &dst[index]);
+			rs_load_result(res ? errno : 0, index, errors, first);
+		}
+	}
 
-		rs_heap_resize(s, n);
-	} else {
-		rs_stack_resize(s, n);
+	/*
+	 * A failing ring may have accepted reads which still write to the
+	 * strings, so those are waited for. The reads it did not accept, the
+	 * pending ones, are dropped along with the ring.
+	 */
+	while (inflight > r->pending) {
+		if (RS_UNLIKELY(rs_uring_wait(r) == -1)) {
+			err = errno;
+			break;
+		}
+
+		while (rs_uring_reap(r, &slot, &res)) {
+			const size_t index = slot->index;
+
+			if (res > 0)
+				slot->offset += (size_t)res;
+			else if (res == 0)
+				slot->size = slot->offset;
+
+			inflight--;
+			res = rs_load_read(slot, &dst[index]);
+			rs_load_result(res ? errno : 0, index, errors, first);
+		}
 	}
-}
 
-RS_API void rs_resize_w(rapidstring *s, size_t n, char c)
-{
-	size_t sz = rs_len(s);
+	/* Reads left by a failing ring are finished without it. */
+	for (i = 0; inflight > 0 && i < RS_LOAD_QUEUE_DEPTH; i++) {
+		const size_t index = slots[i].index;
 
-	rs_resize(s, n);
+		if (index == RS_NPOS)
+			continue;
 
-	if (RS_LIKELY(sz < n)) {
-		size_t diff = n - sz;
-		memset(rs_data(s) + sz, c, diff);
+		inflight--;
+
+		/* Without a completion, the read may still be running. */
+		if (RS_UNLIKELY(err)) {
+			close(slots[i].fd);
+			slots[i].index = RS_NPOS;
+			rs_load_result(err, index, errors, first);
+			continue;
+		}
+
+		res = rs_load_read(&slots[i], &dst[index]);
+		rs_load_result(res ? errno : 0, index, errors, first);
 	}
+
+	return next;
 }
 
+#endif /* RS_URING */
+
+#endif /* RS_POSIX */
+
 /*
  * ===============================================================
  *
- *                         HEAP OPERATIONS
+ *                            STREAMING
  *
  * ===============================================================
  */
 
-RS_API void rs_heap_init(rapidstring *s, size_t n)
+RS_API void rs_sink_init(rs_sink *k, size_t high_water, rs_flush_fn fn,
+			 void *data)
 {
-	s->heap.buffer = (char*)RS_MALLOC(n + 1);
+	RS_ASSERT_PTR(k);
+	RS_ASSERT_PTR(fn);
 
-	RS_ASSERT_PTR(s->heap.buffer);
+	k->high_water = high_water ? high_water : RS_SINK_SIZE;
+	k->fn = fn;
+	k->data = data;
+	k->error = 0;
+	k->flushed = 0;
 
-	s->heap.capacity = n;
-	s->heap.flag = RS_HEAP_FLAG;
+	rs_init_w_cap(&k->buffer, k->high_water);
 }
 
-RS_API void rs_heap_init_g(rapidstring *s, size_t n)
+RS_API void rs_sink_free(rs_sink *k)
 {
-	rs_heap_init(s, n * RS_GROWTH_FACTOR);
+	RS_ASSERT_PTR(k);
+
+	rs_free(&k->buffer);
 }
 
-RS_API void rs_stack_to_heap(rapidstring *s, size_t n)
+RS_API int rs_sink_flush(rs_sink *k)
 {
-	const size_t stack_size = rs_stack_len(s);
+	const size_t len = rs_len(&k->buffer);
 
-	char tmp[RS_STACK_CAPACITY];
-	memcpy(tmp, s->stack.buffer, stack_size);
+	if (len > 0) {
+		if (RS_LIKELY(!k->error))
+			k->error = k->fn(k->data, rs_data_c(&k->buffer), len);
 
-	rs_heap_init(s, stack_size + n);
-	rs_heap_cpy_n(s, tmp, stack_size);
+		k->flushed += len;
+
+		/* The capacity is kept for what follows. */
+		rs_truncate(&k->buffer, 0);
+	}
+
+	return k->error;
 }
 
-RS_API void rs_stack_to_heap_g(rapidstring *s, size_t n)
+RS_API rapidstring *rs_sink_string(rs_sink *k, size_t n)
 {
-	rs_stack_to_heap(s, n * RS_GROWTH_FACTOR);
+	RS_ASSERT_PTR(k);
+
+	if (rs_len(&k->buffer) + n > k->high_water)
+		rs_sink_flush(k);
+
+	return &k->buffer;
 }
 
-RS_API void rs_realloc(rapidstring *s, size_t n)
+RS_API void rs_sink_commit(rs_sink *k)
 {
-	s->heap.buffer = (char*)RS_REALLOC(s->heap.buffer, n + 1);
+	if (rs_len(&k->buffer) >= k->high_water)
+		rs_sink_flush(k);
+}
 
-	RS_ASSERT_PTR(s->heap.buffer);
+RS_API void rs_sink_cat(rs_sink *k, const char *input)
+{
+	RS_ASSERT_PTR(input);
 
-	s->heap.capacity = n;
+	rs_sink_cat_n(k, input, strlen(input));
 }
 
-RS_API void rs_grow_heap(rapidstring *s, size_t n)
+RS_API void rs_sink_cat_n(rs_sink *k, const char *input, size_t n)
+{
+	RS_ASSERT_PTR(k);
+	assert(n == 0 || input != NULL);
+
+	if (RS_UNLIKELY(rs_len(&k->buffer) + n > k->high_water)) {
+		rs_sink_flush(k);
+
+		if (n >= k->high_water) {
+			if (RS_LIKELY(!k->error))
+				k->error = k->fn(k->data, input, n);
+
+			k->flushed += n;
+
+			return;
+		}
+	}
+
+	rs_cat_n(&k->buffer, input, n);
+}
+
+RS_API void rs_sink_cat_rs(rs_sink *k, const rapidstring *input)
+{
+	rs_sink_cat_n(k, rs_data_c(input), rs_len(input));
+}
+
+RS_API void rs_sink_cat_i64(rs_sink *k, int64_t value)
+{
+	char buf[20];
+	const char *begin = rs_format_i64(buf + sizeof(buf), value);
+
+	rs_sink_cat_n(k, begin, (size_t)(buf + sizeof(buf) - begin));
+}
+
+RS_API void rs_sink_cat_u64(rs_sink *k, uint64_t value)
+{
+	char buf[20];
+	const char *begin = rs_format_u64(buf + sizeof(buf), value);
+
+	rs_sink_cat_n(k, begin, (size_t)(buf + sizeof(buf) - begin));
+}
+
+#if RS_PRINTF
+RS_API int rs_sink_printf(rs_sink *k, const char *format, ...)
+{
+	va_list args;
+	int ret;
+
+	va_start(args, format);
+	ret = rs_sink_vprintf(k, format, args);
+	va_end(args);
+
+	return ret;
+}
+
+RS_API int rs_sink_vprintf(rs_sink *k, const char *format, va_list args)
 {
-	if (RS_UNLIKELY(s->heap.capacity < n))
-		rs_realloc(s, n * RS_GROWTH_FACTOR);
+	const size_t len = rs_len(&k->buffer);
+	const size_t room = rs_capacity(&k->buffer) - len;
+	/*
+	 * A heap buffer has room for the null terminator, while a full stack
+	 * buffer is terminated by its `left` field, outside of the characters.
+	 */
+	const size_t size = rs_is_heap(&k->buffer) ? room + 1 : room;
+	va_list copy;
+	int ret;
+
+	RS_VA_COPY(copy, args);
+
+	ret = vsnprintf(rs_data(&k->buffer) + len, size, format, args);
+
+	if (RS_LIKELY(ret >= 0 && (size_t)ret < size)) {
+		rs_extend(&k->buffer, (size_t)ret);
+	} else if (ret >= 0) {
+		/*
+		 * Output which does not fit is formatted again after a flush.
+		 * The attempt overwrote the terminator, which is restored
+		 * first.
+		 */
+		rs_truncate(&k->buffer, len);
+		rs_sink_flush(k);
+
+		if ((size_t)ret <= rs_capacity(&k->buffer)) {
+			ret = rs_cat_vprintf(&k->buffer, format, copy);
+		} else {
+			/* Output larger than the buffer must not grow it. */
+			rapidstring tmp;
+
+			rs_init(&tmp);
+			ret = rs_cat_vprintf(&tmp, format, copy);
+
+			if (RS_LIKELY(ret >= 0))
+				rs_sink_cat_rs(k, &tmp);
+
+			rs_free(&tmp);
+		}
+	} else {
+		rs_truncate(&k->buffer, len);
+	}
+
+	va_end(copy);
+	rs_sink_commit(k);
+
+	return ret;
 }
+#endif
 
 #endif /* !RAPID_STRING_H_962AB5F800398A34 */
@@ -0,0 +1,101 @@
+import sys
+
+# Turns an RS_STATS recording written by rs_stats_dump() into a configuration
+# header, to be used through RS_CONFIG_FILE in a second build.
+
+if len(sys.argv) < 2:
+	print('usage: config.py recording [header]')
+	sys.exit(1)
+
+values = {}
+sizes = {}
+
+for line in open(sys.argv[1], 'r'):
+	parts = line.split()
+
+	if not parts:
+		continue
+
+	if parts[0] == 'size':
+		sizes[int(parts[1])] = int(parts[2])
+	else:
+		values[parts[0]] = int(parts[1])
+
+cap = values['stack_capacity']
+strings = sum(sizes.values())
+
+# Bucket 0 holds empty strings, bucket i holds lengths in [2^(i-1), 2^i).
+def middle(bucket):
+	return 0 if bucket == 0 else 1.5 * 2 ** (bucket - 1)
+
+def upper(bucket):
+	return 0 if bucket == 0 else 2 ** bucket - 1
+
+if strings:
+	average = sum(middle(b) * c for b, c in sizes.items()) / strings
+else:
+	average = values['average_size']
+
+# The branch hints only depend on which side of the stack capacity the
+# average lies, therefore the measured branch directions take precedence.
+ops = values['cats'] + values['cpys']
+heap = (values['cat_heap'] + values['cat_spills'] +
+	values['cpy_heap'] + values['cpy_spills'])
+
+if ops:
+	if heap * 2 > ops and average <= cap:
+		average = cap + 1
+	elif heap * 2 <= ops and average > cap:
+		average = cap
+
+average = max(1, int(round(average)))
+
+# Strings which keep growing after their first allocation benefit from a
+# larger growth factor.
+grows = values['grows'] / values['allocs'] if values['allocs'] else 0
+
+if grows > 4:
+	factor = 4
+elif grows > 2:
+	factor = 3
+else:
+	factor = 2
+
+# Smallest inline capacity that would hold 90% of the recorded strings.
+inline = sum(c for b, c in sizes.items() if upper(b) <= cap)
+recommended = 0
+covered = 0
+
+for b in sorted(sizes):
+	covered += sizes[b]
+	recommended = upper(b)
+
+	if covered * 10 >= strings * 9:
+		break
+
+def percent(part, whole):
+	return 100.0 * part / whole if whole else 0.0
+
+config = '''/*
+ * Generated by scripts/config.py from an RS_STATS recording.
+ *
+ * Strings recorded:\t\t%d (%.1f%% fit in the stack capacity of %d)
+ * Heap branches taken:\t\t%.1f%% of %d rs_cat_n()/rs_cpy_n() calls
+ * Growths per allocation:\t%.2f
+ * Recommended inline capacity:\t%d (holds 90%% of the strings)
+ */
+
+#ifndef RAPID_STRING_CONFIG_H
+#define RAPID_STRING_CONFIG_H
+
+#define RS_AVERAGE_SIZE (%d)
+#define RS_GROWTH_FACTOR (%d)
+
+#endif
+''' % (strings, percent(inline, strings), cap, percent(heap, ops), ops,
+	grows, recommended, average, factor)
+
+if len(sys.argv) > 2:
+	open(sys.argv[2], 'w').write(config)
+else:
+	sys.stdout.write(config)
@@ -0,0 +1,93 @@
+/*
+ * Picks the kernel variant for the running CPU. On ELF targets the dynamic
+ * loader does so once through GNU indirect functions, and elsewhere each
+ * kernel starts out pointing at a function which resolves it on the first
+ * call. `RS_LIB_AVX2` is defined when the AVX2 variant was compiled.
+ */
+
+#include "rapidstring.h"
+#include "kernels.h"
+
+#if defined(RS_LIB_AVX2) && defined(_MSC_VER)
+  #include <immintrin.h>
+  #include <intrin.h>
+#endif
+
+#if defined(__ELF__) && defined(__GNUC__) && !defined(RS_LIB_NO_IFUNC)
+  #define RS_LIB_IFUNC
+#endif
+
+static int rs_lib_has_avx2(void)
+{
+#if defined(RS_LIB_AVX2) && defined(__GNUC__)
+	__builtin_cpu_init();
+
+	return __builtin_cpu_supports("avx2");
+#elif defined(RS_LIB_AVX2) && defined(_MSC_VER)
+	int info[4];
+
+	/* The CPU has AVX and the OS saves the YMM registers. */
+	__cpuid(info, 1);
+
+	if ((info[2] & (1 << 27 | 1 << 28)) != (1 << 27 | 1 << 28) ||
+	    (_xgetbv(0) & 6) != 6)
+		return 0;
+
+	__cpuidex(info, 7, 0);
+
+	return (info[1] >> 5) & 1;
+#else
+	return 0;
+#endif
+}
+
+#ifdef RS_LIB_AVX2
+  #define RS_LIB_BEST(name)						\
+	(rs_lib_has_avx2() ? RS_LIB_PASTE(name, _avx2) :		\
+			     RS_LIB_PASTE(name, _baseline))
+#else
+  #define RS_LIB_BEST(name) RS_LIB_PASTE(name, _baseline)
+#endif
+
+#define RS_LIB_RESOLVER(ret, name, params, args)			\
+	static ret (*RS_LIB_PASTE(name, _resolve)(void)) params		\
+	{								\
+		return RS_LIB_BEST(name);				\
+	}
+
+RS_LIB_KERNELS(RS_LIB_RESOLVER)
+
+#ifdef RS_LIB_IFUNC
+
+#define RS_LIB_DEFINE(ret, name, params, args)				\
+	ret name params __attribute__((ifunc(#name "_resolve")));
+
+#else
+
+/*
+ * Every thread which races on the first call stores the same pointer, which
+ * is harmless on every platform this builds for.
+ */
+#define RS_LIB_DEFINE(ret, name, params, args)				\
+	static ret RS_LIB_PASTE(name, _first) params;			\
+	static ret (*RS_LIB_PASTE(name, _ptr)) params =		\
+		RS_LIB_PASTE(name, _first);				\
+	static ret RS_LIB_PASTE(name, _first) params			\
+	{								\
+		RS_LIB_PASTE(name, _ptr) = RS_LIB_PASTE(name, _resolve)(); \
+									\
+		return RS_LIB_PASTE(name, _ptr) args;			\
+	}								\
+	ret name params							\
+	{								\
+		return RS_LIB_PASTE(name, _ptr) args;			\
+	}
+
+#endif
+
+RS_LIB_KERNELS(RS_LIB_DEFINE)
+
+const char *rs_lib_isa(void)
+{
+	return rs_lib_has_avx2() ? "avx2" : "baseline";
+}
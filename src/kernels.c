@@ -0,0 +1,131 @@
+/*
+ * One variant of the librapidstring kernels. The header selects its vector
+ * paths from the instruction sets enabled for this file, so the variants only
+ * differ in the flags they are compiled with.
+ */
+
+#ifdef RS_LIBRARY
+  #error "The kernels are compiled from the inline definitions."
+#endif
+
+#ifndef RS_LIB_VARIANT
+  #error "RS_LIB_VARIANT must name the variant, e.g. _baseline."
+#endif
+
+#include "rapidstring.h"
+#include "kernels.h"
+
+#define RS_LIB_NAME(name) RS_LIB_PASTE(name, RS_LIB_VARIANT)
+
+size_t RS_LIB_NAME(rs_lib_count_n)(const char *input, size_t n, char c)
+{
+	return rs_count_n(input, n, c);
+}
+
+size_t RS_LIB_NAME(rs_lib_line_index_n)(const char *input, size_t n,
+					size_t *offsets, size_t max)
+{
+	return rs_line_index_n(input, n, offsets, max);
+}
+
+size_t RS_LIB_NAME(rs_lib_find_first_of_n)(const char *input, size_t n,
+					   const rs_charset *set)
+{
+	return rs_find_first_of_n(input, n, set);
+}
+
+size_t RS_LIB_NAME(rs_lib_find_last_of_n)(const char *input, size_t n,
+					  const rs_charset *set)
+{
+	return rs_find_last_of_n(input, n, set);
+}
+
+size_t RS_LIB_NAME(rs_lib_span_n)(const char *input, size_t n,
+				  const rs_charset *set)
+{
+	return rs_span_n(input, n, set);
+}
+
+size_t RS_LIB_NAME(rs_lib_count_any_n)(const char *input, size_t n,
+				       const rs_charset *set)
+{
+	return rs_count_any_n(input, n, set);
+}
+
+size_t RS_LIB_NAME(rs_lib_json_escaped_len)(const char *input, size_t n)
+{
+	return rs_json_escaped_len(input, n);
+}
+
+size_t RS_LIB_NAME(rs_lib_url_encoded_len)(const char *input, size_t n)
+{
+	return rs_url_encoded_len(input, n);
+}
+
+size_t RS_LIB_NAME(rs_lib_html_escaped_len)(const char *input, size_t n)
+{
+	return rs_html_escaped_len(input, n);
+}
+
+/*
+ * The block kernels return how much of the input they handled, and without
+ * the vector instructions that is nothing: the callers finish the input.
+ */
+
+size_t RS_LIB_NAME(rs_lib_base64_encode)(char *output,
+					 const unsigned char *input, size_t n,
+					 int alphabet)
+{
+#if RS_SSSE3
+	return rs_base64_encode_simd(output, input, n, alphabet);
+#else
+	(void)output;
+	(void)input;
+	(void)n;
+	(void)alphabet;
+
+	return 0;
+#endif
+}
+
+size_t RS_LIB_NAME(rs_lib_base64_decode)(char *output, const char *input,
+					 size_t n)
+{
+#if RS_SSSE3
+	return rs_base64_decode_simd(output, input, n);
+#else
+	(void)output;
+	(void)input;
+	(void)n;
+
+	return 0;
+#endif
+}
+
+size_t RS_LIB_NAME(rs_lib_hex_encode)(char *output,
+				      const unsigned char *input, size_t n)
+{
+#if RS_SSE2
+	return rs_hex_encode_simd(output, input, n);
+#else
+	(void)output;
+	(void)input;
+	(void)n;
+
+	return 0;
+#endif
+}
+
+size_t RS_LIB_NAME(rs_lib_hex_decode)(char *output, const char *input,
+				      size_t n)
+{
+#if RS_SSE2
+	return rs_hex_decode_simd(output, input, n);
+#else
+	(void)output;
+	(void)input;
+	(void)n;
+
+	return 0;
+#endif
+}
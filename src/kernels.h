@@ -0,0 +1,53 @@
+#ifndef KERNELS_H_5C0E93A1D7F2B846
+#define KERNELS_H_5C0E93A1D7F2B846
+
+#include "rapidstring.h" /* rs_charset */
+
+/*
+ * The kernels of librapidstring. `kernels.c` is compiled once per variant
+ * with `RS_LIB_VARIANT` set to its suffix, and `dispatch.c` defines the
+ * unsuffixed functions the header declares on top of the variants.
+ */
+
+#define RS_LIB_PASTE_(a, b) a##b
+#define RS_LIB_PASTE(a, b) RS_LIB_PASTE_(a, b)
+
+/* Return type, name, parameters and arguments of every kernel. */
+#define RS_LIB_KERNELS(X)							\
+	X(size_t, rs_lib_count_n,						\
+	  (const char *input, size_t n, char c), (input, n, c))		\
+	X(size_t, rs_lib_line_index_n,						\
+	  (const char *input, size_t n, size_t *offsets, size_t max),	\
+	  (input, n, offsets, max))						\
+	X(size_t, rs_lib_find_first_of_n,					\
+	  (const char *input, size_t n, const rs_charset *set), (input, n, set)) \
+	X(size_t, rs_lib_find_last_of_n,					\
+	  (const char *input, size_t n, const rs_charset *set), (input, n, set)) \
+	X(size_t, rs_lib_span_n,						\
+	  (const char *input, size_t n, const rs_charset *set), (input, n, set)) \
+	X(size_t, rs_lib_count_any_n,						\
+	  (const char *input, size_t n, const rs_charset *set), (input, n, set)) \
+	X(size_t, rs_lib_json_escaped_len,					\
+	  (const char *input, size_t n), (input, n))				\
+	X(size_t, rs_lib_url_encoded_len,					\
+	  (const char *input, size_t n), (input, n))				\
+	X(size_t, rs_lib_html_escaped_len,					\
+	  (const char *input, size_t n), (input, n))				\
+	X(size_t, rs_lib_base64_encode,						\
+	  (char *output, const unsigned char *input, size_t n, int alphabet), \
+	  (output, input, n, alphabet))					\
+	X(size_t, rs_lib_base64_decode,						\
+	  (char *output, const char *input, size_t n), (output, input, n))	\
+	X(size_t, rs_lib_hex_encode,						\
+	  (char *output, const unsigned char *input, size_t n),		\
+	  (output, input, n))							\
+	X(size_t, rs_lib_hex_decode,						\
+	  (char *output, const char *input, size_t n), (output, input, n))
+
+#define RS_LIB_DECLARE(ret, name, params, args)				\
+	ret RS_LIB_PASTE(name, _baseline) params;				\
+	ret RS_LIB_PASTE(name, _avx2) params;
+
+RS_LIB_KERNELS(RS_LIB_DECLARE)
+
+#endif /* !KERNELS_H_5C0E93A1D7F2B846 */
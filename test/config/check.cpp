@@ -0,0 +1,15 @@
+// Compiled with the generated configuration through RS_CONFIG_FILE.
+#include "rapidstring.h"
+
+#ifndef RAPID_STRING_CONFIG_H
+  #error "The generated configuration was not included."
+#endif
+
+int main()
+{
+	rapidstring s;
+	rs_init_w(&s, "configured");
+	rs_free(&s);
+
+	return RS_AVERAGE_SIZE > 0 && RS_GROWTH_FACTOR > 1 ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+// Writes an RS_STATS recording of a small workload for scripts/config.py.
+#ifndef RS_STATS
+  #define RS_STATS
+#endif
+
+#include "rapidstring.h"
+#include <cstdio>
+#include <string>
+
+RS_STATS_DEFINE
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+		return 1;
+
+	for (int i = 0; i < 1000; i++) {
+		const std::string str(static_cast<std::size_t>(i % 97), 'a');
+
+		rapidstring s;
+		rs_init_w_n(&s, str.data(), str.size());
+		rs_cat(&s, "suffix");
+		rs_free(&s);
+	}
+
+	rs_stats stats;
+	rs_stats_snapshot(&stats);
+
+	std::FILE *f = std::fopen(argv[1], "w");
+
+	if (!f)
+		return 1;
+
+	const int ret = rs_stats_dump(f, &stats);
+
+	return std::fclose(f) == 0 && ret == 0 ? 0 : 1;
+}
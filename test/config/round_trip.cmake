@@ -0,0 +1,39 @@
+# Records a workload, generates a configuration from the recording with
+# scripts/config.py, and compiles a program with it through RS_CONFIG_FILE.
+#
+# Run with -P, defining RECORD, PYTHON, COMPILER, SOURCE_DIR and BINARY_DIR.
+
+set(RECORDING "${BINARY_DIR}/recording.txt")
+set(CONFIG "${BINARY_DIR}/config.h")
+
+foreach(file ${RECORDING} ${CONFIG})
+	file(REMOVE ${file})
+endforeach()
+
+execute_process(COMMAND ${RECORD} ${RECORDING} RESULT_VARIABLE result)
+
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "Recording failed: ${result}")
+endif()
+
+execute_process(
+	COMMAND ${PYTHON} ${SOURCE_DIR}/scripts/config.py ${RECORDING} ${CONFIG}
+	RESULT_VARIABLE result
+)
+
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "scripts/config.py failed: ${result}")
+endif()
+
+# The arguments are passed without a shell, so the quotes reach the compiler.
+execute_process(
+	COMMAND ${COMPILER} -std=c++11 -fsyntax-only
+		-I${SOURCE_DIR}/include
+		"-DRS_CONFIG_FILE=\"${CONFIG}\""
+		${SOURCE_DIR}/test/config/check.cpp
+	RESULT_VARIABLE result
+)
+
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "The generated configuration does not compile")
+endif()
@@ -60,3 +60,44 @@ TEST_CASE("Heap concatenation")
 
 	rs_free(&s);
 }
+
+TEST_CASE("Formatted concatenation")
+{
+	const std::string first{ "Hello 42" };
+	const std::string second{ first + " to this very long string, 3.50!" };
+	const std::string third{ second + second };
+
+	rapidstring s;
+	rs_init(&s);
+
+	REQUIRE(rs_cat_printf(&s, "Hello %d", 42) == 8);
+
+	CMP_STR(&s, first);
+
+	rs_cat_printf(&s, " to this %s string, %.2f!", "very long", 3.5);
+
+	CMP_STR(&s, second);
+
+	rs_cat_printf(&s, "%s", second.data());
+
+	CMP_STR(&s, third);
+
+	rs_free(&s);
+
+	// Output up to and exactly filling the stack buffer.
+	const std::string almost(RS_STACK_CAPACITY - 1, 'a');
+	const std::string full(RS_STACK_CAPACITY, 'a');
+
+	rs_init(&s);
+	REQUIRE(rs_cat_printf(&s, "%s", almost.c_str()) ==
+		static_cast<int>(almost.size()));
+	REQUIRE(rs_is_stack(&s));
+	CMP_STR(&s, almost);
+	rs_free(&s);
+
+	rs_init(&s);
+	REQUIRE(rs_cat_printf(&s, "%s", full.c_str()) ==
+		static_cast<int>(full.size()));
+	CMP_STR(&s, full);
+	rs_free(&s);
+}
@@ -59,3 +59,84 @@ TEST_CASE("Stack and heap assignment")
 
 	rs_free(&s);
 }
+
+TEST_CASE("Formatted assignment")
+{
+	const std::string first{ "Short 1!" };
+	const std::string second{ "A very long string to get around SSO! 2" };
+
+	rapidstring s;
+	rs_init(&s);
+
+	REQUIRE(rs_cpy_printf(&s, "Short %d!", 1) == 8);
+
+	CMP_STR(&s, first);
+
+	rs_cpy_printf(&s, "A very long string to get around SSO! %d", 2);
+
+	CMP_STR(&s, second);
+
+	rs_cpy_printf(&s, "Short %d!", 1);
+
+	CMP_STR(&s, first);
+
+	rs_free(&s);
+}
+
+TEST_CASE("Ownership transfer")
+{
+	const std::string first{ "Short" };
+	const std::string second{ "A very long string to get around SSO!" };
+	const std::string empty;
+
+	rapidstring a;
+	rapidstring b;
+	rs_init_w(&a, first.data());
+	rs_init_w(&b, second.data());
+
+	const char *buffer = rs_data_c(&b);
+
+	rs_swap(&a, &b);
+
+	CMP_STR(&a, second);
+	CMP_STR(&b, first);
+	REQUIRE(rs_data_c(&a) == buffer);
+
+	// The heap buffer changes owners without a copy.
+	rs_move(&b, &a);
+
+	CMP_STR(&b, second);
+	CMP_STR(&a, empty);
+	REQUIRE(rs_data_c(&b) == buffer);
+
+	std::size_t len = 0;
+	char *released = rs_release(&b, &len);
+
+	REQUIRE(released == buffer);
+	REQUIRE(len == second.length());
+	REQUIRE(released == second);
+	CMP_STR(&b, empty);
+
+	rs_steal_n(&a, released, len);
+	CMP_STR(&a, second);
+
+	// A stack string is moved to the heap to be released.
+	rs_cpy(&b, first.data());
+	released = rs_release(&b, nullptr);
+
+	REQUIRE(released == first);
+	CMP_STR(&b, empty);
+
+	RS_FREE(released);
+
+	// A borrowed string releases a copy.
+	rs_init_borrow(&b, second.data());
+	released = rs_release(&b, &len);
+
+	REQUIRE(released != second.data());
+	REQUIRE(released == second);
+
+	RS_FREE(released);
+	rs_free(&a);
+	rs_free(&b);
+}
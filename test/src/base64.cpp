@@ -0,0 +1,176 @@
+#include "utility.hpp"
+#include <cstddef>
+#include <random>
+#include <string>
+
+namespace {
+
+std::string base64(const std::string& bytes, bool url)
+{
+	const std::string chars{ std::string{ "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+		"abcdefghijklmnopqrstuvwxyz0123456789" } + (url ? "-_" : "+/") };
+	std::string result;
+	std::size_t bits = 0;
+	unsigned long value = 0;
+
+	for (const char c : bytes) {
+		value = value << 8 | static_cast<unsigned char>(c);
+		bits += 8;
+
+		for (; bits >= 6; bits -= 6)
+			result += chars[value >> (bits - 6) & 0x3F];
+	}
+
+	if (bits)
+		result += chars[value << (6 - bits) & 0x3F];
+
+	while (!url && result.size() % 4)
+		result += '=';
+
+	return result;
+}
+
+std::string hex(const std::string& bytes)
+{
+	const char *digits = "0123456789abcdef";
+	std::string result;
+
+	for (const char c : bytes) {
+		result += digits[static_cast<unsigned char>(c) >> 4];
+		result += digits[c & 0x0F];
+	}
+
+	return result;
+}
+
+std::string random_bytes(std::mt19937& gen, std::size_t n)
+{
+	std::uniform_int_distribution<int> d{ 0, 255 };
+	std::string str;
+
+	for (std::size_t i = 0; i < n; i++)
+		str += static_cast<char>(d(gen));
+
+	return str;
+}
+
+std::string str(const rapidstring *s)
+{
+	return std::string{ rs_data_c(s), rs_len(s) };
+}
+
+}
+
+TEST_CASE("Base64 and hex test vectors")
+{
+	const std::string inputs[] = { "", "f", "fo", "foo", "foob", "fooba",
+		"foobar" };
+	const std::string standard[] = { "", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==",
+		"Zm9vYmE=", "Zm9vYmFy" };
+	const std::string url[] = { "", "Zg", "Zm8", "Zm9v", "Zm9vYg", "Zm9vYmE",
+		"Zm9vYmFy" };
+	const std::string digits[] = { "", "66", "666f", "666f6f", "666f6f62",
+		"666f6f6261", "666f6f626172" };
+
+	for (std::size_t i = 0; i < 7; i++) {
+		rapidstring s;
+		rs_init(&s);
+
+		rs_cat_base64(&s, inputs[i].data(), inputs[i].size(),
+			      RS_BASE64_STANDARD);
+		REQUIRE(str(&s) == standard[i]);
+
+		rs_cpy(&s, "");
+		rs_cat_base64(&s, inputs[i].data(), inputs[i].size(),
+			      RS_BASE64_URL);
+		REQUIRE(str(&s) == url[i]);
+
+		rs_cpy(&s, "");
+		rs_cat_hex(&s, inputs[i].data(), inputs[i].size());
+		REQUIRE(str(&s) == digits[i]);
+
+		rs_cpy(&s, "");
+		REQUIRE(rs_decode_base64(&s, standard[i].data(),
+					 standard[i].size()) == 0);
+		REQUIRE(rs_decode_base64(&s, url[i].data(), url[i].size()) == 0);
+		REQUIRE(rs_decode_hex(&s, digits[i].data(),
+				      digits[i].size()) == 0);
+		REQUIRE(str(&s) == inputs[i] + inputs[i] + inputs[i]);
+
+		rs_free(&s);
+	}
+}
+
+TEST_CASE("Base64 and hex round trip")
+{
+	std::mt19937 gen{ 42 };
+
+	// Long enough for every vector kernel and the scalar tails.
+	for (std::size_t n = 0; n < 200; n++) {
+		const std::string prefix{ "prefix:" };
+		const std::string bytes{ random_bytes(gen, n) };
+
+		rapidstring s;
+		rs_init_w(&s, prefix.c_str());
+
+		rs_cat_base64(&s, bytes.data(), bytes.size(), RS_BASE64_STANDARD);
+		REQUIRE(str(&s) == prefix + base64(bytes, false));
+
+		const std::string standard{ str(&s).substr(prefix.size()) };
+
+		rs_cpy(&s, prefix.c_str());
+		rs_cat_base64(&s, bytes.data(), bytes.size(), RS_BASE64_URL);
+		REQUIRE(str(&s) == prefix + base64(bytes, true));
+
+		const std::string url{ str(&s).substr(prefix.size()) };
+
+		rs_cpy(&s, prefix.c_str());
+		rs_cat_hex(&s, bytes.data(), bytes.size());
+		REQUIRE(str(&s) == prefix + hex(bytes));
+
+		const std::string digits{ str(&s).substr(prefix.size()) };
+
+		rs_cpy(&s, prefix.c_str());
+		REQUIRE(rs_decode_base64(&s, standard.data(),
+					 standard.size()) == 0);
+		REQUIRE(str(&s) == prefix + bytes);
+
+		rs_cpy(&s, prefix.c_str());
+		REQUIRE(rs_decode_base64(&s, url.data(), url.size()) == 0);
+		REQUIRE(str(&s) == prefix + bytes);
+
+		rs_cpy(&s, prefix.c_str());
+		REQUIRE(rs_decode_hex(&s, digits.data(), digits.size()) == 0);
+		REQUIRE(str(&s) == prefix + bytes);
+
+		rs_free(&s);
+	}
+}
+
+TEST_CASE("Base64 and hex reject invalid input")
+{
+	const std::string first{ "kept" };
+	const std::string invalid_base64[] = { "Z", "Zg=", "Zg===", "=Zg=",
+		"Zm9vZ", "Zm9v!A==", "Zm9vYmFy\n", "Zm=v",
+		std::string(100, 'A') + "*" + std::string(99, 'A') };
+	const std::string invalid_hex[] = { "6", "666", "6g", "g6", " 66",
+		std::string(100, 'a') + "x" + std::string(99, 'a') };
+
+	rapidstring s;
+	rs_init_w(&s, first.c_str());
+
+	for (const auto& input : invalid_base64) {
+		REQUIRE(rs_decode_base64(&s, input.data(), input.size()) == -1);
+		CMP_STR(&s, first);
+	}
+
+	for (const auto& input : invalid_hex) {
+		REQUIRE(rs_decode_hex(&s, input.data(), input.size()) == -1);
+		CMP_STR(&s, first);
+	}
+
+	REQUIRE(rs_decode_hex(&s, "C0ffEE", 6) == 0);
+	REQUIRE(str(&s) == first + "\xC0\xFF\xEE");
+
+	rs_free(&s);
+}
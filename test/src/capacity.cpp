@@ -0,0 +1,127 @@
+#ifndef RS_COMPACT_RATIO
+  #define RS_COMPACT_RATIO 4
+#endif
+
+#include "utility.hpp"
+#include <cstddef>
+#include <string>
+
+TEST_CASE("Resizing keeps the contents")
+{
+	const std::string first{ "short" };
+	const std::string second{ first + std::string(95, 'x') };
+
+	rapidstring s;
+	rs_init_w(&s, first.c_str());
+
+	// Stack to heap, with exactly the capacity asked for.
+	rs_resize_w(&s, second.size(), 'x');
+	REQUIRE(rs_is_heap(&s));
+	REQUIRE(rs_capacity(&s) == second.size());
+	CMP_STR(&s, second);
+
+	// Heap to a length which fits on the stack.
+	rs_resize(&s, first.size());
+	CMP_STR(&s, first);
+
+	rs_resize_w(&s, second.size(), 'x');
+	CMP_STR(&s, second);
+
+	rs_free(&s);
+}
+
+TEST_CASE("Compaction")
+{
+	const std::string str(1000, 'a');
+
+	rapidstring s;
+	rs_init_w_n(&s, str.data(), str.size());
+	rs_reserve(&s, 4000);
+
+	rs_compact(&s);
+	REQUIRE(rs_capacity(&s) == 1023);
+	CMP_STR(&s, str);
+
+	// Already within its size class.
+	rs_compact(&s);
+	REQUIRE(rs_capacity(&s) == 1023);
+
+	rs_truncate(&s, 10);
+	REQUIRE(rs_is_heap(&s));
+
+	rs_compact(&s);
+	REQUIRE(rs_is_stack(&s));
+
+	const std::string prefix{ str.substr(0, 10) };
+	CMP_STR(&s, prefix);
+
+	rs_compact(&s);
+	CMP_STR(&s, prefix);
+
+	rs_free(&s);
+
+	REQUIRE(rs_size_class(64) == 127);
+	REQUIRE(rs_size_class(127) == 127);
+	REQUIRE(rs_size_class(1024) == 2047);
+}
+
+TEST_CASE("Resizing compacts below the ratio")
+{
+	const std::string str(4000, 'b');
+
+	rapidstring s;
+	rs_init_w_n(&s, str.data(), str.size());
+
+	const std::size_t capacity = rs_capacity(&s);
+
+	// A quarter of the capacity is still kept.
+	rs_resize(&s, capacity / 4);
+	REQUIRE(rs_capacity(&s) == capacity);
+
+	rs_resize(&s, 100);
+	REQUIRE(rs_capacity(&s) == 127);
+
+	const std::string hundred{ str.substr(0, 100) };
+	CMP_STR(&s, hundred);
+
+	rs_resize(&s, 20);
+	REQUIRE(rs_is_stack(&s));
+
+	// Truncation keeps the capacity regardless.
+	rs_resize(&s, 1000);
+	REQUIRE(rs_capacity(&s) == 1000);
+
+	rs_truncate(&s, 0);
+	REQUIRE(rs_capacity(&s) == 1000);
+
+	rs_free(&s);
+}
+
+TEST_CASE("String layout")
+{
+	const rs_heap heap{};
+
+	// The stack string fills the whole string but for its flag.
+	REQUIRE(sizeof(rapidstring) == RS_STACK_CAPACITY + 1);
+
+#ifdef RS_SIZE_T32
+	REQUIRE(sizeof(heap.size) == 4);
+	REQUIRE(sizeof(heap.capacity) == 4);
+#else
+	REQUIRE(sizeof(heap.size) == sizeof(std::size_t));
+#endif
+}
+
+TEST_CASE("Growth stays within the size limit")
+{
+	const std::size_t limit = RS_SIZE_MAX - RS_STACK_CAPACITY;
+
+	REQUIRE(rs_grown(0) == 0);
+	REQUIRE(rs_grown(100) == 100 * RS_GROWTH_FACTOR);
+
+	// Large sizes are clamped instead of wrapping around.
+	REQUIRE(rs_grown(limit / RS_GROWTH_FACTOR + 1) == limit);
+	REQUIRE(rs_grown(limit) == limit);
+	REQUIRE(rs_grown(limit + 1) == limit + 1);
+	REQUIRE(rs_grown(RS_SIZE_MAX) == RS_SIZE_MAX);
+}
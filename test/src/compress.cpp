@@ -0,0 +1,229 @@
+#ifndef RS_COMPRESSION
+  #define RS_COMPRESSION
+#endif
+
+#include "utility.hpp"
+#include <csignal>
+#include <cstddef>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+std::string log_text(std::mt19937& gen, std::size_t n)
+{
+	static const char *const words[] = { "GET", "POST", "/api/v1/users",
+		"/api/v1/orders", "200", "404", "user=", "took", "ms", " " };
+	std::uniform_int_distribution<std::size_t> d{ 0, 9 };
+	std::string str;
+
+	while (str.size() < n)
+		str += words[d(gen)];
+
+	str.resize(n);
+
+	return str;
+}
+
+std::string random_bytes(std::mt19937& gen, std::size_t n)
+{
+	// CMP_STR compares C strings, so there are no null characters.
+	std::uniform_int_distribution<int> d{ 1, 255 };
+	std::string str;
+
+	for (std::size_t i = 0; i < n; i++)
+		str += static_cast<char>(d(gen));
+
+	return str;
+}
+
+void round_trip(const std::string& str)
+{
+	std::vector<char> encoded(rs_lz_bound(str.size()));
+	const auto len = rs_lz_compress(encoded.data(), str.data(),
+					str.size());
+
+	REQUIRE(len <= encoded.size());
+
+	std::string decoded(str.size(), '\0');
+	rs_lz_decompress(&decoded[0], decoded.size(), encoded.data(), len);
+
+	REQUIRE(decoded == str);
+}
+
+}
+
+TEST_CASE("Codec round trip")
+{
+	std::mt19937 gen{ 42 };
+
+	for (std::size_t n = 0; n < 300; n++) {
+		round_trip(log_text(gen, n));
+		round_trip(random_bytes(gen, n));
+		round_trip(std::string(n, 'a'));
+	}
+
+	// Lengths which need extensions, and a repeat beyond the offset limit.
+	const std::string block{ random_bytes(gen, 70000) };
+	round_trip(block + block);
+	round_trip(random_bytes(gen, 300) + std::string(100000, 'z') +
+		   log_text(gen, 5000));
+}
+
+TEST_CASE("Compressed strings decompress on use")
+{
+	std::mt19937 gen{ 7 };
+	const std::string str{ log_text(gen, 4000) };
+
+	rapidstring s;
+	rs_init_w_n(&s, str.data(), str.size());
+
+	REQUIRE(rs_compress(&s) == 1);
+	REQUIRE(rs_is_compressed(&s));
+	REQUIRE(rs_compressed_len(&s) < str.size() / 2);
+
+	// Compressing again does nothing.
+	REQUIRE(rs_compress(&s) == 0);
+	REQUIRE(rs_is_compressed(&s));
+
+	// Queries through a const string leave it compressed.
+	const rapidstring *c = &s;
+	REQUIRE(rs_len(c) == str.size());
+	REQUIRE(rs_capacity(c) == str.size());
+	REQUIRE(rs_is_heap(c));
+	REQUIRE(!rs_is_stack(c));
+	REQUIRE(rs_is_compressed(c));
+
+	REQUIRE(rs_data(&s) == str);
+	REQUIRE(!rs_is_compressed(&s));
+	REQUIRE(rs_compressed_len(&s) == str.size());
+	CMP_STR(&s, str);
+
+	// Modifiers see the characters.
+	REQUIRE(rs_compress(&s) == 1);
+	rs_cat(&s, "!");
+	const std::string appended{ str + "!" };
+	CMP_STR(&s, appended);
+
+	// Replacing and freeing do not need the characters.
+	REQUIRE(rs_compress(&s) == 1);
+	rs_cpy(&s, "replaced");
+	REQUIRE(!rs_is_compressed(&s));
+	CMP_STR(&s, std::string{ "replaced" });
+
+	rs_cat_n(&s, str.data(), str.size());
+	REQUIRE(rs_compress(&s) == 1);
+	rs_cpy_n(&s, str.data(), str.size());
+	CMP_STR(&s, str);
+
+	REQUIRE(rs_compress(&s) == 1);
+	rs_free(&s);
+}
+
+TEST_CASE("Reading a compressed string through a const string aborts")
+{
+	std::mt19937 gen{ 5 };
+	const std::string str{ log_text(gen, 4000) };
+
+	rapidstring s;
+	rs_init_w_n(&s, str.data(), str.size());
+
+	REQUIRE(rs_compress(&s) == 1);
+
+	rs_charset set;
+	rs_charset_init(&set, "=");
+
+	const rapidstring *c = &s;
+	const std::vector<std::function<void()>> readers{
+		[c] { (void)rs_data_c(c); },
+		[c, &set] { (void)rs_find_first_of(c, &set); },
+		[c] { (void)rs_hash(c); }
+	};
+
+	for (const auto& reader : readers) {
+		const pid_t pid = fork();
+
+		REQUIRE(pid != -1);
+
+		if (pid == 0) {
+			std::signal(SIGABRT, SIG_DFL);
+			reader();
+			_exit(0);
+		}
+
+		int status;
+		REQUIRE(waitpid(pid, &status, 0) == pid);
+		REQUIRE(WIFSIGNALED(status));
+		REQUIRE(WTERMSIG(status) == SIGABRT);
+	}
+
+	rs_free(&s);
+}
+
+TEST_CASE("Strings which are not compressed")
+{
+	std::mt19937 gen{ 9 };
+	const std::string noise{ random_bytes(gen, 1000) };
+	const std::string shorter{ std::string(RS_COMPRESS_MIN - 1, 'a') };
+	const std::string stack{ "stack" };
+
+	rapidstring s;
+
+	rs_init_w_n(&s, noise.data(), noise.size());
+	REQUIRE(rs_compress(&s) == 0);
+	REQUIRE(!rs_is_compressed(&s));
+	CMP_STR(&s, noise);
+	rs_free(&s);
+
+	rs_init_w_n(&s, shorter.data(), shorter.size());
+	REQUIRE(rs_compress(&s) == 0);
+	CMP_STR(&s, shorter);
+	rs_free(&s);
+
+	rs_init_w(&s, stack.c_str());
+	REQUIRE(rs_compress(&s) == 0);
+	REQUIRE(rs_compressed_len(&s) == stack.size());
+	CMP_STR(&s, stack);
+	rs_free(&s);
+}
+
+TEST_CASE("Compress all")
+{
+	std::mt19937 gen{ 11 };
+	std::vector<std::string> strs;
+
+	for (std::size_t i = 0; i < 100; i++)
+		strs.push_back(i % 3 ? log_text(gen, i * 37 + 100) :
+			       random_bytes(gen, i * 13));
+
+	std::vector<rapidstring> arr(strs.size());
+	std::size_t before = 0;
+
+	for (std::size_t i = 0; i < strs.size(); i++) {
+		rs_init_w_n(&arr[i], strs[i].data(), strs[i].size());
+		before += rs_compressed_len(&arr[i]);
+	}
+
+	const auto saved = rs_compress_all(arr.data(), arr.size());
+	std::size_t after = 0;
+
+	for (std::size_t i = 0; i < strs.size(); i++) {
+		REQUIRE(rs_is_compressed(&arr[i]) ==
+			(i % 3 != 0));
+		after += rs_compressed_len(&arr[i]);
+	}
+
+	REQUIRE(saved > 0);
+	REQUIRE(after < before);
+	REQUIRE(rs_compress_all(arr.data(), arr.size()) == 0);
+
+	for (std::size_t i = 0; i < strs.size(); i++) {
+		rs_decompress(&arr[i]);
+		CMP_STR(&arr[i], strs[i]);
+		rs_free(&arr[i]);
+	}
+}
@@ -1,5 +1,6 @@
 #include "utility.hpp"
 #include <cstddef>
+#include <cstring>
 #include <string>
 
 TEST_CASE("Stack construction")
@@ -73,3 +74,85 @@ TEST_CASE("rapidstring construction")
 	rs_free(&s2);
 	rs_free(&s1);
 }
+
+TEST_CASE("Borrowed construction")
+{
+	static const char literal[] = "A borrowed constant long enough for the heap";
+	const std::string first{ literal };
+	const std::string second{ first + "!" };
+
+	rapidstring s;
+	rs_init_borrow(&s, literal);
+
+	// Reading leaves the characters borrowed.
+	REQUIRE(rs_is_borrowed(&s));
+	REQUIRE(rs_data_c(&s) == literal);
+	REQUIRE(rs_len(&s) == first.size());
+	REQUIRE(rs_capacity(&s) == first.size());
+
+	// Querying and operations that do not write leave it borrowed too.
+	REQUIRE(rs_is_heap(&s));
+	REQUIRE(!rs_is_stack(&s));
+	CMP_STR(&s, first);
+	rs_shrink_to_fit(&s);
+	rs_compact(&s);
+	REQUIRE(rs_is_borrowed(&s));
+	REQUIRE(rs_data_c(&s) == literal);
+
+	rapidstring copy;
+	rs_init_w_rs(&copy, &s);
+	rs_cat_rs(&copy, &s);
+
+	REQUIRE(rs_is_borrowed(&s));
+
+	const std::string twice{ first + first };
+	CMP_STR(&copy, twice);
+
+	// The first modification copies.
+	rs_cat(&s, "!");
+
+	REQUIRE(!rs_is_borrowed(&s));
+	REQUIRE(rs_data_c(&s) != literal);
+	REQUIRE(first == literal);
+	CMP_STR(&s, second);
+
+	rs_free(&s);
+
+	const std::string third{ "short" };
+
+	rs_init_borrow_n(&s, literal + first.size() - 4, 4);
+	rs_data(&s)[0] = 'H';
+	REQUIRE(!rs_is_borrowed(&s));
+	REQUIRE(first == literal);
+
+	const std::string heap{ "Heap" };
+	CMP_STR(&s, heap);
+
+	rs_free(&s);
+
+	// Assignment replaces the borrowed characters, freeing leaves them.
+	rs_init_borrow(&s, literal);
+	rs_cpy(&s, third.c_str());
+	CMP_STR(&s, third);
+	rs_free(&s);
+
+	rs_init_borrow(&s, literal);
+	rs_free(&s);
+
+	// Stealing and pooling drop the borrowed characters without a copy.
+	char *buffer = static_cast<char*>(RS_MALLOC(RS_ALLOC_SIZE(third.size())));
+	std::memcpy(buffer, third.c_str(), third.size() + 1);
+
+	rs_init_borrow(&s, literal);
+	rs_steal_n(&s, buffer, third.size());
+	CMP_STR(&s, third);
+	rs_free(&s);
+
+	rs_pool p;
+	rs_pool_init(&p, 0);
+	rs_init_borrow(&s, literal);
+	rs_pool_release(&p, &s);
+	REQUIRE(p.count == 0);
+
+	rs_free(&copy);
+}
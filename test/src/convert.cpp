@@ -0,0 +1,174 @@
+#include "utility.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace {
+
+void require_same(const std::string& str)
+{
+	double expected = std::strtod(str.c_str(), nullptr);
+	double actual = 0;
+
+	REQUIRE(rs_to_double_n(str.data(), str.size(), &actual) == str.size());
+
+	// NaNs are compared by representation, zeros by sign.
+	std::uint64_t a;
+	std::uint64_t b;
+	std::memcpy(&a, &actual, sizeof(a));
+	std::memcpy(&b, &expected, sizeof(b));
+
+	INFO(str);
+	REQUIRE(a == b);
+}
+
+}
+
+TEST_CASE("Integer parsing")
+{
+	const std::string valid[] = { "0", "7", "-7", "+7", "00000000000000000042",
+		"123456789012345678", "9223372036854775807", "-9223372036854775808",
+		"18446744073709551615" };
+	const std::string invalid[] = { "", "-", "+", "-+1", "+-1", "x1",
+		"18446744073709551616", "99999999999999999999",
+		"29000000000000000000", "123456789012345678901" };
+
+	for (const auto& str : valid) {
+		std::uint64_t u = 0;
+		const bool negative = str[0] == '-';
+
+		REQUIRE(rs_to_u64_n(str.data(), str.size(), &u) ==
+			(negative ? 0 : str.size()));
+
+		if (!negative)
+			REQUIRE(u == std::strtoull(str.c_str(), nullptr, 10));
+	}
+
+	for (const auto& str : invalid) {
+		std::uint64_t u = 3;
+
+		REQUIRE(rs_to_u64_n(str.data(), str.size(), &u) == 0);
+		REQUIRE(u == 3);
+	}
+
+	std::int64_t i = 0;
+
+	REQUIRE(rs_to_i64_n("-9223372036854775808", 20, &i) == 20);
+	REQUIRE(i == std::numeric_limits<std::int64_t>::min());
+	REQUIRE(rs_to_i64_n("9223372036854775807,", 20, &i) == 19);
+	REQUIRE(i == std::numeric_limits<std::int64_t>::max());
+	REQUIRE(rs_to_i64_n("9223372036854775808", 19, &i) == 0);
+	REQUIRE(rs_to_i64_n("-9223372036854775809", 20, &i) == 0);
+
+	rapidstring s;
+	rs_init_w(&s, "-12345678901234;next");
+
+	REQUIRE(rs_to_i64(&s, &i) == 15);
+	REQUIRE(i == -12345678901234);
+
+	rs_free(&s);
+}
+
+TEST_CASE("Integer formatting")
+{
+	const std::int64_t signed_values[] = { 0, 9, -9, 10, -10, 99, 100,
+		-12345678901234, std::numeric_limits<std::int64_t>::max(),
+		std::numeric_limits<std::int64_t>::min() };
+	const std::uint64_t unsigned_values[] = { 0, 1, 99, 100, 1000000007,
+		std::numeric_limits<std::uint64_t>::max() };
+
+	rapidstring s;
+	rs_init_w(&s, ">");
+
+	std::string expected{ ">" };
+
+	for (const auto value : signed_values) {
+		rs_cat_i64(&s, value);
+		expected += std::to_string(value) + ',';
+		rs_cat(&s, ",");
+	}
+
+	for (const auto value : unsigned_values) {
+		rs_cat_u64(&s, value);
+		expected += std::to_string(value) + ',';
+		rs_cat(&s, ",");
+	}
+
+	CMP_STR(&s, expected);
+
+	rs_free(&s);
+}
+
+TEST_CASE("Floating point parsing")
+{
+	const std::string strs[] = { "0", "-0", "0.0", ".5", "5.", "1e10",
+		"1E-10", "-1.5e+3", "3.141592653589793", "2.2250738585072014e-308",
+		"4.9e-324", "1.7976931348623157e308", "1e309", "-1e-400",
+		"9007199254740993", "0.1000000000000000055511151231257827",
+		"123456789012345678901234567890", "7.00000000000000000001e-40",
+		"inf", "-Infinity", "NaN", "1e100000000000" };
+
+	for (const auto& str : strs)
+		require_same(str);
+
+	double d = 1;
+
+	const char *invalid[] = { "", "-", ".", "e5", "-.e1", "in", "x" };
+
+	for (const auto str : invalid) {
+		REQUIRE(rs_to_double_n(str, std::strlen(str), &d) == 0);
+		REQUIRE(d == 1);
+	}
+
+	// The trailing characters which do not continue the number.
+	REQUIRE(rs_to_double_n("1.5e", 4, &d) == 3);
+	REQUIRE(rs_to_double_n("1.5e+", 5, &d) == 3);
+	REQUIRE(rs_to_double_n("2.5,3", 5, &d) == 3);
+	REQUIRE(d == 2.5);
+	REQUIRE(rs_to_double_n("infinit", 7, &d) == 3);
+}
+
+TEST_CASE("Floating point parsing against strtod")
+{
+	std::mt19937_64 gen{ 42 };
+	std::uniform_int_distribution<int> digits{ 1, 20 };
+	std::uniform_int_distribution<int> exponent{ -80, 80 };
+	std::uniform_int_distribution<int> digit{ 0, 9 };
+
+	for (int i = 0; i < 20000; i++) {
+		std::string str;
+
+		// Either the shortest form of a random double or random digits.
+		if (i % 2) {
+			double v;
+			std::uint64_t bits = gen();
+			char buf[32];
+
+			std::memcpy(&v, &bits, sizeof(v));
+
+			if (v != v)
+				continue;
+
+			std::snprintf(buf, sizeof(buf), "%.*g", i % 17 + 1, v);
+			str = buf;
+		} else {
+			const int n = digits(gen);
+
+			for (int j = 0; j < n; j++) {
+				str += static_cast<char>('0' + digit(gen));
+
+				if (j == n / 2 && i % 3)
+					str += '.';
+			}
+
+			str += 'e' + std::to_string(exponent(gen));
+		}
+
+		require_same(str);
+	}
+}
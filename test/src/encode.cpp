@@ -0,0 +1,244 @@
+#include "utility.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace {
+
+std::string json_escaped(const std::string& str)
+{
+	std::string result;
+
+	for (const char c : str) {
+		char buf[8];
+
+		switch (c) {
+		case '"': result += "\\\""; break;
+		case '\\': result += "\\\\"; break;
+		case '\b': result += "\\b"; break;
+		case '\f': result += "\\f"; break;
+		case '\n': result += "\\n"; break;
+		case '\r': result += "\\r"; break;
+		case '\t': result += "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20) {
+				std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+				result += buf;
+			} else {
+				result += c;
+			}
+		}
+	}
+
+	return result;
+}
+
+std::string url_encoded(const std::string& str)
+{
+	const std::string unreserved{ "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+		"abcdefghijklmnopqrstuvwxyz0123456789-._~" };
+	std::string result;
+
+	for (const char c : str) {
+		char buf[4];
+
+		if (unreserved.find(c) != std::string::npos) {
+			result += c;
+		} else {
+			std::snprintf(buf, sizeof(buf), "%%%02X",
+				      static_cast<unsigned char>(c));
+			result += buf;
+		}
+	}
+
+	return result;
+}
+
+std::string html_escaped(const std::string& str)
+{
+	std::string result;
+
+	for (const char c : str) {
+		switch (c) {
+		case '&': result += "&amp;"; break;
+		case '<': result += "&lt;"; break;
+		case '>': result += "&gt;"; break;
+		case '"': result += "&quot;"; break;
+		case '\'': result += "&#39;"; break;
+		default: result += c;
+		}
+	}
+
+	return result;
+}
+
+std::string random_string(std::mt19937& gen, std::size_t n)
+{
+	// CMP_STR compares C strings, so there are no null characters.
+	std::uniform_int_distribution<int> any{ 1, 255 };
+	std::uniform_int_distribution<int> clean{ 'a', 'z' };
+	std::string str;
+
+	// Mostly clean runs with the occasional special character.
+	for (std::size_t i = 0; i < n; i++)
+		str += static_cast<char>(i % 7 ? clean(gen) : any(gen));
+
+	return str;
+}
+
+}
+
+TEST_CASE("Escape against reference")
+{
+	std::mt19937 gen{ 42 };
+
+	for (std::size_t n = 0; n < 200; n += 3) {
+		const std::string prefix{ "prefix:" };
+		const std::string str{ random_string(gen, n) };
+
+		rapidstring s;
+		rs_init_w(&s, prefix.c_str());
+
+		rs_cat_json_escaped_n(&s, str.data(), str.size());
+		const std::string json{ prefix + json_escaped(str) };
+		CMP_STR(&s, json);
+
+		rs_cpy(&s, prefix.c_str());
+		rs_cat_url_encoded_n(&s, str.data(), str.size());
+		const std::string url{ prefix + url_encoded(str) };
+		CMP_STR(&s, url);
+
+		rs_cpy(&s, prefix.c_str());
+		rs_cat_html_escaped_n(&s, str.data(), str.size());
+		const std::string html{ prefix + html_escaped(str) };
+		CMP_STR(&s, html);
+
+		rs_free(&s);
+	}
+}
+
+TEST_CASE("Unescape round trip")
+{
+	std::mt19937 gen{ 7 };
+
+	for (std::size_t n = 0; n < 200; n += 3) {
+		const std::string str{ random_string(gen, n) };
+		const std::string json{ json_escaped(str) };
+		const std::string url{ url_encoded(str) };
+		const std::string html{ html_escaped(str) };
+
+		rapidstring s;
+		rs_init(&s);
+
+		REQUIRE(rs_cat_json_unescaped_n(&s, json.data(),
+						json.size()) == 0);
+		CMP_STR(&s, str);
+
+		rs_cpy(&s, "");
+		REQUIRE(rs_cat_url_decoded_n(&s, url.data(), url.size()) == 0);
+		CMP_STR(&s, str);
+
+		rs_cpy(&s, "");
+		rs_cat_html_unescaped_n(&s, html.data(), html.size());
+		CMP_STR(&s, str);
+
+		rs_free(&s);
+	}
+}
+
+TEST_CASE("JSON unescape")
+{
+	rapidstring s;
+	rs_init_w(&s, "kept");
+
+	REQUIRE(rs_cat_json_unescaped(&s,
+		"\\/\\u00e9\\u20AC\\ud83d\\ude00") == 0);
+	const std::string first{ "kept/\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80" };
+	CMP_STR(&s, first);
+
+	const char *invalid[] = { "\\", "\\x", "\\u12", "\\u12g4", "\\ud83d",
+		"\\ud83d\\u0041", "\\ude00" };
+
+	for (const auto input : invalid) {
+		REQUIRE(rs_cat_json_unescaped(&s, input) == -1);
+		CMP_STR(&s, first);
+	}
+
+	rs_free(&s);
+}
+
+TEST_CASE("URL decode")
+{
+	rapidstring s;
+	rs_init(&s);
+
+	REQUIRE(rs_cat_url_decoded(&s, "a%20b+c%2f%2F") == 0);
+	const std::string first{ "a b+c//" };
+	CMP_STR(&s, first);
+
+	REQUIRE(rs_cat_url_decoded(&s, "%2") == -1);
+	REQUIRE(rs_cat_url_decoded(&s, "%zz") == -1);
+	CMP_STR(&s, first);
+
+	rs_free(&s);
+}
+
+TEST_CASE("HTML unescape")
+{
+	rapidstring s;
+	rs_init(&s);
+
+	rs_cat_html_unescaped(&s, "&lt;a&gt; &apos;&#65;&#x42;&#X20AC;&amp;"
+		" &nbsp; & &#; &#xD800; &#x110000; &amp");
+	const std::string result{ "<a> 'AB\xE2\x82\xAC& &nbsp; & &#; "
+		"&#xD800; &#x110000; &amp" };
+	CMP_STR(&s, result);
+
+	rs_free(&s);
+}
+
+TEST_CASE("Escaped character sets")
+{
+	std::string json{ "\"\\" };
+
+	for (char c = 1; c < 0x20; c++)
+		json += c;
+
+	json += '\0';
+
+	const std::string url{ "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+		"abcdefghijklmnopqrstuvwxyz0123456789-._~" };
+	const std::string html{ "&<>\"'" };
+
+	rs_charset set;
+
+	// The constant sets must match what initialization computes.
+	rs_charset_init_n(&set, json.data(), json.size());
+	REQUIRE(std::memcmp(&set, rs_json_escape_set(), sizeof(set)) == 0);
+
+	rs_charset_init_n(&set, url.data(), url.size());
+	REQUIRE(std::memcmp(&set, rs_url_unreserved_set(), sizeof(set)) == 0);
+
+	rs_charset_init_n(&set, html.data(), html.size());
+	REQUIRE(std::memcmp(&set, rs_html_escape_set(), sizeof(set)) == 0);
+}
+
+#ifdef RS_LIBRARY
+TEST_CASE("Compiled escape scanners")
+{
+	std::mt19937 gen{ 11 };
+
+	for (std::size_t n = 0; n < 200; n += 7) {
+		const std::string str{ random_string(gen, n) };
+
+		REQUIRE(rs_lib_json_escaped_len(str.data(), str.size()) ==
+			json_escaped(str).size());
+		REQUIRE(rs_lib_url_encoded_len(str.data(), str.size()) ==
+			url_encoded(str).size());
+		REQUIRE(rs_lib_html_escaped_len(str.data(), str.size()) ==
+			html_escaped(str).size());
+	}
+}
+#endif
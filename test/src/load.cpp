@@ -0,0 +1,164 @@
+#ifndef RS_IO_URING
+  #define RS_IO_URING
+#endif
+
+#include "utility.hpp"
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+struct directory {
+	directory()
+	{
+		char tmpl[] = "/tmp/rs_load_XXXXXX";
+		REQUIRE(mkdtemp(tmpl));
+		path = tmpl;
+	}
+
+	~directory()
+	{
+		for (const auto& file : files)
+			std::remove(file.c_str());
+
+		rmdir(path.c_str());
+	}
+
+	std::string add(const std::string& name, const std::string& content)
+	{
+		const std::string file{ path + '/' + name };
+		FILE *f = std::fopen(file.c_str(), "wb");
+
+		REQUIRE(f);
+		REQUIRE(std::fwrite(content.data(), 1, content.size(), f) ==
+			content.size());
+		std::fclose(f);
+
+		files.push_back(file);
+
+		return file;
+	}
+
+	std::string path;
+	std::vector<std::string> files;
+};
+
+std::string content(std::size_t n)
+{
+	std::string str;
+
+	for (std::size_t i = 0; i < n; i++)
+		str += static_cast<char>('a' + (i * 7 + n) % 26);
+
+	return str;
+}
+
+}
+
+TEST_CASE("Load files")
+{
+	directory dir;
+	std::vector<std::string> expected;
+	std::vector<std::string> paths;
+
+	// More files than are read at once, on the stack and on the heap.
+	for (std::size_t i = 0; i < 3 * RS_LOAD_QUEUE_DEPTH; i++) {
+		const std::size_t n = i % 5 == 0 ? i * 997 : i % 40;
+
+		expected.push_back(content(n));
+		paths.push_back(dir.add(std::to_string(i), expected.back()));
+	}
+
+	std::vector<const char*> cpaths;
+
+	for (const auto& path : paths)
+		cpaths.push_back(path.c_str());
+
+	std::vector<rapidstring> arr(paths.size());
+	std::vector<int> errors(paths.size(), -1);
+
+	for (std::size_t i = 0; i < arr.size(); i++)
+		rs_init_w(&arr[i], i % 2 ? "replaced" :
+			  "a previous value long enough for the heap");
+
+	REQUIRE(rs_load_files(arr.data(), cpaths.data(), cpaths.size(),
+			      errors.data()) == 0);
+
+	for (std::size_t i = 0; i < arr.size(); i++) {
+		REQUIRE(errors[i] == 0);
+		CMP_STR(&arr[i], expected[i]);
+
+		// Strings moved to the heap are sized to fit.
+		if (i % 2 && expected[i].size() > RS_STACK_CAPACITY)
+			REQUIRE(rs_capacity(&arr[i]) == expected[i].size());
+	}
+
+	// A single file, which does not use a ring.
+	REQUIRE(rs_load_files(arr.data(), cpaths.data() + 5, 1, NULL) == 0);
+	CMP_STR(&arr[0], expected[5]);
+
+	for (auto& s : arr)
+		rs_free(&s);
+}
+
+TEST_CASE("Load files reports failures")
+{
+	directory dir;
+	const std::string first{ content(100) };
+	const std::string path{ dir.add("first", first) };
+	const std::string missing{ dir.path + "/missing" };
+	const char *paths[] = { path.c_str(), missing.c_str(),
+		dir.path.c_str(), "/dev/null" };
+	const std::size_t n = sizeof(paths) / sizeof(paths[0]);
+
+	std::vector<rapidstring> arr(n);
+	std::vector<int> errors(n, -1);
+
+	for (auto& s : arr)
+		rs_init_w(&s, "previous");
+
+	errno = 0;
+	REQUIRE(rs_load_files(arr.data(), paths, n, errors.data()) == -1);
+	REQUIRE(errno == ENOENT);
+
+	const std::string empty;
+
+	REQUIRE(errors[0] == 0);
+	CMP_STR(&arr[0], first);
+	REQUIRE(errors[1] == ENOENT);
+	CMP_STR(&arr[1], empty);
+	REQUIRE(errors[2] == EISDIR);
+	CMP_STR(&arr[2], empty);
+	REQUIRE(errors[3] == 0);
+	CMP_STR(&arr[3], empty);
+
+	for (auto& s : arr)
+		rs_free(&s);
+}
+
+TEST_CASE("Load files resumes at the offset read")
+{
+	directory dir;
+	const std::string expected{ content(5000) };
+	const std::string path{ dir.add("partial", expected) };
+
+	rapidstring s;
+	rs_init(&s);
+
+	// As left by the ring, which does not move the position of the file.
+	rs_load_slot slot;
+	REQUIRE(rs_load_open(&slot, &s, path.c_str()) == 0);
+	std::memcpy(rs_data(&s), expected.data(), 1000);
+	slot.offset = 1000;
+
+	REQUIRE(rs_load_read(&slot, &s) == 0);
+	CMP_STR(&s, expected);
+
+	rs_free(&s);
+}
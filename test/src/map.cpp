@@ -0,0 +1,132 @@
+#include "utility.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+std::string random_key(std::mt19937& gen)
+{
+	std::uniform_int_distribution<int> len{ 0, 3 };
+	std::uniform_int_distribution<int> c{ 'a', 'c' };
+	std::string key;
+
+	// Mostly short keys, with some heap keys sharing their prefixes.
+	for (int i = len(gen); i > 0; i--)
+		key += static_cast<char>(c(gen));
+
+	if (len(gen) == 0)
+		key += std::string(40, 'x');
+
+	return key;
+}
+
+void check_map(int flags)
+{
+	std::mt19937 gen{ static_cast<unsigned>(flags) + 1 };
+	std::uniform_int_distribution<int> op{ 0, 2 };
+	std::unordered_map<std::string, std::uint64_t> expected;
+
+	rs_map m;
+	rs_map_init(&m, sizeof(std::uint64_t), flags);
+
+	for (std::uint64_t i = 0; i < 5000; i++) {
+		const std::string key{ random_key(gen) + std::to_string(i % 300) };
+		int inserted;
+
+		switch (op(gen)) {
+		case 0: {
+			auto *value = static_cast<std::uint64_t*>(rs_map_insert_n(
+				&m, key.data(), key.size(), &inserted));
+
+			REQUIRE(inserted == !expected.count(key));
+			*value = i;
+			expected[key] = i;
+			break;
+		}
+		case 1:
+			REQUIRE(rs_map_erase_n(&m, key.data(), key.size()) ==
+				static_cast<int>(expected.erase(key)));
+			break;
+		default: {
+			const auto *value = static_cast<std::uint64_t*>(
+				rs_map_find_n(&m, key.data(), key.size()));
+
+			if (expected.count(key))
+				REQUIRE((value && *value == expected[key]));
+			else
+				REQUIRE(value == nullptr);
+		}
+		}
+
+		REQUIRE(m.size == expected.size());
+	}
+
+	std::size_t pos = 0;
+	const rapidstring *key;
+	void *value;
+	std::set<std::string> seen;
+
+	while (rs_map_next(&m, &pos, &key, &value)) {
+		const std::string str{ rs_data_c(key), rs_len(key) };
+
+		REQUIRE(expected.at(str) == *static_cast<std::uint64_t*>(value));
+		seen.insert(str);
+	}
+
+	REQUIRE(seen.size() == expected.size());
+
+	rs_map_free(&m);
+}
+
+}
+
+TEST_CASE("Map against std::unordered_map")
+{
+	check_map(0);
+	check_map(RS_MAP_CACHE_HASH);
+}
+
+TEST_CASE("Map with string keys")
+{
+	rs_map m;
+	rs_map_init(&m, sizeof(int), 0);
+
+	REQUIRE(rs_map_find_n(&m, "", 0) == nullptr);
+	REQUIRE(rs_map_erase_n(&m, "", 0) == 0);
+
+	rapidstring key;
+	rs_init_w(&key, "a key long enough to be stored on the heap");
+
+	*static_cast<int*>(rs_map_insert(&m, &key, nullptr)) = 1;
+	*static_cast<int*>(rs_map_insert_n(&m, "", 0, nullptr)) = 2;
+
+	rs_map_reserve(&m, 1000);
+	REQUIRE(m.capacity >= 1000);
+
+	REQUIRE(*static_cast<int*>(rs_map_find(&m, &key)) == 1);
+	REQUIRE(*static_cast<int*>(rs_map_find_n(&m, "", 0)) == 2);
+	REQUIRE(rs_map_erase(&m, &key) == 1);
+	REQUIRE(rs_map_find(&m, &key) == nullptr);
+
+	rs_free(&key);
+	rs_map_free(&m);
+}
+
+TEST_CASE("Hash")
+{
+	std::set<std::uint64_t> hashes;
+	std::string str;
+
+	// Every length path, and no collisions between prefixes.
+	for (int i = 0; i < 200; i++) {
+		str += static_cast<char>('a' + i % 26);
+		hashes.insert(rs_hash_n(str.data(), str.size()));
+	}
+
+	REQUIRE(hashes.size() == 200);
+	REQUIRE(rs_hash_n("", 0) != rs_hash_n("a", 1));
+}
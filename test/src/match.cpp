@@ -0,0 +1,210 @@
+#include "utility.hpp"
+#include <cstddef>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using match = std::tuple<std::size_t, std::size_t, std::size_t>;
+
+struct matcher {
+	explicit matcher(const std::vector<std::string>& patterns)
+	{
+		std::vector<rapidstring> arr(patterns.size());
+
+		for (std::size_t i = 0; i < patterns.size(); i++)
+			rs_init_w_n(&arr[i], patterns[i].data(),
+				    patterns[i].size());
+
+		rs_matcher_init(&m, arr.data(), arr.size());
+
+		for (auto& s : arr)
+			rs_free(&s);
+	}
+
+	~matcher()
+	{
+		rs_matcher_free(&m);
+	}
+
+	rs_matcher m;
+};
+
+int collect(void *data, std::size_t pattern, std::size_t begin,
+	    std::size_t end)
+{
+	static_cast<std::vector<match>*>(data)->emplace_back(pattern, begin,
+							     end);
+	return 0;
+}
+
+std::size_t first_index(const std::vector<std::string>& patterns,
+			const std::string& str)
+{
+	for (std::size_t i = 0; i < patterns.size(); i++)
+		if (patterns[i] == str)
+			return i;
+
+	return patterns.size();
+}
+
+// Every match, ordered by end and then by decreasing length.
+std::vector<match> all_matches(const std::vector<std::string>& patterns,
+			       const std::string& str)
+{
+	std::vector<match> matches;
+
+	for (std::size_t end = 1; end <= str.size(); end++)
+		for (std::size_t begin = 0; begin < end; begin++) {
+			const std::size_t i = first_index(patterns,
+				str.substr(begin, end - begin));
+
+			if (i != patterns.size())
+				matches.emplace_back(i, begin, end);
+		}
+
+	return matches;
+}
+
+std::string replace_all(const std::vector<std::string>& patterns,
+			const std::vector<std::string>& repls,
+			const std::string& str)
+{
+	std::string result;
+	std::size_t pos = 0;
+
+	while (pos < str.size()) {
+		std::size_t len = 0;
+		std::size_t pattern = 0;
+
+		for (std::size_t i = 0; i < patterns.size(); i++)
+			if (patterns[i].size() > len &&
+			    str.compare(pos, patterns[i].size(),
+					patterns[i]) == 0) {
+				len = patterns[i].size();
+				pattern = i;
+			}
+
+		if (len) {
+			result += repls[pattern];
+			pos += len;
+		} else {
+			result += str[pos++];
+		}
+	}
+
+	return result;
+}
+
+std::string random_string(std::mt19937& gen, std::size_t n)
+{
+	std::uniform_int_distribution<int> d{ 'a', 'd' };
+	std::string str;
+
+	for (std::size_t i = 0; i < n; i++)
+		str += static_cast<char>(d(gen));
+
+	return str;
+}
+
+}
+
+TEST_CASE("Matcher finds every match")
+{
+	const std::vector<std::string> patterns{ "he", "she", "his", "hers",
+		"she", "" };
+	const std::string str{ "ushers and his shepherd" };
+	const matcher m{ patterns };
+
+	std::vector<match> matches;
+	const auto count = rs_matcher_find_all_n(&m.m, str.data(), str.size(),
+						 collect, &matches);
+
+	REQUIRE(count == matches.size());
+	REQUIRE(matches == all_matches(patterns, str));
+}
+
+TEST_CASE("Matcher replaces leftmost longest matches")
+{
+	const std::vector<std::string> patterns{ "token", "secret",
+		"secret_key", "key" };
+	const std::vector<std::string> repls{ "***", "[redacted]", "",
+		"k" };
+	const matcher m{ patterns };
+
+	std::vector<rapidstring> arr(repls.size());
+
+	for (std::size_t i = 0; i < repls.size(); i++)
+		rs_init_w_n(&arr[i], repls[i].data(), repls[i].size());
+
+	const std::vector<std::string> inputs{ "", "nothing here",
+		"secret_key=token; secret=token, key=keys",
+		"token token token token token token token" };
+
+	for (const auto& str : inputs) {
+		const std::string result{ replace_all(patterns, repls, str) };
+
+		rapidstring src;
+		rs_init_w_n(&src, str.data(), str.size());
+
+		// Both a stack and a heap destination.
+		rapidstring dst;
+		rs_init(&dst);
+
+		rs_matcher_replace_all(&m.m, &dst, &src, arr.data());
+		CMP_STR(&dst, result);
+
+		rs_cpy(&dst, "a string long enough to be on the heap");
+		rs_matcher_replace_all(&m.m, &dst, &src, arr.data());
+		CMP_STR(&dst, result);
+
+		rs_free(&dst);
+		rs_free(&src);
+	}
+
+	for (auto& s : arr)
+		rs_free(&s);
+}
+
+TEST_CASE("Matcher against brute force")
+{
+	std::mt19937 gen{ 42 };
+
+	for (std::size_t n = 1; n < 40; n++) {
+		std::vector<std::string> patterns;
+
+		for (std::size_t i = 0; i < n % 9 + 1; i++)
+			patterns.push_back(random_string(gen, i % 4 + 1));
+
+		const std::vector<std::string> repls(patterns.size(), "<>");
+		const matcher m{ patterns };
+		const std::string str{ random_string(gen, n * 3) };
+
+		std::vector<match> matches;
+		rs_matcher_find_all_n(&m.m, str.data(), str.size(), collect,
+				      &matches);
+
+		REQUIRE(matches == all_matches(patterns, str));
+
+		std::string result;
+		std::size_t pos = 0;
+		std::size_t begin;
+		std::size_t end;
+		std::size_t pattern;
+
+		while (rs_matcher_find_n(&m.m, str.data(), str.size(), pos,
+					 &begin, &end, &pattern)) {
+			REQUIRE(str.substr(begin, end - begin) ==
+				patterns[pattern]);
+
+			result += str.substr(pos, begin - pos) + "<>";
+			pos = end;
+		}
+
+		result += str.substr(pos);
+
+		REQUIRE(result == replace_all(patterns, repls, str));
+	}
+}
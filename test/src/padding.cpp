@@ -0,0 +1,56 @@
+#ifndef RS_PADDING
+  #define RS_PADDING 64
+#endif
+
+#include "utility.hpp"
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace {
+
+// Reads the padding, which the address sanitizer checks is allocated.
+void require_padding(const rapidstring *s)
+{
+	char block[RS_PADDING];
+
+	REQUIRE(rs_is_heap(s));
+
+	std::memcpy(block, rs_data_c(s) + rs_len(s), sizeof(block));
+	REQUIRE(block[0] == '\0');
+}
+
+}
+
+TEST_CASE("Padded heap strings")
+{
+	rapidstring s;
+	rs_init_w_cap(&s, 0);
+	require_padding(&s);
+
+	// Every size through the growth of the buffer.
+	for (std::size_t i = 0; i < 300; i++) {
+		rs_cat(&s, "x");
+		require_padding(&s);
+	}
+
+	rs_shrink_to_fit(&s);
+	require_padding(&s);
+
+	rs_reserve(&s, 1000);
+	rs_resize(&s, 999);
+	require_padding(&s);
+
+	rs_compact(&s);
+	require_padding(&s);
+
+	rs_free(&s);
+
+	const std::string str(RS_STACK_CAPACITY + 1, 'y');
+
+	rs_init_w_n(&s, str.data(), str.size());
+	require_padding(&s);
+	CMP_STR(&s, str);
+
+	rs_free(&s);
+}
@@ -0,0 +1,118 @@
+#ifndef RS_STATS
+  #define RS_STATS
+#endif
+
+#include "utility.hpp"
+#include <cstddef>
+#include <string>
+#include <thread>
+
+TEST_CASE("Pool reuses buffers")
+{
+	const std::string first{ "A very long string to get around SSO!" };
+	const std::string empty;
+
+	rs_pool p;
+	rs_pool_init(&p, 0);
+
+	rapidstring s;
+	rs_pool_acquire(&p, &s);
+	CMP_STR(&s, empty);
+
+	rs_cat(&s, first.c_str());
+	rs_reserve(&s, 1000);
+
+	const char *buffer = rs_data(&s);
+	rs_pool_release(&p, &s);
+	REQUIRE(p.count == 1);
+
+	rs_stats_reset();
+
+	// The steady state allocates nothing.
+	for (int i = 0; i < 100; i++) {
+		rs_pool_acquire(&p, &s);
+		CMP_STR(&s, empty);
+		REQUIRE(rs_data(&s) == buffer);
+		REQUIRE(rs_capacity(&s) >= 1000);
+
+		rs_cat(&s, first.c_str());
+		CMP_STR(&s, first);
+		rs_pool_release(&p, &s);
+	}
+
+	rs_stats stats;
+	rs_stats_snapshot(&stats);
+
+	REQUIRE(stats.allocs == 0);
+	REQUIRE(stats.reallocs == 0);
+	REQUIRE(stats.frees == 0);
+
+	// Stack strings are not retained.
+	rs_init_w(&s, "short");
+	rs_pool_release(&p, &s);
+	REQUIRE(p.count == 1);
+
+	rs_pool_free(&p);
+	REQUIRE(p.count == 0);
+}
+
+TEST_CASE("Pool trims and bounds retained strings")
+{
+	rs_pool p;
+	rs_pool_init(&p, 100);
+
+	rapidstring strs[RS_POOL_SIZE + 1];
+
+	for (auto& s : strs) {
+		rs_pool_acquire(&p, &s);
+		rs_reserve(&s, 5000);
+	}
+
+	for (auto& s : strs)
+		rs_pool_release(&p, &s);
+
+	REQUIRE(p.count == RS_POOL_SIZE);
+
+	for (std::size_t i = 0; i < p.count; i++)
+		REQUIRE(rs_capacity(&p.strings[i]) == 100);
+
+	rs_pool_free(&p);
+
+	rs_pool *local = rs_pool_local();
+	REQUIRE(local == rs_pool_local());
+	REQUIRE(local->max_capacity == RS_POOL_MAX_CAPACITY);
+
+	rapidstring s;
+	rs_pool_acquire(local, &s);
+	rs_reserve(&s, 100);
+	rs_pool_release(local, &s);
+	REQUIRE(local->count == 1);
+
+	rs_pool_free(local);
+}
+
+TEST_CASE("Pools of exited threads are freed")
+{
+	rs_stats_reset();
+
+	std::size_t retained = 0;
+
+	std::thread t{ [&retained] {
+		rs_pool *local = rs_pool_local();
+
+		rapidstring s;
+		rs_pool_acquire(local, &s);
+		rs_reserve(&s, 100);
+		rs_pool_release(local, &s);
+		retained = local->count;
+	} };
+	t.join();
+
+	REQUIRE(retained == 1);
+
+	rs_stats stats;
+	rs_stats_snapshot(&stats);
+
+	REQUIRE(stats.allocs == 1);
+	REQUIRE(stats.frees == 1);
+}
@@ -0,0 +1,247 @@
+#include "utility.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using entry = std::pair<std::string, std::size_t>;
+
+struct tree {
+	tree()
+	{
+		rs_radix_init(&t);
+	}
+
+	~tree()
+	{
+		rs_radix_free(&t);
+	}
+
+	rs_radix_tree t;
+};
+
+void *to_value(std::size_t i)
+{
+	return reinterpret_cast<void*>(static_cast<std::uintptr_t>(i));
+}
+
+std::size_t from_value(void *value)
+{
+	return static_cast<std::size_t>(reinterpret_cast<std::uintptr_t>(value));
+}
+
+int collect(void *data, const char *key, std::size_t n, void *value)
+{
+	static_cast<std::vector<entry>*>(data)->emplace_back(
+		std::string(key, n), from_value(value));
+	return 0;
+}
+
+std::string random_string(std::mt19937& gen, std::size_t n, int alphabet)
+{
+	std::uniform_int_distribution<int> d{ 0, alphabet - 1 };
+	std::string str;
+
+	for (std::size_t i = 0; i < n; i++)
+		str += static_cast<char>(d(gen));
+
+	return str;
+}
+
+// Sorted, unique keys of random lengths over a small or a wide alphabet.
+std::vector<std::string> random_keys(std::mt19937& gen, std::size_t n,
+				     int alphabet)
+{
+	std::uniform_int_distribution<std::size_t> len{ 0, 12 };
+	std::vector<std::string> keys;
+
+	for (std::size_t i = 0; i < n; i++)
+		keys.push_back(random_string(gen, len(gen), alphabet));
+
+	// The tree orders characters as unsigned, as does std::string.
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	return keys;
+}
+
+void check(const rs_radix_tree *t, const std::vector<std::string>& keys,
+	   std::mt19937& gen, int alphabet)
+{
+	REQUIRE(t->size == keys.size());
+
+	for (std::size_t i = 0; i < keys.size(); i++) {
+		void **value = rs_radix_find_n(t, keys[i].data(), keys[i].size());
+		REQUIRE(value);
+		REQUIRE(from_value(*value) == i);
+	}
+
+	for (std::size_t i = 0; i < 200; i++) {
+		const std::string str{ random_string(gen, i % 16, alphabet) };
+
+		// Find against binary search.
+		const bool found = std::binary_search(keys.begin(), keys.end(),
+						      str);
+		REQUIRE((rs_radix_find_n(t, str.data(), str.size()) != NULL) ==
+			found);
+
+		// Longest prefix against every prefix.
+		std::size_t expected = keys.size();
+
+		for (std::size_t j = 0; j < keys.size(); j++)
+			if (str.compare(0, keys[j].size(), keys[j]) == 0 &&
+			    (expected == keys.size() ||
+			     keys[j].size() > keys[expected].size()))
+				expected = j;
+
+		std::size_t len = 0;
+		void **value = rs_radix_longest_prefix_n(t, str.data(),
+							 str.size(), &len);
+
+		if (expected == keys.size()) {
+			REQUIRE(!value);
+		} else {
+			REQUIRE(value);
+			REQUIRE(from_value(*value) == expected);
+			REQUIRE(len == keys[expected].size());
+		}
+
+		// Prefix iteration against a filter of the sorted keys.
+		const std::string prefix{ str.substr(0, i % 4) };
+		std::vector<entry> matches;
+
+		for (std::size_t j = 0; j < keys.size(); j++)
+			if (keys[j].compare(0, prefix.size(), prefix) == 0)
+				matches.emplace_back(keys[j], j);
+
+		std::vector<entry> visited;
+		const auto count = rs_radix_iterate_prefix_n(t, prefix.data(),
+			prefix.size(), collect, &visited);
+
+		REQUIRE(count == visited.size());
+		REQUIRE(visited == matches);
+	}
+}
+
+}
+
+TEST_CASE("Radix tree insert and find")
+{
+	tree tr;
+	int inserted = 0;
+
+	void **value = rs_radix_insert_n(&tr.t, "romane", 6, &inserted);
+	REQUIRE(inserted);
+	*value = to_value(1);
+
+	const char *words[] = { "romanus", "romulus", "rubens", "ruber",
+		"rubicon", "rubicundus", "", "r", "roman" };
+
+	for (std::size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+		value = rs_radix_insert_n(&tr.t, words[i], std::strlen(words[i]),
+					  &inserted);
+		REQUIRE(inserted);
+		*value = to_value(i + 2);
+	}
+
+	value = rs_radix_insert_n(&tr.t, "romane", 6, &inserted);
+	REQUIRE(!inserted);
+	REQUIRE(from_value(*value) == 1);
+	REQUIRE(tr.t.size == 10);
+
+	REQUIRE(from_value(*rs_radix_find_n(&tr.t, "rubicon", 7)) == 6);
+	REQUIRE(from_value(*rs_radix_find_n(&tr.t, "", 0)) == 8);
+	REQUIRE(!rs_radix_find_n(&tr.t, "rubic", 5));
+	REQUIRE(!rs_radix_find_n(&tr.t, "romanes", 7));
+
+	std::size_t len = 0;
+	value = rs_radix_longest_prefix_n(&tr.t, "romanesque", 10, &len);
+	REQUIRE(from_value(*value) == 1);
+	REQUIRE(len == 6);
+
+	value = rs_radix_longest_prefix_n(&tr.t, "rubber", 6, &len);
+	REQUIRE(from_value(*value) == 9);
+	REQUIRE(len == 1);
+
+	std::vector<entry> visited;
+	REQUIRE(rs_radix_iterate_prefix_n(&tr.t, "rub", 3, collect,
+					  &visited) == 4);
+	const std::vector<entry> expected{ { "rubens", 4 }, { "ruber", 5 },
+		{ "rubicon", 6 }, { "rubicundus", 7 } };
+	REQUIRE(visited == expected);
+}
+
+TEST_CASE("Radix tree against sorted keys")
+{
+	std::mt19937 gen{ 42 };
+
+	// The wide alphabet fills the larger nodes.
+	for (const int alphabet : { 3, 26, 256 }) {
+		for (const std::size_t n : { 1, 10, 300, 3000 }) {
+			const auto keys = random_keys(gen, n, alphabet);
+
+			std::vector<rapidstring> arr(keys.size());
+			std::vector<void*> values(keys.size());
+
+			for (std::size_t i = 0; i < keys.size(); i++) {
+				rs_init_w_n(&arr[i], keys[i].data(),
+					    keys[i].size());
+				values[i] = to_value(i);
+			}
+
+			tree built;
+			rs_radix_build(&built.t, arr.data(), values.data(),
+				       arr.size());
+			check(&built.t, keys, gen, alphabet);
+
+			// The same tree in random order of insertion.
+			std::vector<std::size_t> order(keys.size());
+
+			for (std::size_t i = 0; i < order.size(); i++)
+				order[i] = i;
+
+			std::shuffle(order.begin(), order.end(), gen);
+
+			tree grown;
+
+			for (const auto i : order) {
+				int inserted = 0;
+				*rs_radix_insert(&grown.t, &arr[i], &inserted) =
+					to_value(i);
+				REQUIRE(inserted);
+			}
+
+			check(&grown.t, keys, gen, alphabet);
+
+			for (auto& s : arr)
+				rs_free(&s);
+		}
+	}
+}
+
+TEST_CASE("Radix tree stops iteration")
+{
+	tree tr;
+	const char *words[] = { "a", "ab", "abc", "abd" };
+
+	for (const auto word : words)
+		rs_radix_insert_n(&tr.t, word, std::strlen(word), NULL);
+
+	std::size_t calls = 0;
+	const auto count = rs_radix_iterate_prefix_n(&tr.t, "", 0, [](void *data,
+		const char*, std::size_t, void*) {
+		return ++*static_cast<std::size_t*>(data) == 2 ? 1 : 0;
+	}, &calls);
+
+	REQUIRE(count == 2);
+	REQUIRE(calls == 2);
+	REQUIRE(rs_radix_iterate_prefix_n(&tr.t, "abe", 3, collect, NULL) == 0);
+	REQUIRE(rs_radix_iterate_prefix_n(&tr.t, "abcd", 4, collect,
+					  NULL) == 0);
+}
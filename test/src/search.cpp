@@ -0,0 +1,237 @@
+#include "utility.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::size_t npos_to_rs(std::size_t pos)
+{
+	return pos == std::string::npos ? RS_NPOS : pos;
+}
+
+std::string random_string(std::mt19937& gen, const std::string& alphabet,
+			  std::size_t n)
+{
+	std::uniform_int_distribution<std::size_t> d{ 0, alphabet.size() - 1 };
+	std::string str;
+
+	for (std::size_t i = 0; i < n; i++)
+		str += alphabet[d(gen)];
+
+	return str;
+}
+
+}
+
+TEST_CASE("Character set membership")
+{
+	const std::string chars{ ",\r\n\"\0", 5 };
+
+	rs_charset set;
+	rs_charset_init_n(&set, chars.data(), chars.size());
+
+	REQUIRE(set.nibble_exact);
+	REQUIRE(set.ranges_exact);
+
+	for (int c = 0; c < 256; c++)
+		REQUIRE(rs_charset_has(&set, static_cast<char>(c)) ==
+			(chars.find(static_cast<char>(c)) != std::string::npos));
+}
+
+TEST_CASE("Character set search")
+{
+	std::string wide;
+
+	// All sixteen high nibbles, more than the eight the nibble tables hold
+	// exactly.
+	for (int c = 0x05; c < 0x100; c += 0x10)
+		wide += static_cast<char>(c);
+
+	const std::vector<std::string> sets{ ",\r\n\"", "&=", "abc", wide };
+	std::mt19937 gen{ 42 };
+
+	for (const auto& chars : sets) {
+		rs_charset set;
+		rs_charset_init_n(&set, chars.data(), chars.size());
+
+		std::string alphabet{ "xyz0123456789" };
+		alphabet += chars;
+
+		if (chars == wide)
+			for (int c = 0x06; c < 0x100; c += 0x10)
+				alphabet += static_cast<char>(c);
+
+		for (std::size_t n = 0; n < 100; n++) {
+			// Mostly non-members so the searches run across blocks.
+			const std::string str{ random_string(gen, n % 3 ?
+				alphabet.substr(0, 13) : alphabet, n) + (n % 5 ?
+				random_string(gen, alphabet, n % 7) : "") };
+
+			rapidstring s;
+			rs_init_w_n(&s, str.data(), str.size());
+
+			REQUIRE(rs_find_first_of(&s, &set) ==
+				npos_to_rs(str.find_first_of(chars)));
+			REQUIRE(rs_find_last_of(&s, &set) ==
+				npos_to_rs(str.find_last_of(chars)));
+			REQUIRE(rs_cspn(&s, &set) == std::min(str.size(),
+				str.find_first_of(chars)));
+
+			const std::string members{ str.substr(0, n / 2) };
+			std::string spanned;
+
+			for (const char c : members)
+				if (chars.find(c) != std::string::npos)
+					spanned += c;
+
+			spanned += str;
+
+			rs_cpy_n(&s, spanned.data(), spanned.size());
+
+			REQUIRE(rs_span(&s, &set) == std::min(spanned.size(),
+				spanned.find_first_not_of(chars)));
+
+			rs_free(&s);
+		}
+	}
+}
+
+#ifdef RS_TEST_SSSE3
+void init_charset_ssse3(rs_charset *set, const char *chars, std::size_t n);
+
+TEST_CASE("Character set initialized with SSSE3")
+{
+	// More ranges than the kernels without byte shuffles test.
+	const std::string chars{ "acegikmoqsuwy" };
+	const std::string str{ "bdfhjlnprtvxzbdfhjlnpy0123456789" };
+
+	rs_charset set;
+	init_charset_ssse3(&set, chars.data(), chars.size());
+
+	REQUIRE(rs_find_first_of_n(str.data(), str.size(), &set) == 21);
+	REQUIRE(rs_find_last_of_n(str.data(), str.size(), &set) == 21);
+	REQUIRE(rs_span_n(chars.data(), chars.size(), &set) == chars.size());
+	REQUIRE(rs_cspn_n(str.data(), str.size(), &set) == 21);
+}
+#endif
+
+TEST_CASE("Counting")
+{
+	const std::string chars{ ",\n\"" };
+	std::mt19937 gen{ 7 };
+
+	rs_charset set;
+	rs_charset_init_n(&set, chars.data(), chars.size());
+
+	// Long enough for the byte counters to be summed more than once.
+	for (std::size_t n = 0; n < 20000; n = n * 2 + 3) {
+		const std::string str{ random_string(gen, "abc,\n\"", n) };
+
+		rapidstring s;
+		rs_init_w_n(&s, str.data(), str.size());
+
+		const auto commas = std::count(str.begin(), str.end(), ',');
+
+		REQUIRE(rs_count(&s, ',') == static_cast<std::size_t>(commas));
+		REQUIRE(rs_count(&s, 'x') == 0);
+
+		std::size_t members = 0;
+
+		for (const char c : str)
+			members += chars.find(c) != std::string::npos;
+
+		REQUIRE(rs_count_any(&s, &set) == members);
+
+		rs_free(&s);
+	}
+
+	const std::string same(70000, 'q');
+	REQUIRE(rs_count_n(same.data(), same.size(), 'q') == same.size());
+}
+
+TEST_CASE("Line index")
+{
+	std::mt19937 gen{ 11 };
+
+	for (std::size_t n = 0; n < 5000; n = n * 3 + 1) {
+		const std::string str{ random_string(gen, "ab\n", n) };
+		std::vector<std::size_t> expected;
+
+		for (std::size_t i = 0; i < str.size(); i++)
+			if (str[i] == '\n')
+				expected.push_back(i);
+
+		rapidstring s;
+		rs_init_w_n(&s, str.data(), str.size());
+
+		std::vector<std::size_t> offsets(expected.size() + 1);
+
+		REQUIRE(rs_line_index(&s, offsets.data(), offsets.size()) ==
+			expected.size());
+
+		offsets.pop_back();
+		REQUIRE(offsets == expected);
+
+		// A short index is filled as far as it goes.
+		const std::size_t max = expected.size() / 2;
+		std::vector<std::size_t> partial(max + 1, 0);
+
+		REQUIRE(rs_line_index(&s, partial.data(), max) ==
+			expected.size());
+		REQUIRE(std::equal(partial.begin(), partial.begin() + max,
+				   expected.begin()));
+		REQUIRE(partial[max] == 0);
+
+		REQUIRE(rs_line_index(&s, nullptr, 0) == expected.size());
+
+		rs_free(&s);
+	}
+}
+
+#ifdef RS_LIBRARY
+TEST_CASE("Kernel dispatch")
+{
+	const char *isa = rs_lib_isa();
+
+	REQUIRE((std::strcmp(isa, "avx2") == 0 ||
+		 std::strcmp(isa, "baseline") == 0));
+
+	// More ranges and high nibbles than either vector test holds exactly,
+	// with a set initialized here and searched by the library.
+	std::string chars;
+
+	for (int c = 0x01; c < 0x100; c += 0x0F)
+		chars += static_cast<char>(c);
+
+	rs_charset set;
+	rs_charset_init_n(&set, chars.data(), chars.size());
+
+	std::mt19937 gen{ 3 };
+	std::uniform_int_distribution<int> d{ 0, 255 };
+
+	for (std::size_t n = 0; n < 200; n++) {
+		std::string str;
+
+		for (std::size_t i = 0; i < n; i++)
+			str += static_cast<char>(d(gen));
+
+		std::size_t count = 0;
+
+		for (const char c : str)
+			count += chars.find(c) != std::string::npos;
+
+		REQUIRE(rs_lib_find_first_of_n(str.data(), str.size(), &set) ==
+			npos_to_rs(str.find_first_of(chars)));
+		REQUIRE(rs_lib_find_last_of_n(str.data(), str.size(), &set) ==
+			npos_to_rs(str.find_last_of(chars)));
+		REQUIRE(rs_lib_span_n(str.data(), str.size(), &set) ==
+			std::min(str.size(), str.find_first_not_of(chars)));
+		REQUIRE(rs_lib_count_any_n(str.data(), str.size(), &set) ==
+			count);
+	}
+}
+#endif
@@ -0,0 +1,8 @@
+// Compiled with SSSE3 for a set searched by code compiled without it.
+#include <rapidstring.h>
+#include <cstddef>
+
+void init_charset_ssse3(rs_charset *set, const char *chars, std::size_t n)
+{
+	rs_charset_init_n(set, chars, n);
+}
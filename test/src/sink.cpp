@@ -0,0 +1,167 @@
+#include "utility.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct output {
+	std::string str;
+	std::vector<std::size_t> flushes;
+	std::size_t fail_after{ static_cast<std::size_t>(-1) };
+};
+
+int collect(void *data, const char *buffer, std::size_t n)
+{
+	auto out = static_cast<output*>(data);
+
+	if (out->flushes.size() == out->fail_after)
+		return 5;
+
+	out->str.append(buffer, n);
+	out->flushes.push_back(n);
+
+	return 0;
+}
+
+}
+
+TEST_CASE("Sink flushes at the high-water mark")
+{
+	output out;
+	rs_sink k;
+	rs_sink_init(&k, 64, collect, &out);
+
+	const std::size_t capacity = rs_capacity(&k.buffer);
+	std::string expected;
+
+	for (int i = 0; i < 1000; i++) {
+		rs_sink_cat(&k, "item ");
+		rs_sink_cat_i64(&k, -i);
+		rs_sink_cat_n(&k, "/", 1);
+		rs_sink_cat_u64(&k, static_cast<std::uint64_t>(i) * 1000003);
+		rs_sink_printf(&k, "[%d]", i % 7);
+		rs_cat_json_escaped(rs_sink_string(&k, 7), "\"q\"");
+		rs_sink_commit(&k);
+
+		expected += "item " + std::to_string(-i) + '/' +
+			std::to_string(i * 1000003ULL) + '[' +
+			std::to_string(i % 7) + "]\\\"q\\\"";
+	}
+
+	REQUIRE(rs_sink_flush(&k) == 0);
+	REQUIRE(out.str == expected);
+	REQUIRE(k.flushed == expected.size());
+
+	// The buffer never grew.
+	REQUIRE(rs_capacity(&k.buffer) == capacity);
+
+	for (const auto n : out.flushes)
+		REQUIRE(n <= 64);
+
+	rs_sink_free(&k);
+}
+
+TEST_CASE("Sink passes large input through")
+{
+	output out;
+	rs_sink k;
+	rs_sink_init(&k, 32, collect, &out);
+
+	const std::string large(100, 'x');
+	rapidstring s;
+	rs_init_w_n(&s, large.data(), large.size());
+
+	rs_sink_cat(&k, "head");
+	rs_sink_cat_rs(&k, &s);
+	rs_sink_cat(&k, "tail");
+
+	// Nothing is flushed until the buffer fills.
+	REQUIRE(out.flushes == std::vector<std::size_t>{ 4, 100 });
+	REQUIRE(rs_sink_flush(&k) == 0);
+	REQUIRE(out.str == "head" + large + "tail");
+
+	rs_free(&s);
+	rs_sink_free(&k);
+}
+
+TEST_CASE("Sink passes large formatted output through")
+{
+	output out;
+	rs_sink k;
+	rs_sink_init(&k, 32, collect, &out);
+
+	const std::size_t capacity = rs_capacity(&k.buffer);
+	const std::string large(100, 'x');
+
+	rs_sink_cat(&k, "head");
+	REQUIRE(rs_sink_printf(&k, "%s", large.c_str()) == 100);
+	REQUIRE(rs_sink_printf(&k, "%d", 42) == 2);
+
+	// The buffer never grew to hold the large output.
+	REQUIRE(rs_capacity(&k.buffer) == capacity);
+	REQUIRE(out.flushes == std::vector<std::size_t>{ 4, 100 });
+	REQUIRE(rs_sink_flush(&k) == 0);
+	REQUIRE(out.str == "head" + large + "42");
+	REQUIRE(k.flushed == 106);
+
+	// Output passed through leaves the buffer terminated.
+	REQUIRE(rs_sink_printf(&k, "%s", large.c_str()) == 100);
+	REQUIRE(rs_len(&k.buffer) == 0);
+	REQUIRE(rs_data_c(&k.buffer)[0] == '\0');
+
+	rs_sink_free(&k);
+}
+
+TEST_CASE("Sink keeps the first error")
+{
+	output out;
+	out.fail_after = 1;
+
+	rs_sink k;
+	rs_sink_init(&k, 0, collect, &out);
+
+	REQUIRE(k.high_water == RS_SINK_SIZE);
+
+	rs_sink_cat(&k, "first");
+	REQUIRE(rs_sink_flush(&k) == 0);
+
+	rs_sink_cat(&k, "second");
+	REQUIRE(rs_sink_flush(&k) == 5);
+
+	out.fail_after = static_cast<std::size_t>(-1);
+	rs_sink_cat(&k, "third");
+	REQUIRE(rs_sink_flush(&k) == 5);
+
+	REQUIRE(out.str == "first");
+	REQUIRE(k.flushed == 16);
+
+	rs_sink_free(&k);
+}
+
+TEST_CASE("Sink formats into a stack buffer")
+{
+	output out;
+	rs_sink k;
+	rs_sink_init(&k, RS_STACK_CAPACITY, collect, &out);
+
+	// A compacted buffer is terminated outside of its characters when full.
+	rs_compact(&k.buffer);
+	REQUIRE(rs_is_stack(&k.buffer));
+
+	std::string expected;
+
+	for (int i = 0; i < 300; i++) {
+		REQUIRE(rs_sink_printf(&k, "%d,", i) ==
+			static_cast<int>(std::to_string(i).size() + 1));
+		expected += std::to_string(i) + ",";
+
+		REQUIRE(rs_data_c(&k.buffer)[rs_len(&k.buffer)] == '\0');
+	}
+
+	REQUIRE(rs_sink_flush(&k) == 0);
+	REQUIRE(out.str == expected);
+
+	rs_sink_free(&k);
+}
@@ -0,0 +1,168 @@
+#ifndef RS_STATS
+  #define RS_STATS
+#endif
+
+#include "utility.hpp"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+RS_STATS_DEFINE
+
+TEST_CASE("Statistics counters")
+{
+	const std::string first{ "Short!" };
+	const std::string second{ "A very long string to get around SSO!" };
+
+	rs_stats_reset();
+
+	rapidstring s;
+	rs_init_w(&s, first.data());
+	rs_cat(&s, second.data());
+	rs_free(&s);
+
+	rs_stats stats;
+	rs_stats_snapshot(&stats);
+
+	REQUIRE(stats.allocs == 1);
+	REQUIRE(stats.stack_to_heap == 1);
+	REQUIRE(stats.bytes_copied == first.length());
+	REQUIRE(stats.frees == 1);
+	REQUIRE(stats.sizes[rs_stats_bucket(first.length() +
+		second.length())] == 1);
+
+	rs_stats total{};
+	rs_stats_merge(&total, &stats);
+	rs_stats_merge(&total, &stats);
+
+	REQUIRE(total.allocs == 2);
+
+	rs_stats_reset();
+	rs_stats_snapshot(&stats);
+
+	REQUIRE(stats.allocs == 0);
+}
+
+TEST_CASE("Statistics sum every thread")
+{
+	rs_stats_reset();
+
+	rapidstring s;
+	rs_init_w(&s, "A very long string to get around SSO!");
+
+	// The counters of exited threads add to those of this thread.
+	std::thread first{ [] {
+		rapidstring t;
+		rs_init_w(&t, "Another string long enough for the heap!");
+		rs_free(&t);
+	} };
+	first.join();
+
+	rs_stats stats;
+	rs_stats_snapshot(&stats);
+
+	REQUIRE(stats.allocs == 2);
+	REQUIRE(stats.frees == 1);
+
+	std::thread second{ [&s] {
+		rs_free(&s);
+	} };
+	second.join();
+
+	rs_stats_snapshot(&stats);
+
+	REQUIRE(stats.allocs == 2);
+	REQUIRE(stats.frees == 2);
+
+	rs_stats_reset();
+	rs_stats_snapshot(&stats);
+
+	REQUIRE(stats.allocs == 0);
+	REQUIRE(stats.frees == 0);
+}
+
+TEST_CASE("Statistics reset while threads record")
+{
+	std::atomic<int> step{ 0 };
+
+	// The thread keeps recording across the reset, which only moves its base.
+	std::thread worker{ [&step] {
+		rapidstring t;
+		rs_init_w(&t, "A very long string to get around SSO!");
+		rs_free(&t);
+		step = 1;
+
+		while (step != 2)
+			std::this_thread::yield();
+
+		rs_init_w(&t, "Another string long enough for the heap!");
+		step = 3;
+
+		while (step != 4)
+			std::this_thread::yield();
+
+		rs_free(&t);
+	} };
+
+	while (step != 1)
+		std::this_thread::yield();
+
+	rs_stats_reset();
+	step = 2;
+
+	while (step != 3)
+		std::this_thread::yield();
+
+	rs_stats stats;
+	rs_stats_snapshot(&stats);
+
+	REQUIRE(stats.allocs == 1);
+	REQUIRE(stats.frees == 0);
+
+	step = 4;
+	worker.join();
+	rs_stats_snapshot(&stats);
+
+	REQUIRE(stats.allocs == 1);
+	REQUIRE(stats.frees == 1);
+}
+
+TEST_CASE("Statistics buckets")
+{
+	REQUIRE(rs_stats_bucket(0) == 0);
+	REQUIRE(rs_stats_bucket(1) == 1);
+	REQUIRE(rs_stats_bucket(2) == 2);
+	REQUIRE(rs_stats_bucket(3) == 2);
+	REQUIRE(rs_stats_bucket(1024) == 11);
+}
+
+TEST_CASE("Statistics recording")
+{
+	rs_stats_reset();
+
+	rapidstring s;
+	rs_init(&s);
+	rs_cat(&s, "A very long string to get around SSO!");
+	rs_cpy(&s, "Short!");
+	rs_free(&s);
+
+	rs_stats stats;
+	rs_stats_snapshot(&stats);
+
+	REQUIRE(stats.cats == 1);
+	REQUIRE(stats.cat_spills == 1);
+	REQUIRE(stats.cpys == 1);
+	REQUIRE(stats.cpy_heap == 1);
+
+	std::FILE *f = std::tmpfile();
+	REQUIRE(f != nullptr);
+	REQUIRE(rs_stats_dump(f, &stats) == 0);
+
+	std::rewind(f);
+	char line[64];
+	REQUIRE(std::fgets(line, sizeof(line), f) != nullptr);
+	REQUIRE(std::string{ line }.find("stack_capacity") == 0);
+
+	std::fclose(f);
+}
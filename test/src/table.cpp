@@ -0,0 +1,97 @@
+#include "utility.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if RS_POSIX
+
+TEST_CASE("Table serialization")
+{
+	const std::vector<std::string> strs{
+		"",
+		"Short!",
+		"A very long string to get around SSO!",
+		std::string(RS_TABLE_BUFFER_SIZE * 2, 'x')
+	};
+
+	std::vector<rapidstring> arr(strs.size());
+
+	for (std::size_t i = 0; i < strs.size(); i++)
+		rs_init_w_n(&arr[i], strs[i].data(), strs[i].length());
+
+	char path[] = "/tmp/rapidstring_table_XXXXXX";
+	const int fd = mkstemp(path);
+	REQUIRE(fd != -1);
+	REQUIRE(rs_serialize(fd, arr.data(), arr.size()) == 0);
+	close(fd);
+
+	rs_table t{};
+	REQUIRE(rs_table_open(&t, path) == 0);
+	REQUIRE(rs_table_count(&t) == strs.size());
+
+	for (std::size_t i = 0; i < strs.size(); i++) {
+		std::size_t len;
+		const char *data = rs_table_at(&t, i, &len);
+
+		REQUIRE(len == strs[i].length());
+		REQUIRE(data == strs[i]);
+	}
+
+	rs_table_close(&t);
+	unlink(path);
+
+	for (auto& s : arr)
+		rs_free(&s);
+}
+
+TEST_CASE("Table validation")
+{
+	char path[] = "/tmp/rapidstring_table_XXXXXX";
+	const int fd = mkstemp(path);
+	REQUIRE(fd != -1);
+	REQUIRE(rs_write_all(fd, "not a table at all", 18) == 0);
+	close(fd);
+
+	rs_table t{};
+	REQUIRE(rs_table_open(&t, path) == -1);
+	REQUIRE(errno == EINVAL);
+
+	unlink(path);
+}
+
+TEST_CASE("Table access checks the terminator")
+{
+	rapidstring arr[2];
+	rs_init_w(&arr[0], "first");
+	rs_init_w(&arr[1], "second");
+
+	char path[] = "/tmp/rapidstring_table_XXXXXX";
+	const int fd = mkstemp(path);
+	REQUIRE(fd != -1);
+	REQUIRE(rs_serialize(fd, arr, 2) == 0);
+
+	// Overwrite the terminator of the first string only.
+	const off_t data = sizeof(rs_table_header) + 3 * sizeof(std::uint64_t);
+	REQUIRE(pwrite(fd, "!", 1, data + 5) == 1);
+	close(fd);
+
+	// Opening only checks the last terminator, so the file stays unread.
+	rs_table t{};
+	REQUIRE(rs_table_open(&t, path) == 0);
+
+	std::size_t len = 0;
+	REQUIRE(rs_table_at(&t, 0, &len) == NULL);
+	REQUIRE(len == 0);
+	REQUIRE(rs_table_at(&t, 1, &len) == std::string{ "second" });
+	REQUIRE(len == 6);
+
+	rs_table_close(&t);
+	unlink(path);
+
+	for (auto& s : arr)
+		rs_free(&s);
+}
+
+#endif
@@ -6,12 +6,12 @@
 
 #define CMP_STR(s, cmp) do {					\
 	REQUIRE(rs_len(s) == cmp.length());			\
-	REQUIRE(rs_data(s) == cmp);				\
+	REQUIRE(rs_data_c(s) == cmp);				\
 								\
-	if (rs_is_heap(s))					\
-		REQUIRE(rs_capacity(s) >= cmp.length());	\
-	else							\
+	if (rs_is_stack(s))					\
 		REQUIRE(rs_capacity(s) == RS_STACK_CAPACITY);	\
+	else							\
+		REQUIRE(rs_capacity(s) >= cmp.length());	\
 } while (0)
 
 #endif // !UTILITY_HPP_ECB97D42D011D625